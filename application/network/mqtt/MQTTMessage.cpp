@@ -0,0 +1,72 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <smooth/application/network/mqtt/MQTTMessage.h>
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                MQTTMessage::MQTTMessage(packet::Publish&& publish)
+                        : publish(std::move(publish)), has_data(true)
+                {
+                }
+
+                std::string MQTTMessage::get_topic() const
+                {
+                    return std::string(get_topic_data(), get_topic_length());
+                }
+
+                const char* MQTTMessage::get_topic_data() const
+                {
+                    return has_data ? publish.get_topic_data() : "";
+                }
+
+                uint16_t MQTTMessage::get_topic_length() const
+                {
+                    return has_data ? publish.get_topic_length() : static_cast<uint16_t>(0);
+                }
+
+                const uint8_t* MQTTMessage::get_payload() const
+                {
+                    return has_data ? publish.get_payload_data() : nullptr;
+                }
+
+                size_t MQTTMessage::get_payload_length() const
+                {
+                    return has_data ? static_cast<size_t>(publish.get_payload_length()) : 0;
+                }
+
+                QoS MQTTMessage::get_qos() const
+                {
+                    return has_data ? publish.get_qos() : QoS::AT_MOST_ONCE;
+                }
+
+                MQTTData MQTTMessage::to_data() const
+                {
+                    return std::make_pair(get_topic(),
+                                          std::vector<uint8_t>(get_payload(), get_payload() + get_payload_length()));
+                }
+
+                MQTTData MQTTMessage::release_data()
+                {
+                    MQTTData data;
+
+                    if (has_data)
+                    {
+                        data.first = get_topic();
+                        data.second = publish.take_payload();
+                        has_data = false;
+                    }
+
+                    return data;
+                }
+            }
+        }
+    }
+}
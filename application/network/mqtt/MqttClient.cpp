@@ -30,9 +30,12 @@ namespace smooth
                 MqttClient::MqttClient(const std::string& mqtt_client_id,
                                        std::chrono::seconds keep_alive,
                                        uint32_t stack_size,
-                                       uint32_t priority, TaskEventQueue<MQTTData>& application_queue)
+                                       uint32_t priority, TaskEventQueue<MQTTData>& application_queue,
+                                       const MqttClientOptions& options)
                         : Task(mqtt_client_id, stack_size, priority, std::chrono::milliseconds(50)),
                           application_queue(application_queue),
+                          tx_pool(options.transmit_buffer_packets),
+                          tx_buffer(tx_pool, options.transmit_buffer_packets),
                           tx_empty("TX_empty", 5, *this, *this),
                           data_available("data_available", 5, *this, *this),
                           connection_status("connection_status", 5, *this, *this),
@@ -56,14 +59,22 @@ namespace smooth
                                                 true,
                                                 std::chrono::seconds(1))),
                           fsm(*this),
-                          address()
+                          address(),
+                          publication(options)
                 {
                 }
 
                 void MqttClient::tick()
                 {
                     std::lock_guard<std::mutex> lock(guard);
+                    // Also while disconnected, so that messages survive a restart during an outage.
+                    publication.persist();
                     fsm.tick();
+
+                    if (!batch.is_empty() && batch.get_age() >= coalesce_linger)
+                    {
+                        flush_batch();
+                    }
                 }
 
                 void MqttClient::init()
@@ -76,7 +87,9 @@ namespace smooth
                 }
 
                 void MqttClient::connect_to(std::shared_ptr<smooth::core::network::InetAddress> address,
-                                            bool auto_reconnect)
+                                            bool auto_reconnect,
+                                            std::shared_ptr<smooth::core::network::TlsContext> tls_context,
+                                            const std::string& server_name)
                 {
                     std::lock_guard<std::mutex> lock(guard);
                     // Must start the task before pushing an event, otherwise the task will not
@@ -88,6 +101,8 @@ namespace smooth
                         {
                             std::lock_guard<std::mutex> l(address_guard);
                             this->address = address;
+                            this->tls_context = tls_context;
+                            this->server_name = server_name;
                         }
                         this->auto_reconnect = auto_reconnect;
                         control_event.push(event::ConnectEvent());
@@ -106,14 +121,58 @@ namespace smooth
                 bool MqttClient::publish(const std::string& topic, const uint8_t* data, int length, mqtt::QoS qos,
                                          bool retain)
                 {
-                    std::lock_guard<std::mutex> lock(guard);
+                    // Publication has a lock of its own; not holding the client's lets the client task
+                    // make room while a publish is blocked waiting for it.
                     return publication.publish(topic, data, length, qos, retain);
                 }
 
+                bool MqttClient::publish(const std::string& topic, std::vector<uint8_t>&& data, mqtt::QoS qos,
+                                         bool retain)
+                {
+                    return publication.publish(topic, std::move(data), qos, retain);
+                }
+
+                bool MqttClient::publish(const std::string& topic,
+                                         std::shared_ptr<const smooth::core::network::ExternalPayload> payload,
+                                         mqtt::QoS qos, bool retain)
+                {
+                    return publication.publish(topic, std::move(payload), qos, retain);
+                }
+
+                void MqttClient::set_max_in_flight_publishes(size_t count)
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    publication.set_max_in_flight(count);
+                }
+
+                void MqttClient::set_coalescing(size_t max_bytes, std::chrono::milliseconds linger)
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    coalesce_max_bytes = max_bytes;
+                    coalesce_linger = linger;
+                }
+
+                OutgoingQueueStatus MqttClient::get_outgoing_queue_status()
+                {
+                    return publication.get_status();
+                }
+
                 void MqttClient::subscribe(const std::string& topic, QoS qos)
                 {
                     std::lock_guard<std::mutex> lock(guard);
-                    subscription.subscribe(topic, qos);
+                    subscription.subscribe(topic, qos, TopicRouter::Destination(application_queue));
+                }
+
+                void MqttClient::subscribe(const std::string& topic, QoS qos, TaskEventQueue<MQTTData>& queue)
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    subscription.subscribe(topic, qos, TopicRouter::Destination(queue));
+                }
+
+                void MqttClient::subscribe(const std::string& topic, QoS qos, TaskEventQueue<MQTTMessage>& queue)
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    subscription.subscribe(topic, qos, TopicRouter::Destination(queue));
                 }
 
                 void MqttClient::unsubscribe(const std::string& topic)
@@ -139,8 +198,38 @@ namespace smooth
                     bool res = false;
                     if (packet.validate_packet())
                     {
-                        res = tx_buffer.put(packet);
+                        if (coalesce_max_bytes == 0)
+                        {
+                            res = tx_buffer.put(packet);
+                        }
+                        else
+                        {
+                            // A full batch has to make way for the packet. If the transmit buffer can't take it
+                            // either, the caller tries again later.
+                            res = batch.append(packet, coalesce_max_bytes)
+                                  || (flush_batch() && batch.append(packet, coalesce_max_bytes));
+
+                            // Only publishes are held back waiting for more.
+                            if (res && (packet.get_mqtt_type() != PUBLISH || batch.is_full(coalesce_max_bytes)))
+                            {
+                                flush_batch();
+                            }
+                        }
+                    }
+                    return res;
+                }
+
+                bool MqttClient::flush_batch()
+                {
+                    bool res = batch.is_empty();
+
+                    // The batch is swapped for a packet from the pool and continues with the memory of that one.
+                    if (!res && tx_buffer.put(std::move(batch.to_packet())))
+                    {
+                        batch.clear();
+                        res = true;
                     }
+
                     return res;
                 }
 
@@ -156,7 +245,12 @@ namespace smooth
 
                 void MqttClient::start_reconnect()
                 {
-                    reconnect_timer->start();
+                    // Both the disconnection and the failed attempt may ask for a reconnect; only wait once.
+                    if (!reconnect_pending)
+                    {
+                        reconnect_pending = true;
+                        reconnect_timer->start(reconnect_backoff.next_delay());
+                    }
                 }
 
                 void MqttClient::set_keep_alive_timer(std::chrono::seconds interval)
@@ -188,10 +282,10 @@ namespace smooth
 
                 void MqttClient::event(const core::network::DataAvailableEvent<packet::MQTTPacket>& event)
                 {
-                    packet::MQTTPacket p;
-                    if (event.get(p))
+                    if (event.get(received_packet))
                     {
-                        fsm.packet_received(p);
+                        // Decoded in place; the receive buffer recycles the packet on the next call to get().
+                        fsm.packet_received(received_packet);
                     }
                 }
 
@@ -206,7 +300,10 @@ namespace smooth
                     {
                         keep_alive_timer->stop();
                         reconnect_timer->stop();
+                        reconnect_pending = false;
+                        reconnect_backoff.reset();
                         tx_buffer.clear();
+                        batch.clear();
                         rx_buffer.clear();
 
                         if(mqtt_socket)
@@ -223,14 +320,44 @@ namespace smooth
                         }
 
                         tx_buffer.clear();
+                        batch.clear();
                         rx_buffer.clear();
 
-                        mqtt_socket = core::network::Socket<packet::MQTTPacket>::create(tx_buffer,
-                                                                                        rx_buffer,
-                                                                                        tx_empty,
-                                                                                        data_available,
-                                                                                        connection_status);
-                        mqtt_socket->start(address);
+                        std::shared_ptr<core::network::TlsContext> tls;
+                        std::string name;
+                        {
+                            std::lock_guard<std::mutex> l(address_guard);
+                            tls = tls_context;
+                            name = server_name;
+                        }
+
+                        if (tls)
+                        {
+                            mqtt_socket = core::network::SecureSocket<packet::MQTTPacket>::create(tx_buffer,
+                                                                                                  rx_buffer,
+                                                                                                  tx_empty,
+                                                                                                  data_available,
+                                                                                                  connection_status,
+                                                                                                  tls,
+                                                                                                  name,
+                                                                                                  std::chrono::milliseconds(1500),
+                                                                                                  receive_staging_size);
+                        }
+                        else
+                        {
+                            mqtt_socket = core::network::Socket<packet::MQTTPacket>::create(tx_buffer,
+                                                                                            rx_buffer,
+                                                                                            tx_empty,
+                                                                                            data_available,
+                                                                                            connection_status,
+                                                                                            std::chrono::milliseconds(1500),
+                                                                                            receive_staging_size);
+                        }
+
+                        if (mqtt_socket)
+                        {
+                            mqtt_socket->start(address);
+                        }
                     }
                 }
 
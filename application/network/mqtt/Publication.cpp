@@ -7,10 +7,7 @@
 #include <smooth/application/network/mqtt/packet/PubComp.h>
 #include <smooth/application/network/mqtt/Logging.h>
 #include <smooth/core/logging/log.h>
-
-#ifdef ESP_PLATFORM
-#include "sdkconfig.h"
-#endif
+#include <algorithm>
 
 using namespace std::chrono;
 using namespace smooth::core::logging;
@@ -23,35 +20,186 @@ namespace smooth
         {
             namespace mqtt
             {
-                Publication::Publication()
+                Publication::Publication(const MqttClientOptions& options)
+                        : options(options),
+                          log(options.persistence_directory, options.persistence_segment_size)
+                {
+                    in_flight.reserve(max_in_flight);
+                    restore();
+                }
+
+                void Publication::restore()
                 {
-                    in_progress.reserve(CONFIG_SMOOTH_MAX_MQTT_OUTGOING_MESSAGES);
+                    std::vector<PublishLog::Message> restored;
+                    log.load(restored);
+
+                    for (auto& message : restored)
+                    {
+                        // In the order they were stored, so the identifiers continue from the newest message.
+                        auto id = message.packet.get_packet_identifier();
+                        packet::PacketIdentifierFactory::advance_past(id);
+
+                        // The messages may have been sent before the restart, so they are treated as awaiting
+                        // acknowledgement; resend_outstanding_control_packet() sends them again once connected.
+                        InFlight<packet::Publish> flight(std::move(message.packet));
+
+                        if (message.received)
+                        {
+                            flight.set_wait_packet(PUBCOMP);
+                        }
+                        else
+                        {
+                            flight.set_wait_packet(flight.get_packet().get_qos() == QoS::AT_LEAST_ONCE
+                                                   ? PUBACK : PUBREC);
+                        }
+
+                        ++status.messages;
+                        status.bytes += get_size(flight.get_packet());
+                        in_flight.insert(id, std::move(flight));
+                    }
                 }
 
                 bool Publication::publish(const std::string& topic, const uint8_t* data, int length, mqtt::QoS qos,
                                           bool retain)
                 {
-                    std::lock_guard<std::mutex> lock(guard);
-                    bool res = in_progress.size() < CONFIG_SMOOTH_MAX_MQTT_OUTGOING_MESSAGES;
+                    return enqueue(packet::Publish(topic, data, length, qos, retain));
+                }
+
+                bool Publication::publish(const std::string& topic, std::vector<uint8_t>&& data, mqtt::QoS qos,
+                                          bool retain)
+                {
+                    // The packet takes over the data, so it is only created once there is room for it; a rejected
+                    // message leaves the data with the caller.
+                    std::unique_lock<std::mutex> lock(guard);
+                    bool res = make_room(lock, get_size(topic, data.size(), qos));
+
                     if (res)
                     {
-                        packet::Publish p(topic, data, length, qos, retain);
-                        in_progress.emplace_back(p);
+                        add(packet::Publish(topic, std::move(data), qos, retain));
                     }
 
                     return res;
                 }
 
+                bool Publication::publish(const std::string& topic,
+                                          std::shared_ptr<const smooth::core::network::ExternalPayload> payload,
+                                          mqtt::QoS qos, bool retain)
+                {
+                    return enqueue(packet::Publish(topic, std::move(payload), qos, retain));
+                }
+
+                bool Publication::enqueue(packet::Publish&& packet)
+                {
+                    std::unique_lock<std::mutex> lock(guard);
+                    bool res = make_room(lock, get_size(packet));
+
+                    if (res)
+                    {
+                        add(std::move(packet));
+                    }
+
+                    return res;
+                }
+
+                bool Publication::make_room(std::unique_lock<std::mutex>& lock, size_t size)
+                {
+                    if (options.overflow_policy == OverflowPolicy::DropOldest)
+                    {
+                        while (!has_room(size) && !in_progress.empty())
+                        {
+                            release(in_progress.front().get_packet());
+                            in_progress.pop_front();
+                            ++status.dropped;
+                        }
+                    }
+                    else if (options.overflow_policy == OverflowPolicy::Block)
+                    {
+                        room.wait_for(lock, options.block_timeout, [this, size]() { return has_room(size); });
+                    }
+
+                    bool res = has_room(size);
+
+                    if (!res)
+                    {
+                        ++status.dropped;
+                    }
+
+                    return res;
+                }
+
+                void Publication::add(packet::Publish&& packet)
+                {
+                    in_progress.emplace_back(std::move(packet));
+                    ++status.messages;
+                    status.bytes += get_size(in_progress.back().get_packet());
+
+                    if (in_progress.back().get_packet().get_qos() != QoS::AT_MOST_ONCE)
+                    {
+                        log.store(in_progress.back().get_packet());
+                    }
+                }
+
+                bool Publication::has_room(size_t size) const
+                {
+                    return status.messages < options.max_outgoing_messages
+                           && (options.max_outgoing_bytes == 0 || status.bytes + size <= options.max_outgoing_bytes);
+                }
+
+                void Publication::release(packet::Publish& packet)
+                {
+                    if (packet.get_qos() != QoS::AT_MOST_ONCE)
+                    {
+                        log.remove(packet.get_packet_identifier());
+                    }
+
+                    --status.messages;
+                    status.bytes -= get_size(packet);
+                    room.notify_all();
+                }
+
+                size_t Publication::get_size(packet::Publish& packet)
+                {
+                    auto payload = packet.get_external_payload();
+                    return static_cast<size_t>(packet.get_send_length())
+                           + (payload && !payload->is_file() ? payload->get_length() : 0);
+                }
+
+                size_t Publication::get_size(const std::string& topic, size_t payload_length, mqtt::QoS qos)
+                {
+                    // Topic length, topic, packet identifier and payload, after the type and the remaining length.
+                    auto remaining = 2 + topic.length() + (qos != QoS::AT_MOST_ONCE ? 2 : 0) + payload_length;
+                    size_t length_bytes = 1;
+
+                    for (auto r = remaining >> 7; r > 0; r >>= 7)
+                    {
+                        ++length_bytes;
+                    }
+
+                    return 1 + length_bytes + remaining;
+                }
+
+                OutgoingQueueStatus Publication::get_status()
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    return status;
+                }
+
+                void Publication::set_max_in_flight(size_t count)
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    max_in_flight = std::max(count, static_cast<size_t>(1));
+                    in_flight.reserve(max_in_flight);
+                }
+
                 void Publication::handle_disconnect()
                 {
                     std::lock_guard<std::mutex> lock(guard);
                     // When a disconnection happens, any outgoing messages currently being timed must be reset
                     // so that they don't cause a timeout before a resend of the package happens.
-                    if (!in_progress.empty())
-                    {
-                        auto& flight = in_progress.front();
-                        flight.zero_timer();
-                    }
+                    in_flight.for_each([](uint16_t, InFlight<packet::Publish>& flight)
+                                       {
+                                           flight.zero_timer();
+                                       });
                 }
 
                 void Publication::resend_outstanding_control_packet(IMqttClient& mqtt, bool clean_session)
@@ -63,52 +211,53 @@ namespace smooth
                     // Packet Identifiers [MQTT-4.4.0-1]. This is the only circumstance where a Client or Server is
                     // REQUIRED to redeliver messages.
 
-                    if (!in_progress.empty())
+                    // Messages kept in the log were meant to survive even a restart, so they are sent again
+                    // also when the session wasn't kept by the broker.
+                    if (clean_session && !log.is_enabled())
                     {
-                        auto& flight = in_progress.front();
+                        // Drop messages
+                        in_flight.for_each([this](uint16_t, InFlight<packet::Publish>& flight)
+                                           {
+                                               release(flight.get_packet());
+                                           });
 
-                        if (clean_session)
-                        {
-                            if (flight.get_waiting_for() == PacketType::PUBACK
-                                || flight.get_waiting_for() == PacketType::PUBREC
-                                || flight.get_waiting_for() == PacketType::PUBCOMP)
-                            {
-                                // Drop message
-                                in_progress.erase(in_progress.begin());
-                            }
-                        }
-                        else
+                        in_flight.clear();
+                        pending_pub_rels = 0;
+                    }
+                    else
+                    {
+                        // Go backwards so that messages to be published again end up first in the queue,
+                        // in their original order.
+                        for (auto id = in_flight.last_id(); id >= 0;)
                         {
+                            auto& flight = *in_flight.find(static_cast<uint16_t>(id));
+                            auto previous = in_flight.previous_id(static_cast<uint16_t>(id));
                             auto& packet = flight.get_packet();
+                            bool publish_again = true;
 
                             if (flight.get_waiting_for() == PacketType::PUBACK)
                             {
                                 // Set dup flag and let normal procedure send the packet.
                                 packet.set_dup_flag();
-                                flight.zero_timer();
-                                flight.set_wait_packet(PacketType::Reserved);
-                            }
-                            else if (flight.get_waiting_for() == PacketType::PUBREC)
-                            {
-                                // Let normal procedure send the packet
-                                flight.zero_timer();
-                                flight.set_wait_packet(PacketType::Reserved);
                             }
                             else if (flight.get_waiting_for() == PacketType::PUBCOMP)
                             {
-                                packet::PubRel pub_rel(packet.get_packet_identifier());
-
-                                // As this is running directly after a reconnect, and the TX buffer is cleared
-                                // on disconnect, it is guaranteed that this message will fit in the buffer.
-                                mqtt.send_packet(pub_rel);
+                                // With a window larger than the transmit buffer, not all PubRels fit at once;
+                                // the rest are sent as the client ticks.
+                                send_pub_rel(flight, mqtt);
+                                publish_again = false;
                             }
-                            else
+
+                            if (publish_again)
                             {
-                                // Haven't gotten far enough to wait for PUBACK or PUBCOMP, reset.
-                                packet.set_dup_flag();
-                                flight.start_timer();
+                                // Let normal procedure send the packet
+                                flight.zero_timer();
                                 flight.set_wait_packet(PacketType::Reserved);
+                                in_progress.push_front(std::move(flight));
+                                in_flight.erase(static_cast<uint16_t>(id));
                             }
+
+                            id = previous;
                         }
                     }
                 }
@@ -117,151 +266,215 @@ namespace smooth
                 {
                     std::lock_guard<std::mutex> lock(guard);
 
-                    auto& flight = in_progress.front();
-                    auto& packet = flight.get_packet();
+                    // Messages are written to storage, in one batch per call, before they are sent.
+                    flush_log();
 
-                    if (!in_progress.empty())
+                    if (pending_pub_rels > 0)
                     {
-                        if (packet.get_qos() == QoS::AT_MOST_ONCE)
+                        send_pending_pub_rels(mqtt);
+                    }
+
+                    // Send as many messages as the window allows, in order. QoS 0 messages are not acknowledged
+                    // and so never occupy the window.
+                    bool sent = true;
+
+                    while (sent && !in_progress.empty()
+                           && (in_progress.front().get_packet().get_qos() == QoS::AT_MOST_ONCE
+                               || in_flight.size() < max_in_flight))
+                    {
+                        auto& flight = in_progress.front();
+                        sent = send(flight, mqtt);
+
+                        if (sent)
                         {
-                            // Fire and forget
-                            if (mqtt.send_packet(packet))
+                            if (flight.get_packet().get_qos() == QoS::AT_MOST_ONCE)
                             {
                                 Log::verbose(mqtt_log_tag,
-                                             Format("QoS {1} publish completed", Int32(packet.get_qos())));
-                                in_progress.erase(in_progress.begin());
+                                             Format("QoS {1} publish completed", Int32(flight.get_packet().get_qos())));
+                                release(flight.get_packet());
                             }
                             else
                             {
-                                Log::error(mqtt_log_tag,
-                                           Format("Could not enqueue packet of QoS {1}",
-                                                  Int32(packet.get_qos())));
+                                auto id = flight.get_packet().get_packet_identifier();
+                                in_flight.insert(id, std::move(flight));
                             }
+
+                            in_progress.pop_front();
                         }
-                        else if (flight.get_waiting_for() == PacketType::Reserved)
-                        {
-                            // Packet with QoS > AT_MOST_ONCE and not yet sent first in queue.
-                            // We will only ever have a single active in-flight message
+                    }
 
-                            if (packet.get_qos() == QoS::AT_LEAST_ONCE)
-                            {
-                                // Send packet, wait for PubAck
-                                if (mqtt.send_packet(packet))
-                                {
-                                    flight.start_timer();
-                                    flight.set_wait_packet(PUBACK);
-                                }
-                                else
-                                {
-                                    Log::error(mqtt_log_tag,
-                                               Format("Could not enqueue packet of QoS {1}",
-                                                      Int32(packet.get_qos())));
-                                }
-                            }
-                            else if (packet.get_qos() == QoS::EXACTLY_ONCE)
-                            {
-                                // Send packet, wait for PubRec
-                                if (mqtt.send_packet(packet))
-                                {
-                                    flight.start_timer();
-                                    flight.set_wait_packet(PUBREC);
-                                }
-                                else
-                                {
-                                    Log::error(mqtt_log_tag,
-                                               Format("Could not enqueue packet of QoS {1}",
-                                                      Int32(packet.get_qos())));
-                                }
-                            }
+                    // Only the message that has waited the longest needs checking.
+                    auto oldest = in_flight.first_id();
+                    auto flight = oldest >= 0 ? in_flight.find(static_cast<uint16_t>(oldest)) : nullptr;
 
-                            // At this point, the message we're currently trying to send
-                            // will be left first in the vector.
-                        }
-                        else
+                    if (flight != nullptr && flight->get_elapsed_time() > seconds(5))
+                    {
+                        flight->stop_timer();
+
+                        // Waited too long, force a disconnect.
+                        Log::error(mqtt_log_tag,
+                                   Format(Str(
+                                           "Too long since a reply was received to a publish message, forcing disconnect.")));
+
+                        mqtt.force_disconnect();
+                    }
+                }
+
+                void Publication::persist()
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    flush_log();
+                }
+
+                void Publication::flush_log()
+                {
+                    bool failed = !log.flush();
+
+                    if (failed && !log_failing)
+                    {
+                        // The records are kept and written again on each call, until that succeeds; meanwhile
+                        // messages are sent without being persisted.
+                        Log::error(mqtt_log_tag, Format("Could not write the persistence log in {1}",
+                                                        Str(options.persistence_directory)));
+                    }
+                    else if (!failed && log_failing)
+                    {
+                        Log::info(mqtt_log_tag, Format("Writing the persistence log succeeded again"));
+                    }
+
+                    log_failing = failed;
+                }
+
+                bool Publication::send(InFlight<packet::Publish>& flight, IMqttClient& mqtt)
+                {
+                    auto& packet = flight.get_packet();
+                    bool res = mqtt.send_packet(packet);
+
+                    if (!res)
+                    {
+                        // The transmit buffer is full, try again later.
+                        Log::verbose(mqtt_log_tag,
+                                     Format("Could not enqueue packet of QoS {1}", Int32(packet.get_qos())));
+                    }
+                    else if (packet.get_qos() == QoS::AT_LEAST_ONCE)
+                    {
+                        // Wait for PubAck
+                        flight.start_timer();
+                        flight.set_wait_packet(PUBACK);
+                    }
+                    else if (packet.get_qos() == QoS::EXACTLY_ONCE)
+                    {
+                        // Wait for PubRec
+                        flight.start_timer();
+                        flight.set_wait_packet(PUBREC);
+                    }
+
+                    return res;
+                }
+
+                bool Publication::send_pub_rel(InFlight<packet::Publish>& flight, IMqttClient& mqtt)
+                {
+                    packet::PubRel pub_rel(flight.get_packet().get_packet_identifier());
+                    bool res = mqtt.send_packet(pub_rel);
+
+                    if (res)
+                    {
+                        // Wait for PubComp
+                        flight.start_timer();
+                    }
+                    else
+                    {
+                        // The transmit buffer is full; the reply isn't waited for until the PubRel has been sent.
+                        Log::verbose(mqtt_log_tag, Format("Could not enqueue PubRel, retrying later"));
+                        flight.zero_timer();
+                    }
+
+                    // The timer was restarted or stopped, so the message no longer has waited the longest.
+                    in_flight.move_to_back(flight.get_packet().get_packet_identifier());
+
+                    if (res == flight.is_pub_rel_pending())
+                    {
+                        pending_pub_rels = res ? pending_pub_rels - 1 : pending_pub_rels + 1;
+                    }
+
+                    flight.set_pub_rel_pending(!res);
+
+                    return res;
+                }
+
+                void Publication::send_pending_pub_rels(IMqttClient& mqtt)
+                {
+                    bool sent = true;
+
+                    for (auto id = in_flight.first_id(); sent && pending_pub_rels > 0 && id >= 0;)
+                    {
+                        auto& flight = *in_flight.find(static_cast<uint16_t>(id));
+                        auto next = in_flight.next_id(static_cast<uint16_t>(id));
+
+                        if (flight.is_pub_rel_pending())
                         {
-                            // Still waiting for a reply...
-                            if (flight.get_elapsed_time() > seconds(5))
-                            {
-                                // Waited too long, force a disconnect.
-                                Log::error(mqtt_log_tag,
-                                           Format(Str(
-                                                   "Too long since a reply was received to a publish message, forcing disconnect.")));
+                            sent = send_pub_rel(flight, mqtt);
+                        }
 
-                                flight.stop_timer();
-                                mqtt.force_disconnect();
-                            }
-                            else
-                            {
-                                Log::debug(mqtt_log_tag,
-                                           Format("Waiting to send: {1}, QoS {1}, waiting for: {3}, timer: {4}s",
-                                                  Str(packet.get_mqtt_type_as_string()),
-                                                  Int32(packet.get_qos()),
-                                                  Int32(flight.get_waiting_for()),
-                                                  Int64(flight.get_elapsed_time().count())));
-                            }
+                        id = next;
+                    }
+                }
+
+                void Publication::remove_in_flight(uint16_t packet_identifier)
+                {
+                    auto found = in_flight.find(packet_identifier);
+                    if (found != nullptr)
+                    {
+                        if (found->is_pub_rel_pending())
+                        {
+                            --pending_pub_rels;
                         }
+
+                        release(found->get_packet());
+                        in_flight.erase(packet_identifier);
                     }
                 }
 
                 void Publication::receive(packet::PubAck& pub_ack, IMqttClient& mqtt)
                 {
                     std::lock_guard<std::mutex> lock(guard);
-                    auto first = in_progress.begin();
-                    if (first != in_progress.end())
+                    auto id = pub_ack.get_packet_identifier();
+                    auto found = in_flight.find(id);
+                    if (found != nullptr && found->get_waiting_for() == PUBACK)
                     {
-                        auto& flight = *first;
-                        if (flight.get_packet().get_packet_identifier() == pub_ack.get_packet_identifier())
-                        {
-                            Log::verbose(mqtt_log_tag,
-                                         Format("QoS {1} publish completed", Int32(flight.get_packet().get_qos())));
-                            in_progress.erase(in_progress.begin());
-                        }
+                        Log::verbose(mqtt_log_tag,
+                                     Format("QoS {1} publish completed", Int32(found->get_packet().get_qos())));
+                        remove_in_flight(id);
                     }
                 }
 
                 void Publication::receive(packet::PubRec& pub_rec, IMqttClient& mqtt)
                 {
                     std::lock_guard<std::mutex> lock(guard);
-                    auto first = in_progress.begin();
-                    if (first != in_progress.end())
+                    auto id = pub_rec.get_packet_identifier();
+                    auto found = in_flight.find(id);
+                    if (found != nullptr && found->get_waiting_for() == PUBREC)
                     {
-                        auto& flight = *first;
-                        if (flight.get_waiting_for() == PUBREC
-                            && flight.get_packet().get_packet_identifier() == pub_rec.get_packet_identifier())
-                        {
-                            flight.start_timer();
-
-                            packet::PubRel pub_rel(flight.get_packet().get_packet_identifier());
+                        auto& flight = *found;
+                        flight.set_wait_packet(PUBCOMP);
+                        log.received(id);
 
-                            if (mqtt.send_packet(pub_rel))
-                            {
-                                // Wait for PubComp and send PubRel
-                                first->set_wait_packet(PUBCOMP);
-                            }
-                            else
-                            {
-                                // Couldn't send, this will result in a timeout and reconnect with subsequent resend.
-                            }
-                        }
+                        // If the transmit buffer is full, the PubRel is sent when the client next ticks.
+                        send_pub_rel(flight, mqtt);
                     }
                 }
 
                 void Publication::receive(packet::PubComp& pub_rec, IMqttClient& mqtt)
                 {
                     std::lock_guard<std::mutex> lock(guard);
-                    auto first = in_progress.begin();
-                    if (first != in_progress.end())
+                    auto id = pub_rec.get_packet_identifier();
+                    auto found = in_flight.find(id);
+                    if (found != nullptr && found->get_waiting_for() == PUBCOMP)
                     {
-                        auto& flight = *first;
-
-                        if (flight.get_waiting_for() == PUBCOMP
-                            && flight.get_packet().get_packet_identifier() == pub_rec.get_packet_identifier())
-                        {
-                            Log::verbose(mqtt_log_tag,
-                                         Format("QoS {1} publish completed",
-                                                Int32(flight.get_packet().get_qos())));
-                            in_progress.erase(in_progress.begin());
-                        }
+                        Log::verbose(mqtt_log_tag,
+                                     Format("QoS {1} publish completed",
+                                            Int32(found->get_packet().get_qos())));
+                        remove_in_flight(id);
                     }
                 }
 
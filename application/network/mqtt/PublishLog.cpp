@@ -0,0 +1,514 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <smooth/application/network/mqtt/PublishLog.h>
+#include <smooth/application/network/mqtt/Logging.h>
+#include <smooth/core/filesystem/File.h>
+#include <smooth/core/logging/log.h>
+
+using namespace smooth::core::logging;
+using namespace smooth::core::filesystem;
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                // A record is a header of type (1 byte), packet identifier (2), sequence number (4), data length (4)
+                // and checksum (4), followed by the data. All values are stored most significant byte first. The
+                // checksum covers everything but itself, so that a partially written batch is detected on load.
+                static const size_t header_size = 15;
+                static const size_t checksum_offset = 11;
+
+                static void append_be(std::vector<uint8_t>& target, uint32_t value, int bytes)
+                {
+                    for (auto shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+                    {
+                        target.push_back(static_cast<uint8_t>(value >> shift));
+                    }
+                }
+
+                static uint32_t read_be(const uint8_t* data, int bytes)
+                {
+                    uint32_t value = 0;
+
+                    for (int i = 0; i < bytes; ++i)
+                    {
+                        value = value << 8 | data[i];
+                    }
+
+                    return value;
+                }
+
+                // FNV-1a
+                static uint32_t checksum(const uint8_t* header, const uint8_t* data, size_t length)
+                {
+                    uint32_t hash = 2166136261u;
+
+                    for (size_t i = 0; i < checksum_offset; ++i)
+                    {
+                        hash = (hash ^ header[i]) * 16777619u;
+                    }
+
+                    for (size_t i = 0; i < length; ++i)
+                    {
+                        hash = (hash ^ data[i]) * 16777619u;
+                    }
+
+                    return hash;
+                }
+
+                template<typename Handler>
+                void PublishLog::parse(const std::vector<uint8_t>& content, Handler handler)
+                {
+                    size_t pos = 0;
+                    bool valid = true;
+
+                    while (valid && pos + header_size <= content.size())
+                    {
+                        auto record = &content[pos];
+                        auto length = read_be(record + 7, 4);
+
+                        valid = length <= content.size() - pos - header_size
+                                && checksum(record, record + header_size, length)
+                                   == read_be(record + checksum_offset, 4);
+
+                        if (valid)
+                        {
+                            handler(static_cast<RecordType>(record[0]),
+                                    static_cast<uint16_t>(read_be(record + 1, 2)),
+                                    read_be(record + 3, 4),
+                                    record + header_size,
+                                    length,
+                                    header_size + length);
+
+                            pos += header_size + length;
+                        }
+                    }
+
+                    if (pos < content.size())
+                    {
+                        Log::warning(mqtt_log_tag, Format("Ignoring {1} bytes of incomplete log records",
+                                                          UInt32(static_cast<uint32_t>(content.size() - pos))));
+                    }
+                }
+
+                PublishLog::PublishLog(std::string directory, size_t segment_size)
+                        : directory(std::move(directory)),
+                          segment_size(segment_size)
+                {
+                }
+
+                PublishLog::~PublishLog()
+                {
+                    flush();
+                }
+
+                void PublishLog::load(std::vector<Message>& messages)
+                {
+                    if (is_enabled())
+                    {
+                        // Fails if the directory already exists, which is fine.
+                        mkdir(directory.c_str(), 0755);
+
+                        std::vector<uint32_t> numbers;
+                        auto dir = opendir(directory.c_str());
+
+                        if (dir == nullptr)
+                        {
+                            Log::error(mqtt_log_tag, Format("Could not open log directory {1}", Str(directory)));
+                        }
+                        else
+                        {
+                            for (auto item = readdir(dir); item != nullptr; item = readdir(dir))
+                            {
+                                char* end;
+                                auto number = strtoul(item->d_name, &end, 10);
+
+                                // FAT file systems may report the name in upper case.
+                                if (end != item->d_name && strcasecmp(end, ".log") == 0)
+                                {
+                                    numbers.push_back(static_cast<uint32_t>(number));
+                                }
+                            }
+
+                            closedir(dir);
+                        }
+
+                        std::sort(numbers.begin(), numbers.end());
+                        std::unordered_map<uint32_t, std::vector<uint8_t>> data;
+
+                        for (auto number : numbers)
+                        {
+                            std::vector<uint8_t> content;
+                            File(get_segment_path(number)).read(content);
+                            segments[number].size = content.size();
+
+                            parse(content, [this, number, &data](RecordType type, uint16_t id, uint32_t sequence,
+                                                                 const uint8_t* record_data, size_t length,
+                                                                 size_t size)
+                            {
+                                auto entry = entries.find(sequence);
+
+                                if (type == STORE)
+                                {
+                                    add_entry(sequence, Entry{id, number, static_cast<uint32_t>(size), false});
+                                    data[sequence].assign(record_data, record_data + length);
+                                    next_sequence = std::max(next_sequence, sequence + 1);
+                                }
+                                else if (entry != entries.end() && entry->second.id == id)
+                                {
+                                    if (type == RECEIVED)
+                                    {
+                                        entry->second.received = true;
+                                    }
+                                    else
+                                    {
+                                        remove_entry(sequence);
+                                        data.erase(sequence);
+                                    }
+                                }
+                            });
+
+                            // A batch may have been partially written to the last segment, so new records always
+                            // go to a new one.
+                            current_segment = number + 1;
+                        }
+
+                        std::vector<uint32_t> order;
+
+                        for (auto& entry : entries)
+                        {
+                            order.push_back(entry.first);
+                        }
+
+                        std::sort(order.begin(), order.end());
+
+                        for (auto sequence : order)
+                        {
+                            Message message;
+                            message.packet = packet::Publish(std::move(data[sequence]));
+                            message.received = entries[sequence].received;
+                            messages.push_back(std::move(message));
+                        }
+
+                        Log::info(mqtt_log_tag, Format("Restored {1} messages from {2} log segments",
+                                                       UInt32(static_cast<uint32_t>(messages.size())),
+                                                       UInt32(static_cast<uint32_t>(numbers.size()))));
+
+                        compact();
+                    }
+                }
+
+                void PublishLog::store(packet::Publish& packet)
+                {
+                    auto payload = packet.get_external_payload();
+
+                    if (is_enabled() && (!payload || !payload->is_file()))
+                    {
+                        Record record{STORE, packet.get_packet_identifier(), next_sequence++, {}, false, 0};
+                        auto data = packet.get_data();
+                        auto length = static_cast<size_t>(packet.get_send_length());
+
+                        record.data.reserve(length + (payload ? payload->get_length() : 0));
+                        record.data.insert(record.data.end(), data, data + length);
+
+                        if (payload)
+                        {
+                            record.data.insert(record.data.end(), payload->get_data(),
+                                               payload->get_data() + payload->get_length());
+                        }
+
+                        stats.bytes_stored += record.data.size();
+                        pending_stores[record.id] = pending.size();
+                        pending.push_back(std::move(record));
+                    }
+                }
+
+                void PublishLog::received(uint16_t packet_identifier)
+                {
+                    auto stored = pending_stores.find(packet_identifier);
+                    auto entry = find_entry(packet_identifier);
+
+                    if (stored != pending_stores.end())
+                    {
+                        pending.push_back(Record{RECEIVED, packet_identifier, pending[stored->second].sequence, {},
+                                                 false, 0});
+                    }
+                    else if (entry != entries.end())
+                    {
+                        pending.push_back(Record{RECEIVED, packet_identifier, entry->first, {}, false, 0});
+                    }
+                }
+
+                void PublishLog::remove(uint16_t packet_identifier)
+                {
+                    auto stored = pending_stores.find(packet_identifier);
+                    auto entry = find_entry(packet_identifier);
+
+                    if (stored != pending_stores.end())
+                    {
+                        // Not written yet, so there's no need to write it at all.
+                        pending[stored->second].cancelled = true;
+                        pending_stores.erase(stored);
+                    }
+                    else if (entry != entries.end())
+                    {
+                        pending.push_back(Record{REMOVED, packet_identifier, entry->first, {}, false, 0});
+                    }
+                }
+
+                bool PublishLog::flush()
+                {
+                    bool res = true;
+
+                    if (!pending.empty())
+                    {
+                        if (segments[current_segment].size >= segment_size)
+                        {
+                            segments[++current_segment] = Segment{};
+                        }
+
+                        buffer.clear();
+
+                        for (auto& record : pending)
+                        {
+                            record.size = 0;
+
+                            if (record.type == STORE ? !record.cancelled : refers_to_outstanding(record))
+                            {
+                                auto start = buffer.size();
+                                append_record(record.type, record.id, record.sequence, record.data.data(),
+                                              record.data.size());
+                                record.size = static_cast<uint32_t>(buffer.size() - start);
+                            }
+                        }
+
+                        res = write_buffer();
+
+                        // The entries only change once the records are written; after a failed write, the same
+                        // records are written again by the next flush.
+                        if (res)
+                        {
+                            for (auto& record : pending)
+                            {
+                                auto entry = entries.find(record.sequence);
+
+                                if (record.size == 0)
+                                {
+                                    // Not written
+                                }
+                                else if (record.type == STORE)
+                                {
+                                    add_entry(record.sequence, Entry{record.id, current_segment, record.size, false});
+                                }
+                                else if (entry != entries.end() && entry->second.id == record.id)
+                                {
+                                    if (record.type == RECEIVED)
+                                    {
+                                        entry->second.received = true;
+                                    }
+                                    else
+                                    {
+                                        remove_entry(record.sequence);
+                                    }
+                                }
+                            }
+
+                            pending.clear();
+                            pending_stores.clear();
+                            compact();
+                        }
+                    }
+
+                    return res;
+                }
+
+                bool PublishLog::refers_to_outstanding(const Record& record) const
+                {
+                    auto stored = pending_stores.find(record.id);
+
+                    return entries.count(record.sequence) != 0
+                           || (stored != pending_stores.end() && pending[stored->second].sequence == record.sequence);
+                }
+
+                void PublishLog::append_record(RecordType type, uint16_t id, uint32_t sequence,
+                                               const uint8_t* data, size_t length)
+                {
+                    auto start = buffer.size();
+                    buffer.push_back(type);
+                    append_be(buffer, id, 2);
+                    append_be(buffer, sequence, 4);
+                    append_be(buffer, static_cast<uint32_t>(length), 4);
+                    append_be(buffer, checksum(&buffer[start], data, length), 4);
+                    buffer.insert(buffer.end(), data, data + length);
+                }
+
+                void PublishLog::add_entry(uint32_t sequence, const Entry& entry)
+                {
+                    // A message copied by an interrupted compaction is found twice; the later copy wins.
+                    remove_entry(sequence);
+                    entries[sequence] = entry;
+                    auto& segment = segments[entry.segment];
+                    segment.live_size += entry.size;
+                    ++segment.live_count;
+
+                    // Copying an older message doesn't take the identifier from a newer one.
+                    auto newest = sequences.emplace(entry.id, sequence).first;
+                    newest->second = std::max(newest->second, sequence);
+                }
+
+                void PublishLog::remove_entry(uint32_t sequence)
+                {
+                    auto entry = entries.find(sequence);
+
+                    if (entry != entries.end())
+                    {
+                        auto& segment = segments[entry->second.segment];
+                        segment.live_size -= entry->second.size;
+                        --segment.live_count;
+
+                        auto newest = sequences.find(entry->second.id);
+
+                        if (newest != sequences.end() && newest->second == sequence)
+                        {
+                            sequences.erase(newest);
+                        }
+
+                        entries.erase(entry);
+                    }
+                }
+
+                std::unordered_map<uint32_t, PublishLog::Entry>::iterator PublishLog::find_entry(uint16_t id)
+                {
+                    auto newest = sequences.find(id);
+                    return newest == sequences.end() ? entries.end() : entries.find(newest->second);
+                }
+
+                bool PublishLog::write_buffer()
+                {
+                    // Appending creates the file of a new segment, and its entry in the directory has to be
+                    // synced as well for the segment to be found after a power loss.
+                    bool created = segments[current_segment].size == 0;
+                    bool res = buffer.empty()
+                               || (File(get_segment_path(current_segment)).append(buffer.data(), buffer.size())
+                                   && (!created || File::sync_directory(directory)));
+                    if (res)
+                    {
+                        stats.bytes_written += buffer.size();
+                        stats.batches += buffer.empty() ? 0 : 1;
+                        segments[current_segment].size += buffer.size();
+                    }
+                    else
+                    {
+                        // Part of the buffer may have been written; load() stops reading a segment at the first
+                        // broken record, so nothing may be appended after it.
+                        segments[++current_segment] = Segment{};
+                    }
+
+                    return res;
+                }
+
+                void PublishLog::compact()
+                {
+                    bool removed = true;
+
+                    // Only the oldest segment is ever deleted. A later segment may hold the records acknowledging
+                    // messages stored in earlier ones, and without them load() would restore those messages.
+                    while (removed && !segments.empty() && segments.begin()->first != current_segment)
+                    {
+                        auto oldest = segments.begin();
+                        size_t size = 0;
+                        size_t live_size = 0;
+
+                        for (auto& segment : segments)
+                        {
+                            size += segment.second.size;
+                            live_size += segment.second.live_size;
+                        }
+
+                        // Keeping a mostly acknowledged segment around for a few outstanding messages would let
+                        // the log grow without bounds, as would an oldest segment pinning the ones after it.
+                        removed = oldest->second.live_count == 0
+                                  || ((oldest->second.live_size * 4 < oldest->second.size || live_size * 4 < size)
+                                      && copy_live_messages(oldest->first));
+
+                        if (removed)
+                        {
+                            File(get_segment_path(oldest->first)).remove();
+                            ++stats.segments_deleted;
+                            segments.erase(oldest);
+                        }
+                    }
+                }
+
+                bool PublishLog::copy_live_messages(uint32_t segment)
+                {
+                    std::vector<uint8_t> content;
+                    bool res = File(get_segment_path(segment)).read(content);
+
+                    if (res)
+                    {
+                        std::vector<std::pair<uint32_t, Entry>> copied;
+                        buffer.clear();
+
+                        parse(content, [this, segment, &copied](RecordType type, uint16_t id, uint32_t sequence,
+                                                                const uint8_t* data, size_t length, size_t)
+                        {
+                            auto entry = entries.find(sequence);
+
+                            if (type == STORE && entry != entries.end() && entry->second.segment == segment
+                                && entry->second.id == id)
+                            {
+                                auto start = buffer.size();
+                                append_record(STORE, id, sequence, data, length);
+
+                                if (entry->second.received)
+                                {
+                                    append_record(RECEIVED, id, sequence, nullptr, 0);
+                                }
+
+                                copied.emplace_back(sequence, Entry{id,
+                                                                    current_segment,
+                                                                    static_cast<uint32_t>(buffer.size() - start),
+                                                                    entry->second.received});
+                            }
+                        });
+
+                        // Only move the messages once their copies are safely written.
+                        res = write_buffer();
+
+                        if (res)
+                        {
+                            for (auto& item : copied)
+                            {
+                                add_entry(item.first, item.second);
+                            }
+
+                            ++stats.segments_compacted;
+                        }
+                    }
+
+                    return res;
+                }
+
+                std::string PublishLog::get_segment_path(uint32_t segment) const
+                {
+                    char name[16];
+                    snprintf(name, sizeof(name), "/%08u.log", static_cast<unsigned>(segment));
+                    return directory + name;
+                }
+            }
+        }
+    }
+}
@@ -18,9 +18,10 @@ namespace smooth
         {
             namespace mqtt
             {
-                void Subscription::subscribe(const std::string& topic, QoS qos)
+                void Subscription::subscribe(const std::string& topic, QoS qos, const TopicRouter::Destination& queue)
                 {
                     std::lock_guard<std::mutex> lock(guard);
+                    router.add(topic, queue);
                     // Check active and not-yet completed subscriptions
                     internal_subscribe(topic, qos);
                 }
@@ -51,6 +52,8 @@ namespace smooth
                 void Subscription::unsubscribe(const std::string& topic)
                 {
                     std::lock_guard<std::mutex> lock(guard);
+                    // Messages already on their way are passed to the application queue.
+                    router.remove(topic);
                     // Just enqueue for transfer to server.
                     packet::Unsubscribe us(topic);
                     unsubscribing.emplace_back(us);
@@ -67,26 +70,22 @@ namespace smooth
                     if (all_ok)
                     {
                         // Resend any unacknowledged Publish messages
-                        for (auto& pair : receiving)
-                        {
-                            auto& flight = pair.second;
-
-                            if (flight.get_waiting_for() == PacketType::PUBREL)
-                            {
-                                if (flight.get_elapsed_time() > std::chrono::seconds(5))
-                                {
-                                    // Send a PubRec message.
-                                    auto& packet = flight.get_packet();
-                                    packet::PubRec rec(packet.get_packet_identifier());
-                                    // If we can enqueue it, restart the timer to give the response a chance to arrive.
-                                    // Otherwise, another try will happen the next turn.
-                                    if (mqtt.send_packet(rec))
-                                    {
-                                        flight.start_timer();
-                                    }
-                                }
-                            }
-                        }
+                        receiving.for_each([&mqtt](uint16_t id, InFlight<packet::Publish>& flight)
+                                           {
+                                               if (flight.get_waiting_for() == PacketType::PUBREL
+                                                   && flight.get_elapsed_time() > std::chrono::seconds(5))
+                                               {
+                                                   // Send a PubRec message.
+                                                   packet::PubRec rec(id);
+                                                   // If we can enqueue it, restart the timer to give the response
+                                                   // a chance to arrive. Otherwise, another try will happen the
+                                                   // next turn.
+                                                   if (mqtt.send_packet(rec))
+                                                   {
+                                                       flight.start_timer();
+                                                   }
+                                               }
+                                           });
                     }
                 }
 
@@ -133,7 +132,7 @@ namespace smooth
                                 active_subscription.emplace(t.first, t.second);
                             }
 
-                            subscribing.erase(subscribing.begin());
+                            subscribing.pop_front();
                         }
                     }
                 }
@@ -157,18 +156,17 @@ namespace smooth
                     else if (publish.get_qos() == QoS::EXACTLY_ONCE)
                     {
                         // Do we know of a packet with this packet id already?
-                        auto known = receiving.find(publish.get_packet_identifier());
-                        if (known == receiving.end())
+                        auto id = publish.get_packet_identifier();
+                        if (receiving.find(id) == nullptr)
                         {
                             // Prepare to receive a PubRel
-                            InFlight<packet::Publish> flight(publish);
+                            auto& flight = receiving.insert(id, InFlight<packet::Publish>(std::move(publish)));
                             flight.set_wait_packet(PacketType::PUBREL);
                             flight.start_timer();
-                            receiving.insert(std::make_pair(publish.get_packet_identifier(), flight));
                         }
 
                         // Always send a PubRec message as an ack.
-                        packet::PubRec rec(publish.get_packet_identifier());
+                        packet::PubRec rec(id);
                         mqtt.send_packet(rec);
                     }
                 }
@@ -180,14 +178,15 @@ namespace smooth
                     packet::PubComp pub_comp(pub_rel.get_packet_identifier());
                     mqtt.send_packet(pub_comp);
 
-                    auto found = receiving.find(pub_rel.get_packet_identifier());
-                    if (found != receiving.end())
+                    auto id = pub_rel.get_packet_identifier();
+                    auto found = receiving.find(id);
+                    if (found != nullptr)
                     {
                         // We may now forward the data to the application.
-                        forward_to_application((*found).second.get_packet(), mqtt);
+                        forward_to_application(found->get_packet(), mqtt);
                         // We're done with the packet. Any new packet with the same ID will
                         // be treated as a new publication.
-                        receiving.erase(found);
+                        receiving.erase(id);
                     }
                 }
 
@@ -209,22 +208,71 @@ namespace smooth
                             }
 
 
-                            unsubscribing.erase(unsubscribing.begin());
+                            unsubscribing.pop_front();
                         }
                     }
                 }
 
-                void Subscription::forward_to_application(const packet::Publish& publish, IMqttClient& mqtt)
+                void Subscription::forward_to_application(packet::Publish& publish, IMqttClient& mqtt)
                 {
-                    Log::debug(mqtt_log_tag, Format("Reception of QoS {1} complete", Int32(publish.get_qos())));
-                    // Grab the payload
-                    std::vector<uint8_t> payload;
-                    // Move data into our local vector.
-                    std::copy(std::make_move_iterator(publish.get_payload_cbegin()),
-                              std::make_move_iterator(publish.get_payload_cend()),
-                              std::back_inserter(payload));
-                    // Enqueue data to application. Can't avoid a copy here.
-                    mqtt.get_application_queue().push(std::make_pair(publish.get_topic(), payload));
+                    if (mqtt_log_level >= 4)
+                    {
+                        Log::debug(mqtt_log_tag, Format("Reception of QoS {1} complete", Int32(publish.get_qos())));
+                    }
+
+                    // Take over the packet, and with it the payload, from the receive buffer.
+                    MQTTMessage message(std::move(publish));
+
+                    matching_queues.clear();
+                    router.match(message.get_topic_data(), message.get_topic_length(), matching_queues);
+
+                    if (matching_queues.empty())
+                    {
+                        // Not subscribed (anymore), or subscribed by an earlier session.
+                        mqtt.get_application_queue().push(message.release_data());
+                    }
+                    else
+                    {
+                        // The last queue gets the message itself and the others copies, so that nothing is copied
+                        // when there is a single subscriber. Queues taking MQTTData go first, since their data is
+                        // taken from the message.
+                        auto last_message_queue = std::find_if(matching_queues.rbegin(), matching_queues.rend(),
+                                                               [](const TopicRouter::Destination& d)
+                                                               {
+                                                                   return d.message_queue != nullptr;
+                                                               });
+
+                        for (auto& destination : matching_queues)
+                        {
+                            if (destination.data_queue != nullptr)
+                            {
+                                if (last_message_queue == matching_queues.rend()
+                                    && &destination == &matching_queues.back())
+                                {
+                                    destination.data_queue->push(message.release_data());
+                                }
+                                else
+                                {
+                                    destination.data_queue->push(message.to_data());
+                                }
+                            }
+                        }
+
+                        for (auto& destination : matching_queues)
+                        {
+                            if (destination.message_queue != nullptr)
+                            {
+                                if (&destination == &*last_message_queue)
+                                {
+                                    destination.message_queue->push(std::move(message));
+                                }
+                                else
+                                {
+                                    destination.message_queue->push(message);
+                                }
+                            }
+                        }
+                    }
                 }
             }
         }
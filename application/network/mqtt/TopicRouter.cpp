@@ -0,0 +1,137 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <smooth/application/network/mqtt/TopicRouter.h>
+#include <smooth/core/util/make_unique.h>
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                // Levels are walked by position in the topic; a position past the end means there are no more
+                // levels. Empty levels, e.g. in "a//b" or "/a", are levels like any other.
+                static size_t level_end(const char* topic, size_t length, size_t pos)
+                {
+                    auto end = static_cast<const char*>(memchr(topic + pos, '/', length - pos));
+                    return end == nullptr ? length : static_cast<size_t>(end - topic);
+                }
+
+                void TopicRouter::add(const std::string& filter, const Destination& queue)
+                {
+                    auto* node = &root;
+
+                    for (size_t pos = 0; pos <= filter.size();)
+                    {
+                        auto end = level_end(filter.data(), filter.size(), pos);
+                        auto& child = node->children[filter.substr(pos, end - pos)];
+
+                        if (!child)
+                        {
+                            child = core::util::make_unique<Node>();
+                        }
+
+                        node = child.get();
+                        pos = end + 1;
+                    }
+
+                    if (std::find(node->queues.begin(), node->queues.end(), queue) == node->queues.end())
+                    {
+                        node->queues.push_back(queue);
+                    }
+                }
+
+                void TopicRouter::remove(const std::string& filter)
+                {
+                    remove(root, filter, 0);
+                }
+
+                bool TopicRouter::remove(Node& node, const std::string& filter, size_t pos)
+                {
+                    if (pos > filter.size())
+                    {
+                        node.queues.clear();
+                    }
+                    else
+                    {
+                        auto end = level_end(filter.data(), filter.size(), pos);
+                        auto child = node.children.find(filter.substr(pos, end - pos));
+
+                        if (child != node.children.end() && remove(*child->second, filter, end + 1))
+                        {
+                            node.children.erase(child);
+                        }
+                    }
+
+                    return node.queues.empty() && node.children.empty();
+                }
+
+                void TopicRouter::match(const char* topic, size_t length, std::vector<Destination>& matches) const
+                {
+                    match(root, topic, length, 0, matches);
+                }
+
+                void TopicRouter::match(const Node& node, const char* topic, size_t length, size_t pos,
+                                        std::vector<Destination>& matches) const
+                {
+                    if (pos > length)
+                    {
+                        add_matches(node, matches);
+
+                        // "a/#" also matches "a", i.e. the parent level.
+                        auto multi = node.children.find("#");
+                        if (multi != node.children.end())
+                        {
+                            add_matches(*multi->second, matches);
+                        }
+                    }
+                    else
+                    {
+                        auto end = level_end(topic, length, pos);
+
+                        // Topics starting with '$' are reserved for the server and not matched by
+                        // wildcards in the first level [MQTT-4.7.2-1].
+                        if (pos > 0 || length == 0 || topic[0] != '$')
+                        {
+                            auto multi = node.children.find("#");
+                            if (multi != node.children.end())
+                            {
+                                add_matches(*multi->second, matches);
+                            }
+
+                            auto single = node.children.find("+");
+                            if (single != node.children.end())
+                            {
+                                match(*single->second, topic, length, end + 1, matches);
+                            }
+                        }
+
+                        // Short levels fit inside the string itself, so this normally doesn't allocate.
+                        auto exact = node.children.find(std::string(topic + pos, end - pos));
+                        if (exact != node.children.end())
+                        {
+                            match(*exact->second, topic, length, end + 1, matches);
+                        }
+                    }
+                }
+
+                void TopicRouter::add_matches(const Node& node, std::vector<Destination>& matches)
+                {
+                    for (auto& queue : node.queues)
+                    {
+                        if (std::find(matches.begin(), matches.end(), queue) == matches.end())
+                        {
+                            matches.push_back(queue);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
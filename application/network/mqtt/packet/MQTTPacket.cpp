@@ -6,6 +6,7 @@
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <cstring>
 #include <smooth/application/network/mqtt/packet/MQTTPacket.h>
 #include <smooth/application/network/mqtt/Logging.h>
 #include <smooth/core/logging/log.h>
@@ -68,31 +69,20 @@ namespace smooth
                         else if (state == REMAINING_LENGTH)
                         {
                             // Second and optionally 3rd to 5th bytes
-                            core::util::ByteSet b(packet[bytes_received - 1]);
-                            if (b.test(7))
+                            core::util::ByteSet b(fixed_header[bytes_received - 1]);
+                            if (b.test(7) && bytes_received == static_cast<int>(fixed_header.size()))
+                            {
+                                Log::error(mqtt_log_tag, Format("Invalid remaining length"));
+                                error = true;
+                            }
+                            else if (b.test(7))
                             {
                                 // Not yet received all length bytes
                                 remaining_bytes_to_read = 1;
                             }
                             else
                             {
-                                received_header_length = bytes_received;
-
-                                // We can now calculate the length of the remaining data
-                                remaining_bytes_to_read = calculate_remaining_length_and_variable_header_offset();
-
-                                if (remaining_bytes_to_read > CONFIG_SMOOTH_MAX_MQTT_MESSAGE_SIZE)
-                                {
-                                    Log::verbose(mqtt_log_tag, Format("Too big packet detected: {1} > {2}",
-                                                                      Int32(remaining_bytes_to_read),
-                                                                      Int32(CONFIG_SMOOTH_MAX_MQTT_MESSAGE_SIZE)));
-                                    state = DATA;
-                                    too_big = true;
-                                }
-                                else if (remaining_bytes_to_read > 0)
-                                {
-                                    state = DATA;
-                                }
+                                header_received();
                             }
                         }
                         else if (state == DATA)
@@ -105,7 +95,94 @@ namespace smooth
                         }
                     }
 
-                    int MQTTPacket::calculate_remaining_length_and_variable_header_offset() const
+                    void MQTTPacket::header_received()
+                    {
+                        received_header_length = bytes_received;
+
+                        // Allocate for the whole packet at once, then move the header into it.
+                        int remaining = 0;
+                        for (int i = bytes_received - 1; i > 0; --i)
+                        {
+                            remaining = remaining * 128 + (fixed_header[i] & 0x7F);
+                        }
+
+                        packet.reserve(static_cast<size_t>(
+                                               received_header_length
+                                               + std::min(remaining, CONFIG_SMOOTH_MAX_MQTT_MESSAGE_SIZE)));
+                        packet.assign(fixed_header.begin(), fixed_header.begin() + received_header_length);
+
+                        // We can now calculate the length of the remaining data
+                        remaining_bytes_to_read = calculate_remaining_length_and_variable_header_offset();
+
+                        if (remaining_bytes_to_read > CONFIG_SMOOTH_MAX_MQTT_MESSAGE_SIZE)
+                        {
+                            Log::verbose(mqtt_log_tag, Format("Too big packet detected: {1} > {2}",
+                                                              Int32(remaining_bytes_to_read),
+                                                              Int32(CONFIG_SMOOTH_MAX_MQTT_MESSAGE_SIZE)));
+                            state = DATA;
+                            too_big = true;
+                        }
+                        else if (remaining_bytes_to_read > 0)
+                        {
+                            state = DATA;
+                        }
+                    }
+
+                    int MQTTPacket::consume(const uint8_t* data, int length)
+                    {
+                        int consumed = 0;
+
+                        if (state == START && length > 0)
+                        {
+                            // Look for the end of the remaining length in the data itself, so that a header
+                            // received in one piece is parsed where it lies.
+                            int end = 1;
+                            bool found = false;
+
+                            while (!found && end < length && end < static_cast<int>(fixed_header.size()))
+                            {
+                                found = (data[end] & 0x80) == 0;
+                                ++end;
+                            }
+
+                            if (found)
+                            {
+                                memcpy(fixed_header.data(), data, static_cast<size_t>(end));
+                                bytes_received = end;
+                                consumed = end;
+                                state = REMAINING_LENGTH;
+                                header_received();
+                            }
+                        }
+
+                        // A header split between two reads, or a malformed one, is taken a byte at a time.
+                        while (consumed < length && state != DATA && !is_complete() && !error)
+                        {
+                            fixed_header[static_cast<size_t>(bytes_received)] = data[consumed];
+                            ++consumed;
+                            data_received(1);
+                        }
+
+                        if (state == DATA && consumed < length && !is_complete())
+                        {
+                            auto amount = std::min(remaining_bytes_to_read, length - consumed);
+
+                            // Room for the whole packet was reserved when the header was parsed. The data of a
+                            // packet that is too big is skipped, as it is never used.
+                            if (!is_too_big())
+                            {
+                                packet.insert(packet.end(), data + consumed, data + consumed + amount);
+                            }
+
+                            bytes_received += amount;
+                            remaining_bytes_to_read -= amount;
+                            consumed += amount;
+                        }
+
+                        return consumed;
+                    }
+
+                    int MQTTPacket::calculate_remaining_length_and_variable_header_offset()
                     {
                         int res = 0;
 
@@ -164,10 +241,7 @@ namespace smooth
                         auto length = static_cast<uint16_t>(str.length());
                         append_msb_lsb(length, target);
 
-                        for (uint16_t i = 0; i < length; ++i)
-                        {
-                            target.push_back(static_cast<uint8_t&&>(str[i]));
-                        }
+                        target.insert(target.end(), str.begin(), str.begin() + length);
                     }
 
                     void MQTTPacket::append_msb_lsb(uint16_t value, std::vector<uint8_t>& target)
@@ -178,20 +252,14 @@ namespace smooth
 
                     void MQTTPacket::append_data(const uint8_t* data, int length, std::vector<uint8_t>& target)
                     {
-                        for (int i = 0; i < length; ++i)
-                        {
-                            target.push_back(data[i]);
-                        }
+                        target.insert(target.end(), data, data + length);
                     }
 
-                    void MQTTPacket::apply_constructed_data(const std::vector<uint8_t>& variable)
+                    void MQTTPacket::apply_constructed_data(const std::vector<uint8_t>& variable,
+                                                            int external_payload_length)
                     {
-                        encode_remaining_length(static_cast<int>(variable.size()));
-                        // Using move_iterator we reduce the memory foot print by actually moving
-                        // instead of copying the data.
-                        std::copy(std::make_move_iterator(variable.begin()),
-                                  std::make_move_iterator(variable.end()),
-                                  std::back_inserter(packet));
+                        encode_remaining_length(static_cast<int>(variable.size()) + external_payload_length);
+                        packet.insert(packet.end(), variable.begin(), variable.end());
                         calculate_remaining_length_and_variable_header_offset();
                     }
 
@@ -226,13 +294,8 @@ namespace smooth
                         length |= *offset;
                         ++offset;
 
-                        std::stringstream ss;
-                        for (int i = 0; offset != packet.cend() && i < length; ++offset, ++i)
-                        {
-                            ss << *offset;
-                        }
-
-                        return ss.str();
+                        auto available = std::distance(offset, packet.cend());
+                        return std::string(offset, offset + std::min(static_cast<long>(length), available));
                     }
 
                     QoS MQTTPacket::get_qos() const
@@ -246,8 +309,6 @@ namespace smooth
 
                     long MQTTPacket::get_payload_length() const
                     {
-                        calculate_remaining_length_and_variable_header_offset();
-
                         long payload_length = std::distance(
                                 get_variable_header_start() + get_variable_header_length(),
                                 packet.cend());
@@ -257,8 +318,12 @@ namespace smooth
 
                     void MQTTPacket::dump(const char* header) const
                     {
+                        if (mqtt_log_level < 5)
+                        {
+                            return;
+                        }
+
                         std::stringstream ss;
-                        calculate_remaining_length_and_variable_header_offset();
 
                         ss << "[" << get_mqtt_type_as_string() << "] "
                            << "Raw(" << packet.size() << ") "
@@ -315,7 +380,6 @@ namespace smooth
                         else
                         {
                             // Ensure that data lengths add up.
-                            calculate_remaining_length_and_variable_header_offset();
                             long left_over = packet.size()
                                              // Fixed header
                                              - std::distance(packet.cbegin(), get_variable_header_start())
@@ -339,25 +403,34 @@ namespace smooth
                     {
                         uint8_t* pos;
 
-                        // Make room for remaining data. In the case of a too big package, allocate
-                        // maximum allowed to enable quick read of the data.
-                        auto required_size =
-                                is_too_big() ?
-                                received_header_length + CONFIG_SMOOTH_MAX_MQTT_MESSAGE_SIZE :
-                                bytes_received + get_wanted_amount();
-
-                        // Make sure there is room to do direct memory writes by reserving space.
-                        packet.resize(static_cast<unsigned long>(required_size), 0);
-
-                        if (is_too_big())
+                        if (state != DATA)
                         {
-                            // Always write to the byte after the header
-                            pos = &packet[received_header_length];
+                            // The fixed header is read a byte at a time; keep it aside until its size, and
+                            // thereby the size of the packet, is known.
+                            pos = &fixed_header[bytes_received];
                         }
                         else
                         {
-                            // Append to the already received data.
-                            pos = &packet[bytes_received];
+                            // Make room for remaining data. In the case of a too big package, allocate
+                            // maximum allowed to enable quick read of the data.
+                            auto required_size =
+                                    is_too_big() ?
+                                    received_header_length + CONFIG_SMOOTH_MAX_MQTT_MESSAGE_SIZE :
+                                    bytes_received + get_wanted_amount();
+
+                            // Make sure there is room to do direct memory writes by reserving space.
+                            packet.resize(static_cast<unsigned long>(required_size), 0);
+
+                            if (is_too_big())
+                            {
+                                // Always write to the byte after the header
+                                pos = &packet[received_header_length];
+                            }
+                            else
+                            {
+                                // Append to the already received data.
+                                pos = &packet[bytes_received];
+                            }
                         }
 
                         return pos;
@@ -375,6 +448,21 @@ namespace smooth
                         return error;
                     }
 
+                    bool MQTTPacket::prepare_for_reuse()
+                    {
+                        // clear() keeps the capacity of the vector.
+                        packet.clear();
+                        variable_header_start_ix = 0;
+                        state = START;
+                        bytes_received = 0;
+                        remaining_bytes_to_read = 1;
+                        received_header_length = 0;
+                        error = false;
+                        too_big = false;
+                        external_payload.reset();
+                        return true;
+                    }
+
 
                     int MQTTPacket::get_send_length()
                     {
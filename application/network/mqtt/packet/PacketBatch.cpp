@@ -0,0 +1,69 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <algorithm>
+#include <smooth/application/network/mqtt/packet/PacketBatch.h>
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                namespace packet
+                {
+                    bool PacketBatch::append(MQTTPacket& item, size_t max_size)
+                    {
+                        auto data = item.get_data();
+                        auto length = static_cast<size_t>(item.get_send_length());
+                        auto payload = item.get_external_payload();
+                        bool copy_payload = payload && !payload->is_file()
+                                            && length + payload->get_length() <= max_size;
+                        auto total = length + (copy_payload ? payload->get_length() : 0);
+
+                        bool res = !external_payload && (count == 0 || packet.size() + total <= max_size);
+
+                        if (res)
+                        {
+                            if (count == 0)
+                            {
+                                // Only allocates until the memory the batch is given back by the transmit buffer
+                                // has grown large enough.
+                                packet.reserve(std::max(max_size, total));
+                                age.start();
+                            }
+
+                            packet.insert(packet.end(), data, data + length);
+
+                            if (copy_payload)
+                            {
+                                packet.insert(packet.end(), payload->get_data(),
+                                              payload->get_data() + payload->get_length());
+                            }
+                            else if (payload)
+                            {
+                                // Sent straight after the batch, so nothing more can be added.
+                                external_payload = payload;
+                            }
+
+                            ++count;
+                        }
+
+                        return res;
+                    }
+
+                    void PacketBatch::clear()
+                    {
+                        packet.clear();
+                        external_payload.reset();
+                        age.stop_and_zero();
+                        count = 0;
+                    }
+                }
+            }
+        }
+    }
+}
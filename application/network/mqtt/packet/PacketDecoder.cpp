@@ -12,7 +12,6 @@
 #include <smooth/application/network/mqtt/packet/SubAck.h>
 #include <smooth/application/network/mqtt/packet/UnsubAck.h>
 #include <smooth/application/network/mqtt/packet/PingResp.h>
-#include <smooth/core/util/make_unique.h>
 #include <smooth/application/network/mqtt/Logging.h>
 #include <smooth/core/logging/log.h>
 #include <string>
@@ -29,11 +28,29 @@ namespace smooth
             {
                 namespace packet
                 {
+                    template<typename T>
+                    bool PacketDecoder::dispatch(MQTTPacket& packet, IPacketReceiver& receiver)
+                    {
+                        // The typed packet lives on the stack and borrows the buffer of the received packet.
+                        T typed(std::move(packet));
+                        bool res = typed.validate_packet();
+
+                        if (res)
+                        {
+                            typed.dump("Incoming");
+                            typed.visit(receiver);
+                        }
+
+                        // Hand the buffer back so that its capacity is reused for the next packet.
+                        packet = std::move(static_cast<MQTTPacket&>(typed));
+
+                        return res;
+                    }
+
                     // Decode messages from server to client
-                    std::unique_ptr<MQTTPacket> PacketDecoder::decode_packet(const MQTTPacket& packet)
+                    bool PacketDecoder::decode_packet(MQTTPacket& packet, IPacketReceiver& receiver)
                     {
-                        std::unique_ptr<MQTTPacket> res;
-                        using namespace core::util;
+                        bool res = false;
 
                         if (packet.is_too_big())
                         {
@@ -43,53 +60,37 @@ namespace smooth
                         }
                         else
                         {
-                            if (packet.get_mqtt_type() == CONNACK)
-                            {
-                                res = make_unique<ConnAck>(packet);
-                            }
-                            else if (packet.get_mqtt_type() == PUBLISH)
-                            {
-                                res = make_unique<Publish>(packet);
-                            }
-                            else if (packet.get_mqtt_type() == PUBACK)
-                            {
-                                res = make_unique<PubAck>(packet);
-                            }
-                            else if (packet.get_mqtt_type() == PUBREC)
-                            {
-                                res = make_unique<PubRec>(packet);
-                            }
-                            else if (packet.get_mqtt_type() == PUBREL)
-                            {
-                                res = make_unique<PubRel>(packet);
-                            }
-                            else if (packet.get_mqtt_type() == PUBCOMP)
-                            {
-                                res = make_unique<PubComp>(packet);
-                            }
-                            else if (packet.get_mqtt_type() == SUBACK)
-                            {
-                                res = make_unique<SubAck>(packet);
-                            }
-                            else if (packet.get_mqtt_type() == UNSUBACK)
-                            {
-                                res = make_unique<UnsubAck>(packet);
-                            }
-                            else if (packet.get_mqtt_type() == PINGRESP)
-                            {
-                                res = make_unique<PingResp>(packet);
-                            }
-                        }
-
-                        if (res)
-                        {
-                            if (res->validate_packet())
-                            {
-                                res->dump("Incoming");
-                            }
-                            else
+                            switch (packet.get_mqtt_type())
                             {
-                                res.reset();
+                                case CONNACK:
+                                    res = dispatch<ConnAck>(packet, receiver);
+                                    break;
+                                case PUBLISH:
+                                    res = dispatch<Publish>(packet, receiver);
+                                    break;
+                                case PUBACK:
+                                    res = dispatch<PubAck>(packet, receiver);
+                                    break;
+                                case PUBREC:
+                                    res = dispatch<PubRec>(packet, receiver);
+                                    break;
+                                case PUBREL:
+                                    res = dispatch<PubRel>(packet, receiver);
+                                    break;
+                                case PUBCOMP:
+                                    res = dispatch<PubComp>(packet, receiver);
+                                    break;
+                                case SUBACK:
+                                    res = dispatch<SubAck>(packet, receiver);
+                                    break;
+                                case UNSUBACK:
+                                    res = dispatch<UnsubAck>(packet, receiver);
+                                    break;
+                                case PINGRESP:
+                                    res = dispatch<PingResp>(packet, receiver);
+                                    break;
+                                default:
+                                    break;
                             }
                         }
 
@@ -21,7 +21,6 @@ namespace smooth
 
                     uint16_t PubRec::get_packet_identifier() const
                     {
-                        calculate_remaining_length_and_variable_header_offset();
                         return read_packet_identifier(get_variable_header_start());
                     }
 
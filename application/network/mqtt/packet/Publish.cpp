@@ -16,41 +16,95 @@ namespace smooth
                 {
                     Publish::Publish(const std::string& topic, const uint8_t* data, int length, QoS qos, bool retain)
                     {
+                        encode(topic, qos, retain, length, 0);
+                        packet.insert(packet.end(), data, data + length);
+                        calculate_remaining_length_and_variable_header_offset();
+                    }
+
+                    Publish::Publish(const std::string& topic, std::vector<uint8_t>&& payload, QoS qos, bool retain)
+                            : Publish(topic,
+                                      std::make_shared<core::network::ExternalPayload>(
+                                              std::make_shared<const std::vector<uint8_t>>(std::move(payload))),
+                                      qos,
+                                      retain)
+                    {
+                    }
+
+                    Publish::Publish(const std::string& topic,
+                                     std::shared_ptr<const core::network::ExternalPayload> payload,
+                                     QoS qos, bool retain)
+                    {
+                        auto payload_length = static_cast<int>(payload->get_length());
+                        external_payload = std::move(payload);
+                        encode(topic, qos, retain, 0, payload_length);
+                        calculate_remaining_length_and_variable_header_offset();
+                    }
+
+                    Publish::Publish(std::vector<uint8_t>&& encoded)
+                    {
+                        packet = std::move(encoded);
+                        calculate_remaining_length_and_variable_header_offset();
+                    }
+
+                    void Publish::encode(const std::string& topic, QoS qos, bool retain, int payload_length,
+                                         int external_payload_length)
+                    {
+                        // Packet identifier (can't use has_packet_identifier() since we're not fully constructed yet
+                        bool with_id = qos > AT_MOST_ONCE;
+                        auto topic_length = static_cast<uint16_t>(topic.length());
+                        int remaining_length = 2 + topic_length + (with_id ? 2 : 0) + payload_length;
+
+                        // Fixed header is at most five bytes; allocate once for the whole packet.
+                        packet.reserve(static_cast<size_t>(5 + remaining_length));
+
                         core::util::ByteSet flags(0);
                         flags.set(0, retain);
                         flags.set(1, qos & 0x1);
                         flags.set(2, qos & 0x2);
                         set_header(PacketType::PUBLISH, flags);
+                        encode_remaining_length(remaining_length + external_payload_length);
 
-                        std::vector<uint8_t> variable_header{};
                         // Topic
-                        append_string(topic, variable_header);
+                        append_msb_lsb(topic_length, packet);
+                        packet.insert(packet.end(), topic.begin(), topic.begin() + topic_length);
 
-                        // Packet identifier (can't use has_packet_identifier() since we're not fully constructed yet
-                        if (qos > AT_MOST_ONCE)
+                        if (with_id)
                         {
-                            append_msb_lsb(PacketIdentifierFactory::get_id(), variable_header);
+                            append_msb_lsb(PacketIdentifierFactory::get_id(), packet);
                         }
-
-                        // Payload
-                        append_data(data, length, variable_header);
-
-                        apply_constructed_data(variable_header);
                     }
 
                     std::string Publish::get_topic() const
                     {
-                        calculate_remaining_length_and_variable_header_offset();
-                        return get_string(get_variable_header_start());
+                        return std::string(get_topic_data(), get_topic_length());
+                    }
+
+                    std::vector<uint8_t> Publish::take_payload()
+                    {
+                        auto header_length = std::distance(packet.cbegin(), get_payload_cbegin());
+                        std::vector<uint8_t> payload(std::move(packet));
+                        payload.erase(payload.begin(), payload.begin() + header_length);
+                        packet.clear();
+                        return payload;
                     }
 
                     int Publish::get_variable_header_length() const
                     {
-                        return get_topic().length()
-                               // Add two for length bytes for string
-                               + 2
-                               // Add two more for optional packet identifier
-                               + (has_packet_identifier() ? 2 : 0);
+                        auto start = get_variable_header_start();
+                        auto available = std::distance(start, packet.cend());
+                        int length = 0;
+
+                        if (available >= 2)
+                        {
+                            length = read_msb_lsb(start)
+                                     // Add two for length bytes for string
+                                     + 2
+                                     // Add two more for optional packet identifier
+                                     + (has_packet_identifier() ? 2 : 0);
+                        }
+
+                        // A malformed packet may claim more than it holds.
+                        return static_cast<int>(std::min(static_cast<long>(length), available));
                     }
 
                     void Publish::visit(IPacketReceiver& receiver)
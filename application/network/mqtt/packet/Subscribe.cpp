@@ -22,7 +22,6 @@ namespace smooth
 
                     void Subscribe::get_topics(std::vector<std::pair<std::string, QoS>>& topics) const
                     {
-                        calculate_remaining_length_and_variable_header_offset();
                         auto it = get_variable_header_start() + get_variable_header_length();
                         while (it != packet.end())
                         {
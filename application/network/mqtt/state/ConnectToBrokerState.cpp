@@ -31,6 +31,7 @@ namespace smooth
                     {
                         if (conn_ack.connection_was_accepted())
                         {
+                            fsm.get_mqtt().reset_reconnect_backoff();
                             fsm.set_state(new(fsm) RunState(fsm, is_using_clean_session));
                         }
                         else
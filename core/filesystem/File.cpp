@@ -1,5 +1,8 @@
 #include <fstream>
 #include <utility>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
 #include <smooth/core/filesystem/File.h>
 #include <smooth/core/logging/log.h>
 
@@ -65,6 +68,63 @@ namespace smooth
                 return res;
             }
 
+            bool File::append(const uint8_t* data, size_t length) const
+            {
+                // A stream can't be synced to the device, so use a file descriptor.
+                auto fd = open(name.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+                bool res = fd >= 0;
+
+                for (size_t written = 0; res && written < length;)
+                {
+                    auto count = ::write(fd, data + written, length - written);
+                    res = count > 0;
+                    written += res ? static_cast<size_t>(count) : 0;
+                }
+
+                if (fd >= 0)
+                {
+                    res = fsync(fd) == 0 && res;
+                    res = close(fd) == 0 && res;
+                }
+
+                if (!res)
+                {
+                    Log::error("File", Format("Error appending to file: {1}", Str(name)));
+                }
+
+                return res;
+            }
+
+            bool File::remove() const
+            {
+                return std::remove(name.c_str()) == 0;
+            }
+
+            bool File::sync_directory(const std::string& directory)
+            {
+#ifdef ESP_PLATFORM
+                // The file systems of ESP-IDF can't open a directory; they update the directory entry of a file
+                // when the file itself is synced.
+                (void)directory;
+                bool res = true;
+#else
+                auto fd = open(directory.c_str(), O_RDONLY);
+                bool res = fd >= 0;
+
+                if (fd >= 0)
+                {
+                    res = fsync(fd) == 0 && res;
+                    res = close(fd) == 0 && res;
+                }
+
+                if (!res)
+                {
+                    Log::error("File", Format("Error syncing directory: {1}", Str(directory)));
+                }
+#endif
+                return res;
+            }
+
         }
     }
 }
\ No newline at end of file
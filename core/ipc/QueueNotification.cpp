@@ -22,7 +22,7 @@ namespace smooth
                 // data item to their internal queue. As such, the queue can only be as large as
                 // the sum of all queues within the same Task.
                 std::unique_lock<std::mutex> lock(guard);
-                queues.push(queue);
+                push(queue);
                 cond.notify_one();
             }
 
@@ -32,7 +32,7 @@ namespace smooth
 
                 std::unique_lock<std::mutex> lock(guard);
 
-                if (queues.empty())
+                if (count == 0)
                 {
                     // Wait until data is available, or timeout. This will atomically release the lock.
                     auto wait_result = cond.wait_until(lock,
@@ -40,27 +40,52 @@ namespace smooth
                                                        [this]()
                                                        {
                                                            // Stop waiting when there is data
-                                                           return !queues.empty();
+                                                           return count > 0;
                                                        });
 
                     // At this point we will have the lock again.
                     if (wait_result)
                     {
-                        if (!queues.empty())
+                        if (count > 0)
                         {
-                            res = queues.front();
-                            queues.pop();
+                            res = pop();
                         }
                     }
                 }
                 else
                 {
-                    res = queues.front();
-                    queues.pop();
+                    res = pop();
                 }
 
                 return res;
             }
+
+            void QueueNotification::push(ITaskEventQueue* queue)
+            {
+                if (count == queues.size())
+                {
+                    std::vector<ITaskEventQueue*> larger(std::max(queues.size() * 2, static_cast<size_t>(8)));
+
+                    for (size_t i = 0; i < count; ++i)
+                    {
+                        larger[i] = queues[(head + i) % queues.size()];
+                    }
+
+                    queues.swap(larger);
+                    head = 0;
+                }
+
+                queues[(head + count) % queues.size()] = queue;
+                ++count;
+            }
+
+            ITaskEventQueue* QueueNotification::pop()
+            {
+                auto res = queues[head];
+                head = (head + 1) % queues.size();
+                --count;
+                return res;
+            }
         }
     }
 }
@@ -0,0 +1,59 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <smooth/core/network/BackoffPolicy.h>
+#include <algorithm>
+
+#ifdef ESP_PLATFORM
+#include <esp_system.h>
+#endif
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            static uint32_t random_seed()
+            {
+                // Each device must get its own sequence, or the jitter doesn't spread them apart.
+#ifdef ESP_PLATFORM
+                return esp_random();
+#else
+                return std::random_device()();
+#endif
+            }
+
+            BackoffPolicy::BackoffPolicy(std::chrono::milliseconds initial_delay,
+                                         std::chrono::milliseconds max_delay,
+                                         double multiplier,
+                                         double jitter)
+                    : initial_delay(initial_delay),
+                      max_delay(std::max(initial_delay, max_delay)),
+                      multiplier(std::max(1.0, multiplier)),
+                      jitter(std::min(1.0, std::max(0.0, jitter))),
+                      current(initial_delay),
+                      random(random_seed())
+            {
+            }
+
+            std::chrono::milliseconds BackoffPolicy::next_delay()
+            {
+                auto delay = current;
+
+                auto next = static_cast<double>(current.count()) * multiplier;
+                current = std::chrono::milliseconds(
+                        static_cast<std::chrono::milliseconds::rep>(
+                                std::min(next, static_cast<double>(max_delay.count()))));
+                ++attempts;
+
+                // Randomize the delay downwards, i.e. the result is never above the nominal delay.
+                std::uniform_real_distribution<double> distribution(0.0, jitter);
+                auto reduction = static_cast<double>(delay.count()) * distribution(random);
+
+                return delay - std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(reduction));
+            }
+        }
+    }
+}
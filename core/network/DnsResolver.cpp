@@ -0,0 +1,241 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <smooth/core/network/DnsResolver.h>
+#include <smooth/core/network/IPv4.h>
+#include <smooth/core/network/IPv6.h>
+#include <smooth/core/task_priorities.h>
+#include <smooth/core/logging/log.h>
+#include <algorithm>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+using namespace smooth::core::logging;
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            DnsResolver& DnsResolver::instance()
+            {
+                static DnsResolver instance;
+
+                // Start task on first use
+                static bool initialized = false;
+                if (!initialized)
+                {
+                    initialized = true;
+                    instance.start();
+                }
+                return instance;
+            }
+
+            DnsResolver::DnsResolver()
+                    : Task(tag, 4096, DNS_RESOLVER_PRIO, std::chrono::milliseconds(1000)),
+                      requests("DnsRequests", 10, *this, *this)
+            {
+            }
+
+            void DnsResolver::resolve(const std::string& host_name, uint16_t port,
+                                      std::function<void(const AddressList&)> callback)
+            {
+                AddressList addresses;
+
+                if (get_cached(host_name, port, false, addresses))
+                {
+                    callback(addresses);
+                }
+                else if (!requests.push(ResolveRequest(host_name, port, callback)))
+                {
+                    Log::error(tag, Format("Too many pending requests, can't resolve {1}", Str(host_name)));
+                    callback(addresses);
+                }
+            }
+
+            void DnsResolver::add_host(const std::string& host_name, const std::vector<std::string>& addresses)
+            {
+                std::vector<std::pair<int, std::string>> v4;
+                std::vector<std::pair<int, std::string>> v6;
+                bool v6_first = false;
+                in6_addr parsed{};
+
+                for (auto& address : addresses)
+                {
+                    if (inet_pton(AF_INET, address.c_str(), &parsed) == 1)
+                    {
+                        v4.emplace_back(AF_INET, address);
+                    }
+                    else if (inet_pton(AF_INET6, address.c_str(), &parsed) == 1)
+                    {
+                        v6_first |= v4.empty() && v6.empty();
+                        v6.emplace_back(AF_INET6, address);
+                    }
+                    else
+                    {
+                        Log::error(tag, Format("Ignoring invalid address {1} of {2}", Str(address), Str(host_name)));
+                    }
+                }
+
+                CacheEntry entry;
+                interleave(v4, v6, v6_first, entry);
+                entry.expires = std::chrono::steady_clock::time_point::max();
+
+                std::lock_guard<std::mutex> lock(cache_guard);
+                hosts[host_name] = entry;
+            }
+
+            void DnsResolver::clear_cache()
+            {
+                std::lock_guard<std::mutex> lock(cache_guard);
+                cache.clear();
+            }
+
+            void DnsResolver::event(const ResolveRequest& request)
+            {
+                AddressList addresses;
+
+                // Requests for the same name may have been queued before the first one was resolved.
+                if (!get_cached(request.host_name, request.port, false, addresses))
+                {
+                    CacheEntry entry;
+
+                    if (lookup(request.host_name, entry))
+                    {
+                        addresses = create_addresses(entry, request.port);
+                        std::lock_guard<std::mutex> lock(cache_guard);
+                        cache[request.host_name] = entry;
+                    }
+                    else if (get_cached(request.host_name, request.port, true, addresses))
+                    {
+                        Log::warning(tag, Format("Could not resolve {1}, using expired addresses",
+                                                 Str(request.host_name)));
+                    }
+                    else
+                    {
+                        Log::error(tag, Format("Could not resolve {1}", Str(request.host_name)));
+                    }
+                }
+
+                request.callback(addresses);
+            }
+
+            bool DnsResolver::get_cached(const std::string& host_name, uint16_t port, bool allow_expired,
+                                         AddressList& addresses)
+            {
+                std::lock_guard<std::mutex> lock(cache_guard);
+
+                auto host = hosts.find(host_name);
+                auto cached = cache.find(host_name);
+                auto entry = host != hosts.end() ? &host->second : cached != cache.end() ? &cached->second : nullptr;
+                bool res = entry != nullptr
+                           && (allow_expired || entry->expires > std::chrono::steady_clock::now());
+
+                if (res)
+                {
+                    addresses = create_addresses(*entry, port);
+                }
+
+                return res;
+            }
+
+            bool DnsResolver::lookup(const std::string& host_name, CacheEntry& entry)
+            {
+                addrinfo hints{};
+                hints.ai_family = AF_UNSPEC;
+                hints.ai_socktype = SOCK_STREAM;
+
+                addrinfo* result = nullptr;
+                int res = getaddrinfo(host_name.c_str(), nullptr, &hints, &result);
+
+                if (res == 0)
+                {
+                    std::vector<std::pair<int, std::string>> v4;
+                    std::vector<std::pair<int, std::string>> v6;
+                    bool v6_first = false;
+                    char buff[INET6_ADDRSTRLEN];
+
+                    for (auto* curr = result; curr != nullptr; curr = curr->ai_next)
+                    {
+                        const char* ip = nullptr;
+
+                        if (curr->ai_family == AF_INET)
+                        {
+                            auto addr = reinterpret_cast<sockaddr_in*>(curr->ai_addr);
+                            ip = inet_ntop(AF_INET, &addr->sin_addr, buff, sizeof(buff));
+                        }
+                        else if (curr->ai_family == AF_INET6)
+                        {
+                            auto addr = reinterpret_cast<sockaddr_in6*>(curr->ai_addr);
+                            ip = inet_ntop(AF_INET6, &addr->sin6_addr, buff, sizeof(buff));
+                            v6_first |= v4.empty() && v6.empty();
+                        }
+
+                        if (ip != nullptr)
+                        {
+                            auto& target = curr->ai_family == AF_INET ? v4 : v6;
+                            auto address = std::make_pair(curr->ai_family, std::string(ip));
+
+                            if (std::find(target.begin(), target.end(), address) == target.end())
+                            {
+                                target.push_back(address);
+                            }
+                        }
+                    }
+
+                    freeaddrinfo(result);
+                    interleave(v4, v6, v6_first, entry);
+
+                    entry.expires = std::chrono::steady_clock::now()
+                                    + std::chrono::seconds(CONFIG_SMOOTH_DNS_CACHE_TTL);
+                }
+
+                return res == 0 && !entry.addresses.empty();
+            }
+
+            void DnsResolver::interleave(const std::vector<std::pair<int, std::string>>& v4,
+                                         const std::vector<std::pair<int, std::string>>& v6,
+                                         bool v6_first, CacheEntry& entry)
+            {
+                // Interleave the families (RFC 8305, section 4) so that a connection attempt
+                // using the other family is made early if the preferred one doesn't work.
+                auto& first = v6_first ? v6 : v4;
+                auto& second = v6_first ? v4 : v6;
+
+                for (size_t i = 0; i < std::max(first.size(), second.size()); ++i)
+                {
+                    if (i < first.size())
+                    {
+                        entry.addresses.push_back(first[i]);
+                    }
+
+                    if (i < second.size())
+                    {
+                        entry.addresses.push_back(second[i]);
+                    }
+                }
+            }
+
+            AddressList DnsResolver::create_addresses(const CacheEntry& entry, uint16_t port)
+            {
+                AddressList addresses;
+
+                for (auto& address : entry.addresses)
+                {
+                    if (address.first == AF_INET)
+                    {
+                        addresses.push_back(std::make_shared<IPv4>(address.second, port));
+                    }
+                    else
+                    {
+                        addresses.push_back(std::make_shared<IPv6>(address.second, port));
+                    }
+                }
+
+                return addresses;
+            }
+        }
+    }
+}
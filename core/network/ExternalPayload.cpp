@@ -0,0 +1,53 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <smooth/core/network/ExternalPayload.h>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            ExternalPayload::~ExternalPayload()
+            {
+                if (file >= 0)
+                {
+                    close(file);
+                }
+            }
+
+            int ExternalPayload::read(size_t position, uint8_t* target, size_t max_length) const
+            {
+                int res = 0;
+                auto amount = position < length ? std::min(max_length, length - position) : 0;
+
+                if (amount > 0)
+                {
+                    if (is_file())
+                    {
+#ifdef ESP_PLATFORM
+                        // The VFS doesn't provide pread().
+                        res = lseek(file, offset + static_cast<off_t>(position), SEEK_SET) < 0
+                              ? -1
+                              : static_cast<int>(::read(file, target, amount));
+#else
+                        res = static_cast<int>(pread(file, target, amount, offset + static_cast<off_t>(position)));
+#endif
+                    }
+                    else
+                    {
+                        memcpy(target, data + position, amount);
+                        res = static_cast<int>(amount);
+                    }
+                }
+
+                return res;
+            }
+        }
+    }
+}
@@ -7,7 +7,7 @@
 
 namespace smooth
 {
-    namespace  core
+    namespace core
     {
         namespace network
         {
@@ -17,7 +17,7 @@ namespace smooth
                 memset(&sock_address, 0, sizeof(sock_address));
                 sock_address.sin6_family = AF_INET6;
                 sock_address.sin6_port = htons(port);
-                valid = inet_pton(AF_INET, ip_number_as_string.c_str(), &sock_address.sin6_addr) == 1;
+                valid = inet_pton(AF_INET6, ip_number_as_string.c_str(), &sock_address.sin6_addr) == 1;
             }
 
             sockaddr* IPv6::get_socket_address()
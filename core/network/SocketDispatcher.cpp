@@ -55,6 +55,8 @@ namespace smooth
                 std::lock_guard<std::mutex> lock(socket_guard);
                 restart_inactive_sockets();
                 check_socket_send_timeout();
+                check_pending_input();
+                check_connecting_sockets();
 
                 int max_file_descriptor = build_sets();
                 if (max_file_descriptor >= 0)
@@ -68,24 +70,36 @@ namespace smooth
                     }
                     else if (res > 0)
                     {
-                        for (int i = 0; i <= max_file_descriptor; ++i)
+                        for (auto i = list_heads[Occupied]; i >= 0; i = next_slot(Occupied, i))
                         {
+                            // Sockets are indexed by their id, see check_connecting_sockets().
+                            auto ix = static_cast<size_t>(i);
+                            auto& socket = active_sockets[ix].socket;
+
                             if (FD_ISSET(i, &read_set))
                             {
-                                auto it = active_sockets.find(i);
-                                if (it != active_sockets.end())
+                                socket->readable();
+
+                                if (socket->has_staged_input())
                                 {
-                                    it->second->readable();
+                                    link(StagedInput, ix);
                                 }
                             }
 
                             if (FD_ISSET(i, &write_set))
                             {
-                                auto it = active_sockets.find(i);
-                                if (it != active_sockets.end())
-                                {
-                                    it->second->writable();
-                                }
+                                socket->writable();
+                                schedule_send_timeout(i);
+                            }
+                        }
+
+                        for (auto id : alternate_ids)
+                        {
+                            auto& slot = active_sockets[static_cast<size_t>(id)];
+
+                            if (FD_ISSET(id, &write_set) && !slot.socket && slot.connecting != nullptr)
+                            {
+                                slot.connecting->writable();
                             }
                         }
                     }
@@ -125,11 +139,18 @@ namespace smooth
             {
                 clear_sets();
 
+                for (auto id : alternate_ids)
+                {
+                    active_sockets[static_cast<size_t>(id)].connecting = nullptr;
+                }
+
+                alternate_ids.clear();
                 int max = -1;
 
-                for (auto& pair : active_sockets)
+                for (auto i = list_heads[Occupied]; i >= 0; i = next_slot(Occupied, i))
                 {
-                    auto& s = pair.second;
+                    // The table may grow below, so don't keep a reference into it.
+                    auto s = active_sockets[static_cast<size_t>(i)].socket.get();
 
                     max = std::max(max, s->get_socket_id());
                     if (s->is_active())
@@ -143,6 +164,21 @@ namespace smooth
                         {
                             FD_SET(s->get_socket_id(), &read_set);
                         }
+                        else if (s->get_alternate_socket_id() >= 0)
+                        {
+                            // A second connection attempt running in parallel, see Socket<Packet>.
+                            auto alt = s->get_alternate_socket_id();
+                            max = std::max(max, alt);
+                            FD_SET(alt, &write_set);
+
+                            if (static_cast<size_t>(alt) >= active_sockets.size())
+                            {
+                                active_sockets.resize(static_cast<size_t>(alt) + 1);
+                            }
+
+                            active_sockets[static_cast<size_t>(alt)].connecting = s;
+                            alternate_ids.push_back(alt);
+                        }
                     }
                 }
 
@@ -157,7 +193,7 @@ namespace smooth
                 {
                     if (socket->internal_start())
                     {
-                        active_sockets.insert(std::make_pair(socket->get_socket_id(), socket));
+                        add_to_active_sockets(socket->get_socket_id(), socket);
                     }
                 }
                 else
@@ -213,16 +249,104 @@ namespace smooth
 
             void SocketDispatcher::remove_socket_from_active_sockets(std::shared_ptr<ISocket>& socket)
             {
-                auto found = std::find_if(active_sockets.begin(), active_sockets.end(),
-                                          [socket](std::pair<int, std::shared_ptr<ISocket>> o)
-                                          {
-                                              return o.second.get() == socket.get();
-                                          });
+                auto id = socket->get_socket_id();
+                auto found = -1;
+
+                if (id >= 0 && static_cast<size_t>(id) < active_sockets.size()
+                    && active_sockets[static_cast<size_t>(id)].socket == socket)
+                {
+                    found = id;
+                }
+                else
+                {
+                    // The socket may have lost its id, e.g. after a failed connection attempt.
+                    for (auto i = list_heads[Occupied]; i >= 0 && found < 0; i = next_slot(Occupied, i))
+                    {
+                        found = active_sockets[static_cast<size_t>(i)].socket == socket ? i : -1;
+                    }
+                }
+
+                if (found >= 0)
+                {
+                    vacate_slot(static_cast<size_t>(found));
+                }
+            }
+
+            void SocketDispatcher::vacate_slot(size_t ix)
+            {
+                auto& slot = active_sockets[ix];
+                slot.socket.reset();
+                ++slot.generation;
+                slot.send_timeout_scheduled = false;
+
+                for (int list = 0; list < SlotListCount; ++list)
+                {
+                    unlink(static_cast<SlotList>(list), ix);
+                }
+            }
+
+            void SocketDispatcher::link(SlotList list, size_t ix)
+            {
+                auto& slot = active_sockets[ix];
+
+                if (!slot.linked[list])
+                {
+                    // New slots go first, so a list being walked doesn't visit them until the next tick.
+                    slot.linked[list] = true;
+                    slot.previous[list] = -1;
+                    slot.next[list] = list_heads[list];
+
+                    if (list_heads[list] >= 0)
+                    {
+                        active_sockets[static_cast<size_t>(list_heads[list])].previous[list] = static_cast<int>(ix);
+                    }
+
+                    list_heads[list] = static_cast<int>(ix);
+                }
+            }
+
+            void SocketDispatcher::unlink(SlotList list, size_t ix)
+            {
+                auto& slot = active_sockets[ix];
+
+                if (slot.linked[list])
+                {
+                    if (slot.previous[list] >= 0)
+                    {
+                        active_sockets[static_cast<size_t>(slot.previous[list])].next[list] = slot.next[list];
+                    }
+                    else
+                    {
+                        list_heads[list] = slot.next[list];
+                    }
+
+                    if (slot.next[list] >= 0)
+                    {
+                        active_sockets[static_cast<size_t>(slot.next[list])].previous[list] = slot.previous[list];
+                    }
+
+                    slot.linked[list] = false;
+                    slot.previous[list] = -1;
+                    slot.next[list] = -1;
+                }
+            }
+
+            void SocketDispatcher::add_to_active_sockets(int socket_id, std::shared_ptr<ISocket> socket)
+            {
+                auto ix = static_cast<size_t>(socket_id);
 
-                if (found != active_sockets.end())
+                if (ix >= active_sockets.size())
                 {
-                    active_sockets.erase(found);
+                    active_sockets.resize(ix + 1);
                 }
+
+                auto& slot = active_sockets[ix];
+                slot.socket = std::move(socket);
+                ++slot.generation;
+                slot.send_timeout_scheduled = false;
+                link(Occupied, ix);
+                // Checked until connected, see check_connecting_sockets().
+                link(Connecting, ix);
             }
 
             void SocketDispatcher::restart_inactive_sockets()
@@ -234,7 +358,7 @@ namespace smooth
                     {
                         if (socket->internal_start())
                         {
-                            active_sockets.insert(std::make_pair(socket->get_socket_id(), socket));
+                            add_to_active_sockets(socket->get_socket_id(), socket);
                         }
                         else
                         {
@@ -268,11 +392,10 @@ namespace smooth
 
                 if (shall_close_sockets)
                 {
-                    std::for_each(active_sockets.begin(), active_sockets.end(),
-                                  [this](decltype(*active_sockets.begin()) &s)
-                                  {
-                                      this->perform_op(SocketOperation::Op::Stop, s.second);
-                                  });
+                    for (auto i = list_heads[Occupied]; i >= 0; i = next_slot(Occupied, i))
+                    {
+                        perform_op(SocketOperation::Op::Stop, active_sockets[static_cast<size_t>(i)].socket);
+                    }
                 }
             }
 
@@ -293,14 +416,124 @@ namespace smooth
                 socket_op.push(SocketOperation(op, std::move(socket)));
             }
 
+            SocketDispatcher::StatisticsSnapshot SocketDispatcher::get_statistics()
+            {
+                // The statistics are only updated while holding the lock, so this gives a consistent copy.
+                std::lock_guard<std::mutex> lock(socket_guard);
+                StatisticsSnapshot snapshot;
+                snapshot.reserve(active_sockets.size() + inactive_sockets.size());
+
+                for (auto i = list_heads[Occupied]; i >= 0; i = next_slot(Occupied, i))
+                {
+                    auto& socket = active_sockets[static_cast<size_t>(i)].socket;
+                    snapshot.emplace_back(socket, socket->get_statistics());
+                }
+
+                for (auto& socket : inactive_sockets)
+                {
+                    snapshot.emplace_back(socket, socket->get_statistics());
+                }
+
+                return snapshot;
+            }
+
             void SocketDispatcher::check_socket_send_timeout()
             {
-                for(auto& pair : active_sockets)
+                send_timeouts.advance(std::chrono::steady_clock::now(),
+                                      [this](const SocketReference& reference)
+                                      {
+                                          send_timeout_expired(reference);
+                                      });
+            }
+
+            void SocketDispatcher::schedule_send_timeout(int socket_id)
+            {
+                auto& slot = active_sockets[static_cast<size_t>(socket_id)];
+
+                if (!slot.send_timeout_scheduled)
                 {
-                    if(pair.second->has_send_expired())
+                    auto left = slot.socket->get_send_time_left();
+
+                    if (left != std::chrono::milliseconds::max())
+                    {
+                        slot.send_timeout_scheduled = true;
+                        send_timeouts.schedule(SocketReference{socket_id, slot.generation}, left);
+                    }
+                }
+            }
+
+            void SocketDispatcher::send_timeout_expired(const SocketReference& reference)
+            {
+                auto ix = static_cast<size_t>(reference.socket_id);
+
+                if (ix < active_sockets.size() && active_sockets[ix].generation == reference.generation
+                    && active_sockets[ix].socket)
+                {
+                    auto& slot = active_sockets[ix];
+                    slot.send_timeout_scheduled = false;
+
+                    if (slot.socket->has_send_expired())
+                    {
+                        Log::verbose(tag, Format("Send timeout on socket {1}", Pointer(slot.socket.get())));
+                        ++slot.socket->get_statistics().send_timeouts;
+                        slot.socket->stop();
+                    }
+                    else
+                    {
+                        // Still sending, or the send completed and another one started since.
+                        schedule_send_timeout(reference.socket_id);
+                    }
+                }
+            }
+
+            void SocketDispatcher::check_connecting_sockets()
+            {
+                auto i = list_heads[Connecting];
+
+                while (i >= 0)
+                {
+                    auto ix = static_cast<size_t>(i);
+                    i = active_sockets[ix].next[Connecting];
+
+                    // A socket whose parallel connection attempt won continues on that socket id.
+                    auto id = active_sockets[ix].socket->get_socket_id();
+
+                    if (id >= 0 && static_cast<size_t>(id) != ix)
+                    {
+                        auto socket = active_sockets[ix].socket;
+                        vacate_slot(ix);
+                        add_to_active_sockets(id, std::move(socket));
+                        ix = static_cast<size_t>(id);
+                    }
+
+                    if (!active_sockets[ix].socket->check_connection_attempts())
+                    {
+                        unlink(Connecting, ix);
+                    }
+                }
+            }
+
+            void SocketDispatcher::check_pending_input()
+            {
+                // Sockets with a staging buffer may hold already received data that couldn't be assembled
+                // into packets because the receive buffer was full at the time. Such data doesn't make
+                // the socket readable again so it must be handled here.
+                auto i = list_heads[StagedInput];
+
+                while (i >= 0)
+                {
+                    auto ix = static_cast<size_t>(i);
+                    i = active_sockets[ix].next[StagedInput];
+                    auto& socket = active_sockets[ix].socket;
+
+                    if (socket->has_pending_input())
+                    {
+                        socket->readable();
+                    }
+
+                    if (!socket->has_staged_input())
                     {
-                        Log::verbose(tag, Format("Send timeout on socket {1}", Pointer(pair.second.get())));
-                        pair.second->stop();
+                        unlink(StagedInput, ix);
                     }
                 }
             }
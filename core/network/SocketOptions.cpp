@@ -0,0 +1,163 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <smooth/core/network/SocketOptions.h>
+#include <smooth/core/logging/log.h>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+using namespace smooth::core::logging;
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            static const char* tag = "SocketOptions";
+
+            /// Sets an integer option and reads back the value the system actually uses, which may differ
+            /// from the requested one; Linux doubles buffer sizes for example.
+            static int set_and_read_back(int socket_id, int level, int option, int value, const char* name)
+            {
+                int res = 0;
+
+                if (setsockopt(socket_id, level, option, &value, sizeof(value)) != 0)
+                {
+                    Log::warning(tag, Format("Could not set {1} to {2}: {3}",
+                                             Str(name), Int32(value), Str(strerror(errno))));
+                }
+                else
+                {
+                    socklen_t len = sizeof(res);
+                    if (getsockopt(socket_id, level, option, &res, &len) != 0)
+                    {
+                        // Set, but not readable; assume the requested value is in effect.
+                        res = value;
+                    }
+                }
+
+                return res;
+            }
+
+            SocketOptions SocketOptions::apply(int socket_id, int protocol_family) const
+            {
+                SocketOptions applied;
+                applied.no_delay = false;
+
+                if (no_delay)
+                {
+                    applied.no_delay = set_and_read_back(socket_id, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY") != 0;
+                }
+
+                if (socket_send_buffer > 0)
+                {
+                    applied.socket_send_buffer = set_and_read_back(socket_id, SOL_SOCKET, SO_SNDBUF,
+                                                                   socket_send_buffer, "SO_SNDBUF");
+                }
+
+                if (socket_receive_buffer > 0)
+                {
+                    applied.socket_receive_buffer = set_and_read_back(socket_id, SOL_SOCKET, SO_RCVBUF,
+                                                                      socket_receive_buffer, "SO_RCVBUF");
+                }
+
+                if (keep_alive)
+                {
+                    applied.keep_alive = set_and_read_back(socket_id, SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE") != 0;
+
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+                    if (keep_alive_idle > 0)
+                    {
+                        applied.keep_alive_idle = set_and_read_back(socket_id, IPPROTO_TCP, TCP_KEEPIDLE,
+                                                                    keep_alive_idle, "TCP_KEEPIDLE");
+                    }
+
+                    if (keep_alive_interval > 0)
+                    {
+                        applied.keep_alive_interval = set_and_read_back(socket_id, IPPROTO_TCP, TCP_KEEPINTVL,
+                                                                        keep_alive_interval, "TCP_KEEPINTVL");
+                    }
+
+                    if (keep_alive_count > 0)
+                    {
+                        applied.keep_alive_count = set_and_read_back(socket_id, IPPROTO_TCP, TCP_KEEPCNT,
+                                                                     keep_alive_count, "TCP_KEEPCNT");
+                    }
+#endif
+                }
+
+#ifdef TCP_CORK
+                // Applied around each batch by the socket, see set_cork().
+                applied.cork_batches = cork_batches;
+#endif
+
+#ifdef TCP_QUICKACK
+                if (quick_ack)
+                {
+                    applied.quick_ack = set_and_read_back(socket_id, IPPROTO_TCP, TCP_QUICKACK, 1, "TCP_QUICKACK") != 0;
+                }
+#endif
+
+#ifdef SO_BUSY_POLL
+                if (busy_poll > 0)
+                {
+                    applied.busy_poll = set_and_read_back(socket_id, SOL_SOCKET, SO_BUSY_POLL, busy_poll, "SO_BUSY_POLL");
+                }
+#endif
+
+                if (type_of_service >= 0)
+                {
+#ifdef IPV6_TCLASS
+                    if (protocol_family == PF_INET6)
+                    {
+                        applied.type_of_service = set_and_read_back(socket_id, IPPROTO_IPV6, IPV6_TCLASS,
+                                                                    type_of_service, "IPV6_TCLASS");
+                    }
+                    else
+#endif
+                    {
+                        (void) protocol_family;
+                        applied.type_of_service = set_and_read_back(socket_id, IPPROTO_IP, IP_TOS,
+                                                                    type_of_service, "IP_TOS");
+                    }
+                }
+
+#ifdef SO_ZEROCOPY
+                if (zero_copy_threshold > 0
+                    && set_and_read_back(socket_id, SOL_SOCKET, SO_ZEROCOPY, 1, "SO_ZEROCOPY") != 0)
+                {
+                    applied.zero_copy_threshold = zero_copy_threshold;
+                }
+#endif
+
+                return applied;
+            }
+
+            void SocketOptions::set_cork(int socket_id, bool enable)
+            {
+#ifdef TCP_CORK
+                int value = enable ? 1 : 0;
+                setsockopt(socket_id, IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+#else
+                (void) socket_id;
+                (void) enable;
+#endif
+            }
+
+            void SocketOptions::set_quick_ack(int socket_id)
+            {
+#ifdef TCP_QUICKACK
+                int value = 1;
+                setsockopt(socket_id, IPPROTO_TCP, TCP_QUICKACK, &value, sizeof(value));
+#else
+                (void) socket_id;
+#endif
+            }
+        }
+    }
+}
@@ -0,0 +1,143 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include <smooth/core/network/TlsContext.h>
+#include <smooth/core/logging/log.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+
+using namespace smooth::core::logging;
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            static const char* tag = "TlsContext";
+
+            TlsContext::TlsContext(bool verify_peer)
+                    : verify_peer(verify_peer)
+            {
+#ifdef ESP_PLATFORM
+                ctx = SSL_CTX_new(TLSv1_2_client_method());
+#else
+                ctx = SSL_CTX_new(TLS_client_method());
+#endif
+                if (ctx == nullptr)
+                {
+                    Log::error(tag, Format("Could not create SSL context"));
+                }
+                else
+                {
+                    SSL_CTX_set_verify(ctx, verify_peer ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, nullptr);
+#ifndef ESP_PLATFORM
+                    // The socket retries a partially sent packet from where it left off, not necessarily
+                    // with the same buffer address.
+                    SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+                    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT);
+#endif
+                }
+            }
+
+            TlsContext::~TlsContext()
+            {
+#ifndef ESP_PLATFORM
+                for (auto& pair : sessions)
+                {
+                    SSL_SESSION_free(pair.second);
+                }
+#endif
+
+                if (ctx != nullptr)
+                {
+                    SSL_CTX_free(ctx);
+                }
+            }
+
+            bool TlsContext::add_ca_certificate(const std::string& certificate)
+            {
+                bool res = false;
+
+                if (ctx != nullptr)
+                {
+#ifdef ESP_PLATFORM
+                    // The OpenSSL wrapper in IDF parses PEM via d2i_X509.
+                    auto cert = d2i_X509(nullptr,
+                                         reinterpret_cast<const unsigned char*>(certificate.c_str()),
+                                         static_cast<long>(certificate.length() + 1));
+                    res = cert != nullptr && SSL_CTX_add_client_CA(ctx, cert) == 1;
+#else
+                    auto bio = BIO_new_mem_buf(certificate.data(), static_cast<int>(certificate.length()));
+                    auto cert = bio == nullptr ? nullptr : PEM_read_bio_X509(bio, nullptr, nullptr, nullptr);
+                    res = cert != nullptr && X509_STORE_add_cert(SSL_CTX_get_cert_store(ctx), cert) == 1;
+
+                    if (cert != nullptr)
+                    {
+                        X509_free(cert);
+                    }
+
+                    if (bio != nullptr)
+                    {
+                        BIO_free(bio);
+                    }
+#endif
+                }
+
+                if (!res)
+                {
+                    Log::error(tag, Format("Could not add CA certificate"));
+                }
+
+                return res;
+            }
+
+            void TlsContext::save_session(const std::string& server_name, SSL* ssl)
+            {
+#ifdef ESP_PLATFORM
+                // Session resumption is not supported by the OpenSSL wrapper in IDF.
+                (void) server_name;
+                (void) ssl;
+#else
+                auto session = SSL_get1_session(ssl);
+
+                if (session != nullptr && !SSL_SESSION_is_resumable(session))
+                {
+                    SSL_SESSION_free(session);
+                    session = nullptr;
+                }
+
+                if (session != nullptr)
+                {
+                    std::lock_guard<std::mutex> lock(session_guard);
+                    auto& current = sessions[server_name];
+
+                    if (current != nullptr)
+                    {
+                        SSL_SESSION_free(current);
+                    }
+
+                    current = session;
+                }
+#endif
+            }
+
+            void TlsContext::resume_session(const std::string& server_name, SSL* ssl)
+            {
+#ifdef ESP_PLATFORM
+                (void) server_name;
+                (void) ssl;
+#else
+                std::lock_guard<std::mutex> lock(session_guard);
+                auto session = sessions.find(server_name);
+
+                if (session != sessions.end())
+                {
+                    SSL_set_session(ssl, session->second);
+                }
+#endif
+            }
+        }
+    }
+}
@@ -5,7 +5,11 @@
 #pragma once
 
 #include <chrono>
+#include <string>
+#include <vector>
+#include <utility>
 #include <smooth/core/ipc/TaskEventQueue.h>
+#include <smooth/application/network/mqtt/packet/MQTTPacket.h>
 
 namespace smooth
 {
@@ -15,6 +19,8 @@ namespace smooth
         {
             namespace mqtt
             {
+                typedef std::pair<std::string, std::vector<uint8_t>> MQTTData;
+
                 class Publication;
 
                 class Subscription;
@@ -27,6 +33,7 @@ namespace smooth
                         virtual const std::string& get_client_id() const = 0;
                         virtual const std::chrono::seconds get_keep_alive() const = 0;
                         virtual void start_reconnect() = 0;
+                        virtual void reset_reconnect_backoff() = 0;
                         virtual void reconnect() = 0;
                         virtual bool is_auto_reconnect() const = 0;
                         virtual void disconnect() = 0;
@@ -35,8 +42,7 @@ namespace smooth
                         virtual bool send_packet(packet::MQTTPacket& packet) = 0;
                         virtual Publication& get_publication() = 0;
                         virtual Subscription& get_subscription() = 0;
-                        virtual core::ipc::TaskEventQueue<std::pair<std::string, std::vector<uint8_t>>>&
-                                                    get_application_queue() = 0;
+                        virtual core::ipc::TaskEventQueue<MQTTData>& get_application_queue() = 0;
                 };
 
             }
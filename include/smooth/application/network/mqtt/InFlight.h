@@ -25,11 +25,18 @@ namespace smooth
                 class InFlight
                 {
                     public:
+                        InFlight() = default;
+
                         explicit InFlight(T& p)
                                 : p(p)
                         {
                         }
 
+                        explicit InFlight(T&& p)
+                                : p(std::move(p))
+                        {
+                        }
+
                         T& get_packet()
                         {
                             return p;
@@ -45,6 +52,17 @@ namespace smooth
                             waiting_for_packet = type;
                         }
 
+                        /// Marks that a PubRel is to be sent for the packet but hasn't fit in the transmit buffer yet.
+                        void set_pub_rel_pending(bool pending)
+                        {
+                            pub_rel_pending = pending;
+                        }
+
+                        bool is_pub_rel_pending() const
+                        {
+                            return pub_rel_pending;
+                        }
+
                         void start_timer()
                         {
                             timer.start();
@@ -69,6 +87,7 @@ namespace smooth
                     private:
                         T p{};
                         PacketType waiting_for_packet = PacketType::Reserved;
+                        bool pub_rel_pending = false;
                         core::timer::ElapsedTime timer{};
                 };
             }
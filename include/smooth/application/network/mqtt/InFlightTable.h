@@ -0,0 +1,326 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                /// A table of packets in flight, keyed by packet identifier. The slots are allocated up front, see
+                /// reserve(), so that adding and removing packets takes constant time and doesn't allocate.
+                /// Packet identifiers are handed out in sequence and are spread over the slots by multiplicative
+                /// hashing, as a window of consecutive identifiers in consecutive slots would make a single long
+                /// run to search on each removal. Should more packets be added than have been reserved for, the
+                /// table grows.
+                /// The packets are also kept in the order they were added, linked by their identifiers so that the
+                /// links survive packets being moved between slots, see first_id() and next_id().
+                /// Not thread-safe.
+                template<typename T>
+                class InFlightTable
+                {
+                    public:
+                        /// Constructor
+                        /// \param count The number of packets to reserve slots for.
+                        explicit InFlightTable(size_t count = 4)
+                        {
+                            reserve(count);
+                        }
+
+                        /// Makes room for the given number of packets. Existing packets are kept.
+                        void reserve(size_t count)
+                        {
+                            // Keep the table at most half full so that probe sequences stay short.
+                            size_t capacity = 8;
+                            while (capacity < count * 2)
+                            {
+                                capacity <<= 1;
+                            }
+
+                            if (capacity > slots.size())
+                            {
+                                rehash(capacity);
+                            }
+                        }
+
+                        /// Finds a packet.
+                        /// \return The packet, or nullptr if there is none with the identifier.
+                        T* find(uint16_t id)
+                        {
+                            auto i = find_slot(id);
+                            return i < slots.size() ? &slots[i].value : nullptr;
+                        }
+
+                        /// Adds a packet last, unless there already is one with the identifier.
+                        /// \return The packet in the table.
+                        T& insert(uint16_t id, T&& value)
+                        {
+                            auto i = find_slot(id);
+
+                            if (i == slots.size())
+                            {
+                                if ((count + 1) * 2 > slots.size())
+                                {
+                                    rehash(slots.size() * 2);
+                                }
+
+                                i = free_slot(id);
+                                auto& slot = slots[i];
+                                slot.value = std::move(value);
+                                slot.id = id;
+                                slot.used = true;
+                                ++count;
+                                link_last(slot);
+                            }
+
+                            return slots[i].value;
+                        }
+
+                        /// Removes a packet.
+                        /// \return true if there was a packet with the identifier.
+                        bool erase(uint16_t id)
+                        {
+                            auto i = find_slot(id);
+                            bool res = i < slots.size();
+
+                            if (res)
+                            {
+                                unlink(slots[i]);
+                                erase_slot(i);
+                            }
+
+                            return res;
+                        }
+
+                        /// Moves a packet to be the last one, as if it had just been added.
+                        void move_to_back(uint16_t id)
+                        {
+                            auto i = find_slot(id);
+
+                            if (i < slots.size() && newest != id)
+                            {
+                                unlink(slots[i]);
+                                link_last(slots[i]);
+                            }
+                        }
+
+                        /// \return The identifier of the packet added first, or -1 if the table is empty.
+                        int32_t first_id() const
+                        {
+                            return oldest;
+                        }
+
+                        /// \return The identifier of the packet added last, or -1 if the table is empty.
+                        int32_t last_id() const
+                        {
+                            return newest;
+                        }
+
+                        /// \return The identifier of the packet added after the given one, or -1 if there is none.
+                        int32_t next_id(uint16_t id) const
+                        {
+                            auto i = find_slot(id);
+                            return i < slots.size() ? slots[i].newer : -1;
+                        }
+
+                        /// \return The identifier of the packet added before the given one, or -1 if there is none.
+                        int32_t previous_id(uint16_t id) const
+                        {
+                            auto i = find_slot(id);
+                            return i < slots.size() ? slots[i].older : -1;
+                        }
+
+                        void clear()
+                        {
+                            for (auto& slot : slots)
+                            {
+                                if (slot.used)
+                                {
+                                    slot.value = T();
+                                    slot.used = false;
+                                }
+                            }
+
+                            count = 0;
+                            oldest = -1;
+                            newest = -1;
+                        }
+
+                        size_t size() const
+                        {
+                            return count;
+                        }
+
+                        bool empty() const
+                        {
+                            return count == 0;
+                        }
+
+                        /// Calls f(id, packet) for each packet, in the order they were added. f must not add,
+                        /// remove or move packets.
+                        template<typename F>
+                        void for_each(F f)
+                        {
+                            for (auto id = oldest; id >= 0;)
+                            {
+                                auto& slot = slots[find_slot(static_cast<uint16_t>(id))];
+                                id = slot.newer;
+                                f(slot.id, slot.value);
+                            }
+                        }
+
+                    private:
+                        class Slot
+                        {
+                            public:
+                                T value{};
+                                uint16_t id = 0;
+                                bool used = false;
+                                // The identifiers of the packets added before and after this one, or -1.
+                                int32_t older = -1;
+                                int32_t newer = -1;
+                        };
+
+                        // Returns the index of the slot holding the packet, or slots.size() if there is none.
+                        size_t find_slot(uint16_t id) const
+                        {
+                            auto res = slots.size();
+
+                            for (auto i = home(id); slots[i].used && res == slots.size(); i = next(i))
+                            {
+                                if (slots[i].id == id)
+                                {
+                                    res = i;
+                                }
+                            }
+
+                            return res;
+                        }
+
+                        size_t free_slot(uint16_t id) const
+                        {
+                            auto i = home(id);
+                            while (slots[i].used)
+                            {
+                                i = next(i);
+                            }
+
+                            return i;
+                        }
+
+                        void link_last(Slot& slot)
+                        {
+                            slot.older = newest;
+                            slot.newer = -1;
+
+                            if (newest >= 0)
+                            {
+                                slots[find_slot(static_cast<uint16_t>(newest))].newer = slot.id;
+                            }
+                            else
+                            {
+                                oldest = slot.id;
+                            }
+
+                            newest = slot.id;
+                        }
+
+                        void unlink(Slot& slot)
+                        {
+                            if (slot.older >= 0)
+                            {
+                                slots[find_slot(static_cast<uint16_t>(slot.older))].newer = slot.newer;
+                            }
+                            else
+                            {
+                                oldest = slot.newer;
+                            }
+
+                            if (slot.newer >= 0)
+                            {
+                                slots[find_slot(static_cast<uint16_t>(slot.newer))].older = slot.older;
+                            }
+                            else
+                            {
+                                newest = slot.older;
+                            }
+                        }
+
+                        size_t home(uint16_t id) const
+                        {
+                            // Fibonacci hashing; the top bits of the product select the slot.
+                            return (static_cast<uint32_t>(id) * 2654435769u) >> shift;
+                        }
+
+                        size_t next(size_t i) const
+                        {
+                            return (i + 1) & (slots.size() - 1);
+                        }
+
+                        // Empties the slot and moves back any following packets that were placed further from
+                        // their home slot because of it, so that lookups never need to skip removed slots.
+                        void erase_slot(size_t i)
+                        {
+                            slots[i].value = T();
+                            slots[i].used = false;
+                            --count;
+
+                            for (auto j = next(i); slots[j].used; j = next(j))
+                            {
+                                auto k = home(slots[j].id);
+
+                                // Leave the packet where it is if its home slot is cyclically within (i, j].
+                                bool stays = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+
+                                if (!stays)
+                                {
+                                    slots[i] = std::move(slots[j]);
+                                    slots[j].value = T();
+                                    slots[j].used = false;
+                                    i = j;
+                                }
+                            }
+                        }
+
+                        void rehash(size_t capacity)
+                        {
+                            std::vector<Slot> old(capacity);
+                            old.swap(slots);
+
+                            shift = 32;
+                            while (capacity > 1)
+                            {
+                                capacity >>= 1;
+                                --shift;
+                            }
+
+                            // The order links are identifiers, so the slots move over as they are.
+                            for (auto& slot : old)
+                            {
+                                if (slot.used)
+                                {
+                                    slots[free_slot(slot.id)] = std::move(slot);
+                                }
+                            }
+                        }
+
+                        std::vector<Slot> slots{};
+                        size_t count = 0;
+                        uint32_t shift = 32;
+                        int32_t oldest = -1;
+                        int32_t newest = -1;
+                };
+            }
+        }
+    }
+}
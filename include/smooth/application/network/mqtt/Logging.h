@@ -4,6 +4,10 @@
 
 #pragma once
 
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif // END ESP_PLATFORM
+
 namespace smooth
 {
     namespace application
@@ -13,6 +17,10 @@ namespace smooth
             namespace mqtt
             {
                 static constexpr const char* mqtt_log_tag = "SmoothMQTT";;
+
+                // The configured log level, 0 (none) to 5 (verbose). Messages logged for every packet are only
+                // built when they are shown, since formatting them costs more than handling the packet.
+                static constexpr int mqtt_log_level = CONFIG_SMOOTH_MQTT_LOGGING_LEVEL;
             }
         }
     }
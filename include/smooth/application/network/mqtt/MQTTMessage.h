@@ -0,0 +1,88 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <smooth/application/network/mqtt/packet/Publish.h>
+#include <smooth/application/network/mqtt/IMqttClient.h>
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                /// A received message. It holds the packet the message arrived in, taken over from the receive
+                /// buffer, and gives access to its topic and payload without copying them. Move it rather than
+                /// copying it, e.g. when taking it off a queue.
+                class MQTTMessage
+                {
+                    public:
+                        MQTTMessage() = default;
+                        MQTTMessage(const MQTTMessage&) = default;
+                        MQTTMessage& operator=(const MQTTMessage&) = default;
+
+                        MQTTMessage(MQTTMessage&& other)
+                                : publish(std::move(other.publish)), has_data(other.has_data)
+                        {
+                            other.has_data = false;
+                        }
+
+                        MQTTMessage& operator=(MQTTMessage&& other)
+                        {
+                            publish = std::move(other.publish);
+                            has_data = other.has_data;
+                            other.has_data = false;
+                            return *this;
+                        }
+
+                        /// Constructor
+                        /// \param publish The received packet, which is moved into the message.
+                        explicit MQTTMessage(packet::Publish&& publish);
+
+                        /// Gets the topic as a string.
+                        /// \return The topic
+                        std::string get_topic() const;
+
+                        /// Gets the topic as it is stored in the message, i.e. not null-terminated.
+                        /// \return The first character of the topic.
+                        const char* get_topic_data() const;
+
+                        /// Gets the length of the topic.
+                        /// \return Number of characters
+                        uint16_t get_topic_length() const;
+
+                        /// Gets the payload.
+                        /// \return The first byte of the payload.
+                        const uint8_t* get_payload() const;
+
+                        /// Gets the length of the payload.
+                        /// \return Number of bytes
+                        size_t get_payload_length() const;
+
+                        /// Gets the QoS the message was delivered with.
+                        /// \return The QoS
+                        QoS get_qos() const;
+
+                        /// Copies the message into the form passed to the application queue of the MqttClient.
+                        /// \return Topic and payload
+                        MQTTData to_data() const;
+
+                        /// Converts the message into the form passed to the application queue of the MqttClient,
+                        /// reusing its memory for the payload. The message is empty afterwards.
+                        /// \return Topic and payload
+                        MQTTData release_data();
+
+                    private:
+                        packet::Publish publish{};
+                        bool has_data = false;
+                };
+            }
+        }
+    }
+}
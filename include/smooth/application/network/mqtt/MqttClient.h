@@ -16,18 +16,24 @@
 #include <smooth/core/network/ConnectionStatusEvent.h>
 #include <smooth/core/network/TransmitBufferEmptyEvent.h>
 #include <smooth/core/network/Socket.h>
-#include <smooth/core/network/PacketSendBuffer.h>
+#include <smooth/core/network/SecureSocket.h>
+#include <smooth/core/network/TlsContext.h>
+#include <smooth/core/network/PacketPool.h>
+#include <smooth/core/network/PooledPacketSendBuffer.h>
 #include <smooth/core/network/PacketReceiveBuffer.h>
 #include <smooth/core/network/NetworkStatus.h>
+#include <smooth/core/network/BackoffPolicy.h>
 #include <smooth/core/ipc/TaskEventQueue.h>
 #include <smooth/core/ipc/SubscribingTaskEventQueue.h>
 #include <smooth/application/network/mqtt/packet/MQTTPacket.h>
+#include <smooth/application/network/mqtt/packet/PacketBatch.h>
 #include <smooth/core/timer/Timer.h>
 #include <smooth/application/network/mqtt/state/MqttFSM.h>
 #include <smooth/application/network/mqtt/state/MQTTBaseState.h>
 #include <smooth/application/network/mqtt/IMqttClient.h>
 #include <smooth/application/network/mqtt/event/BaseEvent.h>
 #include <smooth/application/network/mqtt/Publication.h>
+#include <smooth/application/network/mqtt/MqttClientOptions.h>
 #include <smooth/application/network/mqtt/Subscription.h>
 
 namespace smooth
@@ -38,8 +44,6 @@ namespace smooth
         {
             namespace mqtt
             {
-                typedef std::pair<std::string, std::vector<uint8_t>> MQTTData;
-
                 /// MQTT client; handles everything required for a connection to a single MQTT broker
                 /// such as connecting, subscribing and publishing topics.
                 class MqttClient
@@ -59,57 +63,160 @@ namespace smooth
                         /// \param stack_size The stack depth for the worker task. >=4096 should be sufficient.
                         /// \param priority Task priority. Depends on your system requirements. Usually tskIDLE_PRIORITY + some value.
                         /// \param application_queue The queue where incoming messages will be posted.
+                        /// \param options Limits of the outgoing queue and buffers.
                         MqttClient(const std::string& mqtt_client_id, std::chrono::seconds keep_alive,
                                    uint32_t stack_size,
-                                   uint32_t priority, core::ipc::TaskEventQueue<MQTTData>& application_queue);
+                                   uint32_t priority, core::ipc::TaskEventQueue<MQTTData>& application_queue,
+                                   const MqttClientOptions& options = MqttClientOptions());
 
                         /// Initiates a connection to the provided address.
                         /// \param address The address
                         /// \param auto_reconnect If true, the client will automatically reconnect when connection is lost.
+                        /// \param tls_context If set, the connection to the broker is encrypted using TLS.
+                        /// \param server_name The host name of the broker, used when connecting using TLS. The broker
+                        /// certificate must be issued for it if the TLS context verifies the peer.
                         void
-                        connect_to(std::shared_ptr<smooth::core::network::InetAddress> address, bool auto_reconnect);
+                        connect_to(std::shared_ptr<smooth::core::network::InetAddress> address, bool auto_reconnect,
+                                   std::shared_ptr<smooth::core::network::TlsContext> tls_context = nullptr,
+                                   const std::string& server_name = "");
 
                         void reconnect() override
                         {
+                            reconnect_pending = false;
+
                             if(address)
                             {
-                                connect_to(address, is_auto_reconnect());
+                                connect_to(address, is_auto_reconnect(), tls_context, server_name);
                             }
                         }
 
                         /// Disconnects from the broker.
                         void disconnect() override;
 
+                        /// Sets the policy for the delay between automatic reconnection attempts. By default, the delay
+                        /// starts at one second and doubles on each failed attempt up to a minute, with random jitter.
+                        /// Must be called before connect_to().
+                        /// \param policy The policy
+                        void set_reconnect_backoff(const smooth::core::network::BackoffPolicy& policy)
+                        {
+                            reconnect_backoff = policy;
+                        }
+
                         /// Publishes a message.
-                        /// Note: There is a maximum number of messages that can be in the outgoing queue. This number
-                        /// is determined by the configuration at compile time.
+                        /// Note: The outgoing queue holds at most MqttClientOptions::max_outgoing_messages messages
+                        /// and, if set, MqttClientOptions::max_outgoing_bytes bytes. MqttClientOptions::overflow_policy
+                        /// decides what happens when it is full.
                         /// \param topic The topic.
                         /// \param msg The message
                         /// \param qos The QoS level to publish the message as.
                         /// \param retain if true, the message is marked for retainment in the broker.
                         /// \return true if the message could be queued for delivery, otherwise false. A true value
-                        /// does not mean it has been delivered.
+                        /// does not mean it has been delivered. With OverflowPolicy::DropOldest, true may mean that
+                        /// older messages not yet sent were discarded; false then means that messages awaiting
+                        /// acknowledgement leave no room. With OverflowPolicy::Block, the call waits for room for
+                        /// up to MqttClientOptions::block_timeout and returns false if there is still none.
                         bool publish(const std::string& topic, const std::string& msg, mqtt::QoS qos, bool retain);
 
                         /// Publishes a message.
-                        /// Note: There is a maximum number of messages that can be in the outgoing queue. This number
-                        /// is determined by the configuration at compile time
+                        /// Note: The outgoing queue holds at most MqttClientOptions::max_outgoing_messages messages
+                        /// and, if set, MqttClientOptions::max_outgoing_bytes bytes. MqttClientOptions::overflow_policy
+                        /// decides what happens when it is full.
                         /// \param topic The topic.
                         /// \param data The data, as an array of bytes.
                         /// \param length The length of the array pointed to by the data parameter.
                         /// \param qos The QoS level to publish the message as.
                         /// \param retain if true, the message is marked for retainment in the broker.
                         /// \return true if the message could be queued for delivery, otherwise false. A true value
-                        /// does not mean it has been delivered.
+                        /// does not mean it has been delivered. With OverflowPolicy::DropOldest, true may mean that
+                        /// older messages not yet sent were discarded; false then means that messages awaiting
+                        /// acknowledgement leave no room. With OverflowPolicy::Block, the call waits for room for
+                        /// up to MqttClientOptions::block_timeout and returns false if there is still none.
                         bool
                         publish(const std::string& topic, const uint8_t* data, int length, mqtt::QoS qos, bool retain);
 
-                        /// Subscribes to a topic.
+                        /// Publishes a message, taking over the payload so that it isn't copied.
+                        /// Note: The outgoing queue holds at most MqttClientOptions::max_outgoing_messages messages
+                        /// and, if set, MqttClientOptions::max_outgoing_bytes bytes. MqttClientOptions::overflow_policy
+                        /// decides what happens when it is full.
+                        /// \param topic The topic.
+                        /// \param data The data, moved into the message if it is accepted.
+                        /// \param qos The QoS level to publish the message as.
+                        /// \param retain if true, the message is marked for retainment in the broker.
+                        /// \return true if the message could be queued for delivery, otherwise false. A true value
+                        /// does not mean it has been delivered. With OverflowPolicy::DropOldest, true may mean that
+                        /// older messages not yet sent were discarded; false then means that messages awaiting
+                        /// acknowledgement leave no room. With OverflowPolicy::Block, the call waits for room for
+                        /// up to MqttClientOptions::block_timeout and returns false if there is still none. If false,
+                        /// data is left untouched.
+                        bool publish(const std::string& topic, std::vector<uint8_t>&& data, mqtt::QoS qos, bool retain);
+
+                        /// Publishes a message whose payload is sent directly from where it is kept, i.e. without
+                        /// being copied into the outgoing packet. On Linux, large payloads in memory are sent with
+                        /// MSG_ZEROCOPY (see SocketOptions::zero_copy_threshold) and payloads in files with sendfile().
+                        /// Note: The outgoing queue holds at most MqttClientOptions::max_outgoing_messages messages
+                        /// and, if set, MqttClientOptions::max_outgoing_bytes bytes. MqttClientOptions::overflow_policy
+                        /// decides what happens when it is full.
+                        /// \param topic The topic.
+                        /// \param payload The payload. It must not change until the message has been delivered.
+                        /// \param qos The QoS level to publish the message as.
+                        /// \param retain if true, the message is marked for retainment in the broker.
+                        /// \return true if the message could be queued for delivery, otherwise false. A true value
+                        /// does not mean it has been delivered. With OverflowPolicy::DropOldest, true may mean that
+                        /// older messages not yet sent were discarded; false then means that messages awaiting
+                        /// acknowledgement leave no room. With OverflowPolicy::Block, the call waits for room for
+                        /// up to MqttClientOptions::block_timeout and returns false if there is still none.
+                        bool publish(const std::string& topic,
+                                     std::shared_ptr<const smooth::core::network::ExternalPayload> payload,
+                                     mqtt::QoS qos, bool retain);
+
+                        /// Sets the maximum number of QoS 1 and 2 messages that may be sent before the broker has
+                        /// acknowledged the earlier ones. The default of one sends a message only after the
+                        /// previous one has been acknowledged; a larger window keeps the connection busy when the
+                        /// round trip to the broker is long. Messages are still delivered in the order they were
+                        /// published.
+                        /// \param count The size of the window, at least one.
+                        void set_max_in_flight_publishes(size_t count);
+
+                        /// Makes the client coalesce outgoing packets, serialising them back to back so that
+                        /// several are sent with a single write to the socket. Publish packets are held back until
+                        /// the batch holds max_bytes or the oldest of them has waited for linger; other packets,
+                        /// such as acknowledgements, are sent right away together with any publishes held back.
+                        /// The linger time is checked each time the client task ticks, i.e. every 50 ms. Should be
+                        /// called before connect_to().
+                        /// \param max_bytes The size of a batch, in bytes. Zero, the default, sends each packet
+                        /// on its own.
+                        /// \param linger How long publishes may wait for more packets to be sent with.
+                        void set_coalescing(size_t max_bytes, std::chrono::milliseconds linger);
+
+                        /// Gets the occupancy of the outgoing queue, see MqttClientOptions.
+                        /// \return The number of messages and bytes queued, and the number of messages dropped.
+                        OutgoingQueueStatus get_outgoing_queue_status();
+
+                        /// Subscribes to a topic. Messages are posted to the application queue.
                         /// \param topic The topic
                         /// \param qos The QoS to use for subscription.
                         void subscribe(const std::string& topic, QoS qos);
 
-                        /// Unsubscribes from a topic.
+                        /// Subscribes to a topic, with messages matching it posted to the given queue instead
+                        /// of the application queue. Messages are matched against the subscribed topics on the
+                        /// MQTT task, in time proportional to the number of levels in the topic; a message
+                        /// matching several subscriptions is posted once to each of their queues.
+                        /// \param topic The topic, possibly with wildcards.
+                        /// \param qos The QoS to use for subscription.
+                        /// \param queue The queue where matching messages will be posted. Must outlive the client.
+                        void subscribe(const std::string& topic, QoS qos, core::ipc::TaskEventQueue<MQTTData>& queue);
+
+                        /// Subscribes to a topic, with messages matching it posted to the given queue as
+                        /// MQTTMessage. Unlike MQTTData, an MQTTMessage holds the packet the message arrived in, so
+                        /// the payload isn't copied on its way to the queue. When several subscriptions with
+                        /// different queues match a message, all but one of the queues get a copy.
+                        /// \param topic The topic, possibly with wildcards.
+                        /// \param qos The QoS to use for subscription.
+                        /// \param queue The queue where matching messages will be posted. Must outlive the client.
+                        void subscribe(const std::string& topic, QoS qos, core::ipc::TaskEventQueue<MQTTMessage>& queue);
+
+                        /// Unsubscribes from a topic. Any messages for it that arrive before the broker has
+                        /// confirmed the unsubscription are posted to the application queue.
                         /// \param topic The topic.
                         void unsubscribe(const std::string& topic);
 
@@ -136,6 +243,11 @@ namespace smooth
                         const std::chrono::seconds get_keep_alive() const override;
                         void start_reconnect() override;
 
+                        void reset_reconnect_backoff() override
+                        {
+                            reconnect_backoff.reset();
+                        }
+
                         void set_keep_alive_timer(std::chrono::seconds interval) override;
 
                         bool is_auto_reconnect() const override
@@ -162,11 +274,26 @@ namespace smooth
                         void tick() override;
 
                         bool send_packet(packet::MQTTPacket& packet) override;
+                        // Puts the batch of coalesced packets into the transmit buffer. Returns true if the batch
+                        // is empty afterwards.
+                        bool flush_batch();
                         void force_disconnect() override;
 
+                        // Most MQTT control packets and telemetry messages are small; staging incoming data lets
+                        // several of them be received with a single read from the socket.
+                        static constexpr int receive_staging_size = 512;
+
                         core::ipc::TaskEventQueue<std::pair<std::string, std::vector<uint8_t>>>& application_queue;
-                        core::network::PacketSendBuffer<packet::MQTTPacket, 5> tx_buffer{};
+                        // A pool of the client's own, sized for its transmit buffer. Packets are allocated when
+                        // first needed and then reused, together with their memory.
+                        core::network::PacketPool<packet::MQTTPacket> tx_pool;
+                        core::network::PooledPacketSendBuffer<packet::MQTTPacket> tx_buffer;
                         core::network::PacketReceiveBuffer<packet::MQTTPacket, 5> rx_buffer{};
+                        packet::PacketBatch batch{};
+                        size_t coalesce_max_bytes = 0;
+                        std::chrono::milliseconds coalesce_linger{0};
+                        // Reused for every received packet so that rx_buffer can recycle its memory.
+                        packet::MQTTPacket received_packet{};
                         core::ipc::TaskEventQueue<core::network::TransmitBufferEmptyEvent> tx_empty;
                         core::ipc::TaskEventQueue<core::network::DataAvailableEvent<packet::MQTTPacket>> data_available;
                         core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent> connection_status;
@@ -178,11 +305,15 @@ namespace smooth
                         std::chrono::seconds keep_alive;
                         std::shared_ptr<smooth::core::network::ISocket> mqtt_socket;
                         std::shared_ptr<core::timer::Timer> reconnect_timer;
+                        smooth::core::network::BackoffPolicy reconnect_backoff{};
+                        bool reconnect_pending = false;
                         std::shared_ptr<core::timer::Timer> keep_alive_timer;
                         smooth::application::network::mqtt::state::MqttFSM<state::MQTTBaseState> fsm;
                         bool auto_reconnect = false;
                         std::shared_ptr<smooth::core::network::InetAddress> address;
-                        Publication publication{};
+                        std::shared_ptr<smooth::core::network::TlsContext> tls_context{};
+                        std::string server_name{};
+                        Publication publication;
                         Subscription subscription{};
                         bool connected = false;
                         std::mutex address_guard{};
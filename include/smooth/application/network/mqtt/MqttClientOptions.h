@@ -0,0 +1,64 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <chrono>
+#include <string>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif // END ESP_PLATFORM
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                /// What MqttClient::publish() does with a message when the outgoing queue is full.
+                enum class OverflowPolicy
+                {
+                    /// The new message is rejected, i.e. publish() returns false.
+                    DropNewest,
+                    /// The oldest messages not yet sent are discarded to make room for the new one. Messages
+                    /// already sent and awaiting acknowledgement are never discarded.
+                    DropOldest,
+                    /// publish() waits for room, for at most MqttClientOptions::block_timeout, and rejects the
+                    /// message if there still is none. Must not be used when publishing from the client's own task.
+                    Block
+                };
+
+                /// Settings for a MqttClient. The defaults match those of a client created without options.
+                class MqttClientOptions
+                {
+                    public:
+                        /// The maximum number of outgoing messages, whether waiting to be sent or for an
+                        /// acknowledgement from the broker.
+                        size_t max_outgoing_messages = CONFIG_SMOOTH_MAX_MQTT_OUTGOING_MESSAGES;
+                        /// The maximum number of bytes held by outgoing messages, counting their encoded packets
+                        /// and any payloads kept in memory. Zero for no limit other than max_outgoing_messages.
+                        size_t max_outgoing_bytes = 0;
+                        /// What to do with a message that doesn't fit in the outgoing queue.
+                        OverflowPolicy overflow_policy = OverflowPolicy::DropNewest;
+                        /// How long publish() waits for room when overflow_policy is Block.
+                        std::chrono::milliseconds block_timeout{1000};
+                        /// The number of packets the transmit buffer of the socket holds. Messages are moved from
+                        /// the outgoing queue into it each time the client task ticks, so this bounds the number
+                        /// of messages sent per tick (per batch when coalescing, see MqttClient::set_coalescing()).
+                        int transmit_buffer_packets = 5;
+                        /// A directory where QoS 1 and 2 messages are kept until the broker has acknowledged them,
+                        /// so that they are sent again after a restart. Empty, the default, keeps messages in
+                        /// memory only. See PublishLog.
+                        std::string persistence_directory{};
+                        /// The size at which the persistence log moves on to a new file.
+                        size_t persistence_segment_size = 16 * 1024;
+                };
+            }
+        }
+    }
+}
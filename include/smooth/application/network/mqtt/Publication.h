@@ -5,8 +5,10 @@
 #pragma once
 
 #include <vector>
+#include <deque>
 #include <chrono>
 #include <mutex>
+#include <condition_variable>
 #include <smooth/core/timer/ElapsedTime.h>
 #include <smooth/application/network/mqtt/packet/PubAck.h>
 #include <smooth/application/network/mqtt/packet/PubComp.h>
@@ -14,6 +16,9 @@
 #include <smooth/application/network/mqtt/packet/PubRec.h>
 #include <smooth/application/network/mqtt/IMqttClient.h>
 #include <smooth/application/network/mqtt/InFlight.h>
+#include <smooth/application/network/mqtt/InFlightTable.h>
+#include <smooth/application/network/mqtt/MqttClientOptions.h>
+#include <smooth/application/network/mqtt/PublishLog.h>
 
 namespace smooth
 {
@@ -23,16 +28,46 @@ namespace smooth
         {
             namespace mqtt
             {
+                /// The occupancy of the outgoing queue of a MqttClient.
+                class OutgoingQueueStatus
+                {
+                    public:
+                        /// Messages waiting to be sent or for an acknowledgement.
+                        size_t messages = 0;
+                        /// Bytes held by those messages, see MqttClientOptions::max_outgoing_bytes.
+                        size_t bytes = 0;
+                        /// Messages rejected or discarded because the queue was full, since the client was created.
+                        uint32_t dropped = 0;
+                };
+
                 class Publication
                 {
                     public:
-                        Publication();
+                        explicit Publication(const MqttClientOptions& options);
 
                         bool
                         publish(const std::string& topic, const uint8_t* data, int length, mqtt::QoS qos, bool retain);
 
+                        bool publish(const std::string& topic, std::vector<uint8_t>&& data, mqtt::QoS qos, bool retain);
+
+                        bool publish(const std::string& topic,
+                                     std::shared_ptr<const smooth::core::network::ExternalPayload> payload,
+                                     mqtt::QoS qos, bool retain);
+
                         void publish_next(IMqttClient& mqtt);
 
+                        /// Writes messages published since the last call to the persistence log, if any.
+                        void persist();
+
+                        OutgoingQueueStatus get_status();
+
+                        /// Sets the maximum number of QoS 1 and 2 messages that may be awaiting acknowledgement
+                        /// from the broker at the same time. With a window of one, each message waits for the
+                        /// previous one to be acknowledged, limiting throughput to one message per round trip.
+                        /// Messages are always sent, and resent, in the order they were published.
+                        /// \param count The size of the window, at least one.
+                        void set_max_in_flight(size_t count);
+
                         void handle_disconnect();
 
                         void resend_outstanding_control_packet(IMqttClient& mqtt, bool clean_session);
@@ -44,8 +79,43 @@ namespace smooth
                         void receive(packet::PubComp& pub_rel, IMqttClient& mqtt);
 
                     private:
-                        std::vector<InFlight<packet::Publish>> in_progress{};
+                        void restore();
+                        bool enqueue(packet::Publish&& packet);
+                        // Applies the overflow policy until there is room for a message of the given size.
+                        // Returns false, counting the message as dropped, if there still isn't.
+                        bool make_room(std::unique_lock<std::mutex>& lock, size_t size);
+                        void add(packet::Publish&& packet);
+                        bool has_room(size_t size) const;
+                        bool send(InFlight<packet::Publish>& flight, IMqttClient& mqtt);
+                        // Sends the PubRel of a QoS 2 message, or marks it as pending if the transmit buffer is full.
+                        bool send_pub_rel(InFlight<packet::Publish>& flight, IMqttClient& mqtt);
+                        // Sends the pending PubRels, in order, for as long as they fit in the transmit buffer.
+                        void send_pending_pub_rels(IMqttClient& mqtt);
+                        void remove_in_flight(uint16_t packet_identifier);
+                        void flush_log();
+                        // Accounts for a message leaving the queue.
+                        void release(packet::Publish& packet);
+                        static size_t get_size(packet::Publish& packet);
+                        // The size of a message with a payload in memory, before the packet is created.
+                        static size_t get_size(const std::string& topic, size_t payload_length, mqtt::QoS qos);
+
+                        // Messages waiting to be sent, in order.
+                        std::deque<InFlight<packet::Publish>> in_progress{};
+                        // Messages sent and awaiting acknowledgement, by packet identifier.
+                        // In the order the timers of the messages were started, so the first one is the one that
+                        // has waited the longest for a reply.
+                        InFlightTable<InFlight<packet::Publish>> in_flight{};
+                        size_t max_in_flight = 1;
+                        // The number of messages in in_flight with a PubRel pending.
+                        size_t pending_pub_rels = 0;
+                        const MqttClientOptions options;
+                        OutgoingQueueStatus status{};
+                        PublishLog log;
+                        // Set while writing to the log fails, so that the failure is only logged once.
+                        bool log_failing = false;
                         std::mutex guard{};
+                        // Signalled when a message leaves the queue.
+                        std::condition_variable room{};
                 };
             }
         }
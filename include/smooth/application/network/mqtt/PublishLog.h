@@ -0,0 +1,172 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <smooth/application/network/mqtt/packet/Publish.h>
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                /// Keeps QoS 1 and 2 messages on persistent storage until the broker has acknowledged them, so
+                /// that they are sent again after a restart. The log is a directory of segment files that are only
+                /// ever appended to, with a record for each message stored, each QoS 2 message received by the
+                /// broker (PUBREC) and each message acknowledged. Records are buffered and written in batches, with
+                /// a single fsync per batch; a message acknowledged before its batch is written is never written at
+                /// all. Segments are deleted oldest first, once they hold only acknowledged messages; an oldest
+                /// segment where little is still outstanding, or that keeps a log of mostly acknowledged messages
+                /// around, is compacted by copying what is left to the current segment. A failed write is retried
+                /// by the next flush(), in a new segment.
+                /// Records refer to their message by a sequence number given when it is stored, as packet
+                /// identifiers are reused once they wrap around.
+                /// On the ESP32 the directory must be on a mounted file system, see core::filesystem::Filesystem.
+                /// Messages with a payload kept in a file are not stored. Not thread-safe.
+                class PublishLog
+                {
+                    public:
+                        class Statistics
+                        {
+                            public:
+                                /// Bytes of messages passed to store().
+                                uint64_t bytes_stored = 0;
+                                /// Bytes written to the segment files, including compaction.
+                                uint64_t bytes_written = 0;
+                                /// Number of writes, each followed by an fsync.
+                                uint32_t batches = 0;
+                                uint32_t segments_deleted = 0;
+                                uint32_t segments_compacted = 0;
+                        };
+
+                        /// A message read back from the log.
+                        class Message
+                        {
+                            public:
+                                packet::Publish packet{};
+                                /// true if the message is of QoS 2 and the broker had sent PUBREC for it.
+                                bool received = false;
+                        };
+
+                        /// Constructor
+                        /// \param directory The directory holding the log, created if it doesn't exist. If empty,
+                        /// the log is disabled and all other methods do nothing.
+                        /// \param segment_size The size at which the log moves on to a new segment file.
+                        PublishLog(std::string directory, size_t segment_size);
+
+                        ~PublishLog();
+
+                        PublishLog(const PublishLog&) = delete;
+                        PublishLog& operator=(const PublishLog&) = delete;
+
+                        bool is_enabled() const
+                        {
+                            return !directory.empty();
+                        }
+
+                        /// Reads the log. Must be called before anything is stored.
+                        /// \param messages Receives the messages not yet acknowledged, in the order they were
+                        /// stored.
+                        void load(std::vector<Message>& messages);
+
+                        /// Adds a message to the next batch.
+                        void store(packet::Publish& packet);
+
+                        /// Records that the broker has received a QoS 2 message.
+                        void received(uint16_t packet_identifier);
+
+                        /// Records that a message has been acknowledged, or is no longer to be sent.
+                        void remove(uint16_t packet_identifier);
+
+                        /// Writes the records added since the last successful call.
+                        /// \return true on success, false if writing failed, in which case the records are kept
+                        /// to be written by the next call.
+                        bool flush();
+
+                        const Statistics& get_statistics() const
+                        {
+                            return stats;
+                        }
+
+                    private:
+                        enum RecordType : uint8_t
+                        {
+                            STORE = 1,
+                            RECEIVED,
+                            REMOVED
+                        };
+
+                        class Record
+                        {
+                            public:
+                                RecordType type;
+                                uint16_t id;
+                                uint32_t sequence;
+                                std::vector<uint8_t> data;
+                                bool cancelled;
+                                // The size of the record in the write buffer, zero if it isn't written.
+                                uint32_t size;
+                        };
+
+                        // Where the latest STORE record of an outstanding message is.
+                        class Entry
+                        {
+                            public:
+                                uint16_t id;
+                                uint32_t segment;
+                                uint32_t size;
+                                bool received;
+                        };
+
+                        class Segment
+                        {
+                            public:
+                                size_t size = 0;
+                                size_t live_size = 0;
+                                uint32_t live_count = 0;
+                        };
+
+                        void append_record(RecordType type, uint16_t id, uint32_t sequence,
+                                           const uint8_t* data, size_t length);
+                        bool refers_to_outstanding(const Record& record) const;
+                        void add_entry(uint32_t sequence, const Entry& entry);
+                        void remove_entry(uint32_t sequence);
+                        std::unordered_map<uint32_t, Entry>::iterator find_entry(uint16_t id);
+                        bool write_buffer();
+                        void compact();
+                        bool copy_live_messages(uint32_t segment);
+                        std::string get_segment_path(uint32_t segment) const;
+
+                        // Calls handler(type, id, sequence, data, length, record_size) for each valid record.
+                        template<typename Handler>
+                        static void parse(const std::vector<uint8_t>& content, Handler handler);
+
+                        std::string directory;
+                        size_t segment_size;
+                        std::vector<Record> pending{};
+                        // Index into pending of the STORE records not yet written, by packet identifier.
+                        std::unordered_map<uint16_t, size_t> pending_stores{};
+                        // The outstanding messages, by sequence number.
+                        std::unordered_map<uint32_t, Entry> entries{};
+                        // The sequence number of the newest outstanding message with each packet identifier, as
+                        // received() and remove() are only given the identifier.
+                        std::unordered_map<uint16_t, uint32_t> sequences{};
+                        std::map<uint32_t, Segment> segments{};
+                        uint32_t current_segment = 0;
+                        uint32_t next_sequence = 0;
+                        std::vector<uint8_t> buffer{};
+                        Statistics stats{};
+                };
+            }
+        }
+    }
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <deque>
 #include <vector>
 #include <unordered_map>
 #include <mutex>
@@ -18,6 +19,8 @@
 #include <smooth/application/network/mqtt/packet/Unsubscribe.h>
 #include <smooth/application/network/mqtt/IMqttClient.h>
 #include <smooth/application/network/mqtt/InFlight.h>
+#include <smooth/application/network/mqtt/InFlightTable.h>
+#include <smooth/application/network/mqtt/TopicRouter.h>
 #include <smooth/application/network/mqtt/Logging.h>
 #include <smooth/core/logging/log.h>
 
@@ -34,7 +37,7 @@ namespace smooth
                 class Subscription
                 {
                     public:
-                        void subscribe(const std::string& topic, QoS qos);
+                        void subscribe(const std::string& topic, QoS qos, const TopicRouter::Destination& queue);
                         void unsubscribe(const std::string& topic);
 
                         void receive(packet::Publish& publish, IMqttClient& mqtt);
@@ -45,10 +48,11 @@ namespace smooth
                         void subscribe_next(IMqttClient& mqtt);
                         void handle_disconnect();
                     private:
-                        void forward_to_application(const packet::Publish& publish, IMqttClient& mqtt);
+                        // Takes over the data of the packet.
+                        void forward_to_application(packet::Publish& publish, IMqttClient& mqtt);
 
                         template<typename T>
-                        bool send_control_packet(std::vector<InFlight<T>>& in_flight, PacketType wait_for, IMqttClient& mqtt, const char* control_type)
+                        bool send_control_packet(std::deque<InFlight<T>>& in_flight, PacketType wait_for, IMqttClient& mqtt, const char* control_type)
                         {
                             bool all_ok = true;
 
@@ -79,7 +83,7 @@ namespace smooth
                         }
 
                         template<typename T>
-                        void reset_control_packet(std::vector<InFlight<T>>& in_flight)
+                        void reset_control_packet(std::deque<InFlight<T>>& in_flight)
                         {
                             auto first = in_flight.begin();
                             if (first != in_flight.end())
@@ -92,10 +96,15 @@ namespace smooth
 
                         void internal_subscribe(const std::string& topic, const QoS& qos);
 
-                        std::unordered_map<uint16_t, InFlight<packet::Publish>> receiving{};
-                        std::vector<InFlight<packet::Subscribe>> subscribing{};
+                        // QoS 2 messages awaiting PubRel, by packet identifier.
+                        InFlightTable<InFlight<packet::Publish>> receiving{};
+                        // Requests are sent one at a time, the first one in each queue being the one in flight.
+                        std::deque<InFlight<packet::Subscribe>> subscribing{};
                         std::unordered_map<std::string, QoS> active_subscription{};
-                        std::vector<InFlight<packet::Unsubscribe>> unsubscribing{};
+                        std::deque<InFlight<packet::Unsubscribe>> unsubscribing{};
+                        TopicRouter router{};
+                        // Kept to avoid allocating on each incoming message.
+                        std::vector<TopicRouter::Destination> matching_queues{};
                         std::mutex guard{};
 
                 };
@@ -0,0 +1,96 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <smooth/core/ipc/TaskEventQueue.h>
+#include <smooth/application/network/mqtt/IMqttClient.h>
+#include <smooth/application/network/mqtt/MQTTMessage.h>
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                /// Keeps track of which queues want the messages of which topic filters, and finds the queues for
+                /// the topic of an incoming message. The filters are kept in a tree with one level of the topic per
+                /// node, so matching a topic takes time in proportion to its number of levels rather than to the
+                /// number of filters. Supports the single-level (+) and multi-level (#) wildcards; as required by
+                /// the MQTT specification, wildcards in the first level don't match topics starting with '$'.
+                /// Not thread-safe.
+                class TopicRouter
+                {
+                    public:
+                        /// A queue messages are routed to, taking messages either as MQTTData or MQTTMessage.
+                        class Destination
+                        {
+                            public:
+                                explicit Destination(core::ipc::TaskEventQueue<MQTTData>& queue)
+                                        : data_queue(&queue)
+                                {
+                                }
+
+                                explicit Destination(core::ipc::TaskEventQueue<MQTTMessage>& queue)
+                                        : message_queue(&queue)
+                                {
+                                }
+
+                                bool operator==(const Destination& other) const
+                                {
+                                    return data_queue == other.data_queue && message_queue == other.message_queue;
+                                }
+
+                                core::ipc::TaskEventQueue<MQTTData>* data_queue = nullptr;
+                                core::ipc::TaskEventQueue<MQTTMessage>* message_queue = nullptr;
+                        };
+
+                        /// Routes messages matching the filter to the queue. A filter may have several queues.
+                        /// \param filter The topic filter, possibly with wildcards.
+                        /// \param queue The queue
+                        void add(const std::string& filter, const Destination& queue);
+
+                        /// Stops routing messages matching the filter, to any queue.
+                        /// \param filter The topic filter, exactly as it was added.
+                        void remove(const std::string& filter);
+
+                        /// Finds the queues for a topic.
+                        /// \param topic The topic of a message.
+                        /// \param length The length of the topic.
+                        /// \param matches Receives the queues, each listed once even if several filters match.
+                        void match(const char* topic, size_t length, std::vector<Destination>& matches) const;
+
+                        bool empty() const
+                        {
+                            return root.children.empty() && root.queues.empty();
+                        }
+
+                    private:
+                        class Node
+                        {
+                            public:
+                                std::unordered_map<std::string, std::unique_ptr<Node>> children{};
+                                std::vector<Destination> queues{};
+                        };
+
+                        void match(const Node& node, const char* topic, size_t length, size_t pos,
+                                   std::vector<Destination>& matches) const;
+
+                        // Returns true if the node no longer holds anything and can be removed.
+                        bool remove(Node& node, const std::string& filter, size_t pos);
+
+                        static void add_matches(const Node& node, std::vector<Destination>& matches);
+
+                        Node root{};
+                };
+            }
+        }
+    }
+}
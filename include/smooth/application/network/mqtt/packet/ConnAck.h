@@ -34,6 +34,10 @@ namespace smooth
                             {
                             }
 
+                            explicit ConnAck(MQTTPacket&& packet) : MQTTPacket(std::move(packet))
+                            {
+                            }
+
                             bool is_session_present()
                             {
                                 core::util::ByteSet b(*get_variable_header_start());
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <vector>
 #include <smooth/core/util/ByteSet.h>
 #include <smooth/core/network/IPacketAssembly.h>
@@ -30,6 +31,8 @@ namespace smooth
                             MQTTPacket() = default;
                             MQTTPacket& operator=(const MQTTPacket&) = default;
                             MQTTPacket(const MQTTPacket& other) = default;
+                            MQTTPacket& operator=(MQTTPacket&&) = default;
+                            MQTTPacket(MQTTPacket&& other) = default;
 
                             // Must return the number of bytes the packet wants to fill
                             // its internal buffer, e.g. header, checksum etc. Returned
@@ -55,10 +58,22 @@ namespace smooth
                             // based on received data.
                             bool is_error() override;
 
+                            // Assembles the packet straight from the staging buffer: the fixed header is parsed
+                            // where it lies and the rest of the packet is copied in one go.
+                            int consume(const uint8_t* data, int length) override;
+
+                            // Resets the packet for assembly of a new one, keeping the capacity of its buffer.
+                            bool prepare_for_reuse() override;
+
                             // Must return the total amount of bytes to send
                             int get_send_length() override;
                             // Must return a pointer to the data to be sent.
                             const uint8_t* get_data() override;
+                            // Returns the part of the payload that is sent from outside the packet, if any.
+                            std::shared_ptr<const core::network::ExternalPayload> get_external_payload() override
+                            {
+                                return external_payload;
+                            }
 
                             bool is_too_big() const;
 
@@ -104,9 +119,14 @@ namespace smooth
 
                             long get_payload_length() const;
 
+                            uint16_t read_msb_lsb(std::vector<uint8_t>::const_iterator pos) const
+                            {
+                                return static_cast<uint16_t>(*pos << 8 | *(pos + 1));
+                            }
+
                             uint16_t read_packet_identifier(std::vector<uint8_t>::const_iterator pos) const
                             {
-                                return *pos << 8 | *(pos + 1);
+                                return read_msb_lsb(pos);
                             }
 
                             void set_header(PacketType type, QoS qos, bool dup, bool retain);
@@ -117,10 +137,16 @@ namespace smooth
                             void append_string(const std::string& str, std::vector<uint8_t>& target);
                             void append_msb_lsb(uint16_t value, std::vector<uint8_t>& target);
                             void append_data(const uint8_t* data, int length, std::vector<uint8_t>& target);
-                            void apply_constructed_data(const std::vector<uint8_t>& variable);
+                            // external_payload_length is the length of data sent after the packet via
+                            // external_payload, which is included in the encoded remaining length.
+                            void apply_constructed_data(const std::vector<uint8_t>& variable,
+                                                        int external_payload_length = 0);
 
                             std::vector<uint8_t> packet{};
-                            int calculate_remaining_length_and_variable_header_offset() const;
+                            std::shared_ptr<const core::network::ExternalPayload> external_payload{};
+                            // Parses the remaining length and the start of the variable header. Called once the
+                            // fixed header has been received or constructed; accessors rely on the stored offset.
+                            int calculate_remaining_length_and_variable_header_offset();
                             std::string get_string(std::vector<uint8_t>::const_iterator offset) const;
 
                             std::vector<uint8_t>::const_iterator get_variable_header_start() const
@@ -136,12 +162,17 @@ namespace smooth
                                 REMAINING_LENGTH,
                                 DATA
                             };
-                            mutable long variable_header_start_ix = 0;
+                            long variable_header_start_ix = 0;
+                            // Type and remaining length, the latter at most four bytes.
+                            std::array<uint8_t, 5> fixed_header{};
+                            // Called once the whole fixed header is in fixed_header.
+                            void header_received();
+
                             ReadingHeaderSection state = ReadingHeaderSection::START;
                             int bytes_received = 0;
                             int remaining_bytes_to_read = 1;
                             int received_header_length = 0;
-                            mutable bool error = false;
+                            bool error = false;
                             bool too_big = false;
                     };
                 }
@@ -0,0 +1,72 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <chrono>
+#include <smooth/core/timer/ElapsedTime.h>
+#include <smooth/application/network/mqtt/packet/MQTTPacket.h>
+
+namespace smooth
+{
+    namespace application
+    {
+        namespace network
+        {
+            namespace mqtt
+            {
+                namespace packet
+                {
+                    // Several outgoing packets serialised back to back, so that they can be put into the
+                    // transmit buffer as one and sent with a single write. Payloads kept in memory are copied
+                    // into the batch; a payload kept in a file, or one too large for the batch, is sent from
+                    // where it is and ends the batch.
+                    class PacketBatch
+                            : private MQTTPacket
+                    {
+                        public:
+                            // The batched packets as a single packet, to put into the transmit buffer. Moving from
+                            // it hands over the storage of the batch; clear() the batch before appending again.
+                            MQTTPacket& to_packet()
+                            {
+                                return *this;
+                            }
+
+                            // Appends the item, unless doing so would make the batch larger than max_size.
+                            // An empty batch takes any packet.
+                            bool append(MQTTPacket& item, size_t max_size);
+
+                            // Returns true when no more packets should be added.
+                            bool is_full(size_t max_size) const
+                            {
+                                return external_payload || packet.size() >= max_size;
+                            }
+
+                            bool is_empty() const
+                            {
+                                return count == 0;
+                            }
+
+                            int get_packet_count() const
+                            {
+                                return count;
+                            }
+
+                            // Time since the first packet was appended.
+                            std::chrono::microseconds get_age() const
+                            {
+                                return age.get_running_time();
+                            }
+
+                            void clear();
+
+                        private:
+                            core::timer::ElapsedTime age{};
+                            int count = 0;
+                    };
+                }
+            }
+        }
+    }
+}
@@ -4,7 +4,6 @@
 
 #pragma once
 
-#include <memory>
 #include <smooth/application/network/mqtt/packet/MQTTPacket.h>
 
 namespace smooth
@@ -20,7 +19,15 @@ namespace smooth
                     class PacketDecoder
                     {
                         public:
-                            std::unique_ptr<MQTTPacket> decode_packet(const MQTTPacket& packet);
+                            // Decodes the packet and passes it to the receiver. The packet is decoded in place,
+                            // as a typed view over its own buffer, so nothing is allocated or copied. The receiver
+                            // may move data out of the packet, e.g. the payload of a Publish.
+                            // Returns true if the packet was valid and passed to the receiver.
+                            bool decode_packet(MQTTPacket& packet, IPacketReceiver& receiver);
+
+                        private:
+                            template<typename T>
+                            bool dispatch(MQTTPacket& packet, IPacketReceiver& receiver);
                     };
                 }
             }
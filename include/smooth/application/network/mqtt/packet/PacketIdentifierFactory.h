@@ -27,6 +27,15 @@ namespace smooth
                                 return ++id;
 
                             }
+
+                            // Makes the identifiers handed out from now on follow one already in use, e.g. by the
+                            // newest message restored from storage. The identifiers wrap around, so the newest
+                            // isn't necessarily the largest one.
+                            static void advance_past(uint16_t used)
+                            {
+                                std::lock_guard<std::mutex> lock(guard);
+                                id = used;
+                            }
                         private:
                             static std::mutex guard;
                             static uint16_t id;
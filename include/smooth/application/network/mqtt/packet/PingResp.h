@@ -26,6 +26,10 @@ namespace smooth
                             {
                             }
 
+                            explicit PingResp(MQTTPacket&& packet) : MQTTPacket(std::move(packet))
+                            {
+                            }
+
                             void visit( IPacketReceiver& receiver ) override;
                     };
                 }
@@ -34,6 +34,10 @@ namespace smooth
                             {
                             }
 
+                            explicit PubAck(MQTTPacket&& packet) : MQTTPacket(std::move(packet))
+                            {
+                            }
+
                             void visit( IPacketReceiver& receiver ) override;
 
                             uint16_t get_packet_identifier() const override
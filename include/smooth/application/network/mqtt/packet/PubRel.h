@@ -26,6 +26,10 @@ namespace smooth
                             {
                             }
 
+                            explicit PubRel(MQTTPacket&& packet) : MQTTPacket(std::move(packet))
+                            {
+                            }
+
                             explicit PubRel(uint16_t packet_id)
                             {
                                 // Set fixed header
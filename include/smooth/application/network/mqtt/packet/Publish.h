@@ -28,8 +28,26 @@ namespace smooth
                             {
                             }
 
+                            explicit Publish(MQTTPacket&& packet) : MQTTPacket(std::move(packet))
+                            {
+                            }
+
                             Publish(const std::string& topic, const uint8_t* data, int length, QoS qos, bool retain);
 
+                            // Creates a Publish that takes over the payload, which is then sent from where it is
+                            // without being copied into the packet.
+                            Publish(const std::string& topic, std::vector<uint8_t>&& payload, QoS qos, bool retain);
+
+                            // Creates a Publish whose payload is sent directly from where it is kept, without being
+                            // copied into the packet. The payload must not change until the packet has been sent,
+                            // including any resends. get_payload_cbegin() etc. only cover data inside the packet.
+                            Publish(const std::string& topic,
+                                    std::shared_ptr<const core::network::ExternalPayload> payload,
+                                    QoS qos, bool retain);
+
+                            // Creates a Publish from the data of one previously created, e.g. read back from storage.
+                            explicit Publish(std::vector<uint8_t>&& encoded);
+
                             void visit(IPacketReceiver& receiver) override;
 
                             uint16_t get_packet_identifier() const override
@@ -37,7 +55,6 @@ namespace smooth
                                 uint16_t id = 0;
                                 if (has_packet_identifier())
                                 {
-                                    calculate_remaining_length_and_variable_header_offset();
                                     auto pos = get_variable_header_start() + get_variable_header_length() - 2;
                                     id = read_packet_identifier(pos);
                                 }
@@ -46,6 +63,32 @@ namespace smooth
 
                             std::string get_topic() const;
 
+                            // The topic as it is stored in the packet, i.e. not null-terminated. Valid for as long
+                            // as the packet is.
+                            const char* get_topic_data() const
+                            {
+                                auto start = std::distance(packet.cbegin(), get_variable_header_start());
+                                return reinterpret_cast<const char*>(packet.data() + start + 2);
+                            }
+
+                            uint16_t get_topic_length() const
+                            {
+                                return static_cast<uint16_t>(std::max(get_variable_header_length() - 2
+                                                                      - (has_packet_identifier() ? 2 : 0), 0));
+                            }
+
+                            // The payload as it is stored in the packet, valid for as long as the packet is.
+                            const uint8_t* get_payload_data() const
+                            {
+                                return packet.data() + std::distance(packet.cbegin(), get_payload_cbegin());
+                            }
+
+                            using MQTTPacket::get_payload_length;
+
+                            // Moves the payload out of the packet, reusing the memory of the packet; the header is
+                            // removed by moving the payload to the front. The packet is empty afterwards.
+                            std::vector<uint8_t> take_payload();
+
                             std::vector<uint8_t>::const_iterator get_payload_cbegin() const override
                             {
                                 return get_variable_header_start() + get_variable_header_length();
@@ -70,6 +113,13 @@ namespace smooth
                             }
 
                             int get_variable_header_length() const override;
+
+                        private:
+                            // Writes the fixed header, topic and packet identifier, with room reserved for a payload
+                            // of payload_length bytes that the caller appends. external_payload_length is the length of
+                            // any external payload.
+                            void encode(const std::string& topic, QoS qos, bool retain, int payload_length,
+                                        int external_payload_length);
                     };
                 }
             }
@@ -26,6 +26,10 @@ namespace smooth
                             {
                             }
 
+                            explicit SubAck(MQTTPacket&& packet) : MQTTPacket(std::move(packet))
+                            {
+                            }
+
                             void visit(IPacketReceiver& receiver) override;
 
                             uint16_t get_packet_identifier() const override
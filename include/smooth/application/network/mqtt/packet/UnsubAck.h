@@ -24,6 +24,10 @@ namespace smooth
                             {
                             }
 
+                            explicit UnsubAck(MQTTPacket&& packet) : MQTTPacket(std::move(packet))
+                            {
+                            }
+
                             uint16_t get_packet_identifier() const override
                             {
                                 return read_packet_identifier(get_variable_header_start());
@@ -50,7 +50,7 @@ namespace smooth
                             void event(const core::network::ConnectionStatusEvent& event) override;
                             void event(const core::timer::TimerExpiredEvent& event) override;
 
-                            void packet_received(const packet::MQTTPacket& packet);
+                            void packet_received(packet::MQTTPacket& packet);
 
                             mqtt::IMqttClient& get_mqtt() const
                             {
@@ -93,16 +93,12 @@ namespace smooth
                     }
 
                     template<typename BaseState>
-                    void MqttFSM<BaseState>::packet_received(const packet::MQTTPacket& packet)
+                    void MqttFSM<BaseState>::packet_received(packet::MQTTPacket& packet)
                     {
                         if (this->get_state() != nullptr)
                         {
                             // Decode the message and forward it to the state
-                            auto p = decoder.decode_packet(packet);
-                            if( p )
-                            {
-                                p->visit(*this->get_state());
-                            }
+                            decoder.decode_packet(packet, *this->get_state());
                         }
                     }
 
@@ -31,6 +31,23 @@ namespace smooth
                     /// \param length The length
                     /// \return true on success, false on failure
                     bool write(const uint8_t* data, size_t length) const ;
+
+                    /// Appends the provided data to the file, creating it if it doesn't exist, and waits
+                    /// for the data to be written to the storage device.
+                    /// \param data The data
+                    /// \param length The length
+                    /// \return true on success, false on failure
+                    bool append(const uint8_t* data, size_t length) const;
+
+                    /// Deletes the file.
+                    /// \return true on success, false on failure
+                    bool remove() const;
+
+                    /// Waits for the entries of a directory, such as that of a newly created file, to be written
+                    /// to the storage device.
+                    /// \param directory The full path of the directory.
+                    /// \return true on success, false on failure
+                    static bool sync_directory(const std::string& directory);
                 private:
                     std::string name;
             };
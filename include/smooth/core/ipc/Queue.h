@@ -23,7 +23,7 @@ namespace smooth
             /// Please note that this implementation supports actual C++ objects as opposed to the FreeRTOS
             /// plain data-only queues. This means that you can place any type of C++ object on these queues
             /// as long as the objects are copyable (the default copy constructor and assignment operator are enough)
-            /// Items are placed on the queue by copy, not by reference.
+            /// Items are placed on the queue by copy, not by reference, unless moved onto it.
             /// \tparam T The type of object to hold in the queue.
             template<typename T>
             class Queue
@@ -78,8 +78,24 @@ namespace smooth
                         return res;
                     }
 
+                    /// Pushes an item into the queue
+                    /// \param item The item, which is moved onto the queue.
+                    /// \return true if the queue could accept the item, otherwise false. If false, item is left as is.
+                    bool push(T&& item)
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+
+                        bool res = items.size() < queue_size;
+                        if (res)
+                        {
+                            items.push_back(std::move(item));
+                        }
+
+                        return res;
+                    }
+
                     /// Pops an item off the queue.
-                    /// \param target A reference to an instance of T which will be assigned the item taken from the queue.
+                    /// \param target A reference to an instance of T to which the item taken from the queue will be moved.
                     /// \return true if an item could be received, otherwise false.
                     bool pop(T& target)
                     {
@@ -88,7 +104,7 @@ namespace smooth
                         bool res = items.size() > 0;
                         if (res)
                         {
-                            target = items.front();
+                            target = std::move(items.front());
                             items.erase(items.begin());
                         }
 
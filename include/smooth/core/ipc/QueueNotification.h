@@ -5,7 +5,7 @@
 #pragma once
 
 #include <chrono>
-#include <queue>
+#include <vector>
 #include <mutex>
 #include <algorithm>
 #include "QueueNotification.h"
@@ -32,14 +32,20 @@ namespace smooth
                     void clear()
                     {
                         std::lock_guard<std::mutex> lock(guard);
-                        while(queues.size())
-                        {
-                            queues.pop();
-                        }
+                        head = 0;
+                        count = 0;
                     }
 
                 private:
-                    std::queue<ITaskEventQueue*> queues{};
+                    void push(ITaskEventQueue* queue);
+                    ITaskEventQueue* pop();
+
+                    // A ring buffer rather than a std::queue, which allocates and frees blocks as notifications
+                    // pass through it. The ring only grows until it can hold a notification for every item the
+                    // queues of the task can hold.
+                    std::vector<ITaskEventQueue*> queues{};
+                    size_t head = 0;
+                    size_t count = 0;
                     std::mutex guard{};
                     std::condition_variable cond{};
             };
@@ -57,6 +57,19 @@ namespace smooth
                         return res;
                     }
 
+                    /// Pushes an item into the queue
+                    /// \param item The item, which is moved onto the queue.
+                    /// \return true if the queue could accept the item, otherwise false. If false, item is left as is.
+                    bool push(T&& item)
+                    {
+                        auto res = queue.push(std::move(item));
+                        if(res)
+                        {
+                            notification->notify(this);
+                        }
+                        return res;
+                    }
+
                     /// Gets the size of the queue.
                     /// \return number of items the queue can hold.
                     int size() override
@@ -0,0 +1,64 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// Computes the delays between repeated connection attempts. The delay grows exponentially with
+            /// each attempt, up to a maximum, and is randomized so that many clients that lost their connection
+            /// at the same time, e.g. because the server restarted, don't all retry at the same time.
+            /// Not thread-safe.
+            class BackoffPolicy
+            {
+                public:
+                    /// Constructor
+                    /// \param initial_delay The delay before the first retry.
+                    /// \param max_delay The delay never grows beyond this value.
+                    /// \param multiplier The factor the delay grows with on each attempt, >= 1.
+                    /// \param jitter The fraction of each delay that is random, from 0 (none) to 1 (anything
+                    /// between zero and the full delay).
+                    explicit BackoffPolicy(std::chrono::milliseconds initial_delay = std::chrono::seconds(1),
+                                           std::chrono::milliseconds max_delay = std::chrono::seconds(60),
+                                           double multiplier = 2.0,
+                                           double jitter = 0.5);
+
+                    /// Gets the delay to wait before the next attempt and advances to the next step.
+                    /// \return The delay
+                    std::chrono::milliseconds next_delay();
+
+                    /// Starts over from the initial delay, to be called once a connection has succeeded.
+                    void reset()
+                    {
+                        attempts = 0;
+                        current = initial_delay;
+                    }
+
+                    /// Gets the number of delays handed out since construction or the last reset().
+                    /// \return Number of attempts
+                    uint32_t get_attempts() const
+                    {
+                        return attempts;
+                    }
+
+                private:
+                    std::chrono::milliseconds initial_delay;
+                    std::chrono::milliseconds max_delay;
+                    double multiplier;
+                    double jitter;
+                    std::chrono::milliseconds current;
+                    uint32_t attempts = 0;
+                    std::minstd_rand random;
+            };
+        }
+    }
+}
@@ -0,0 +1,844 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <sys/socket.h>
+#include "InetAddress.h"
+#include "ISocket.h"
+#include "DnsResolver.h"
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <smooth/core/ipc/TaskEventQueue.h>
+#include <smooth/core/network/TransmitBufferEmptyEvent.h>
+#include <smooth/core/network/DataAvailableEvent.h>
+#include <smooth/core/network/IPacketSendBuffer.h>
+#include <smooth/core/network/IPacketReceiveBuffer.h>
+#include <smooth/core/network/SocketDispatcher.h>
+#include <smooth/core/network/ConnectionStatusEvent.h>
+#include <smooth/core/logging/log.h>
+
+#ifndef ESP_PLATFORM
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#endif
+
+#if defined(__linux__) && !defined(ESP_PLATFORM)
+// Batched receive and send of datagrams via recvmmsg() and sendmmsg()
+#define SMOOTH_HAS_MMSG
+#endif
+
+using namespace smooth::core::logging;
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// DatagramSocket is used to perform UDP communication with a single remote endpoint.
+            /// Each datagram carries exactly one packet; incoming datagrams are assembled via IPacketAssembly
+            /// and outgoing packets are sent as one datagram each via IPacketDisassembly. Events are delivered
+            /// on the same queues, and in the same way, as for Socket<Packet>. On Linux, datagrams are
+            /// received and sent in batches using recvmmsg() and sendmmsg().
+            /// \tparam Packet The type of the packet used for communication on this socket
+            template<typename Packet>
+            class DatagramSocket
+                    : public ISocket, public std::enable_shared_from_this<ISocket>
+            {
+                public:
+                    friend class smooth::core::network::SocketDispatcher;
+
+                    /// Creates a socket for datagram communication, with the specified packet type.
+                    /// \param tx_buffer The transmit buffer where outgoing packets are put by the application.
+                    /// \param rx_buffer The receive buffer used when receiving data
+                    /// \param tx_empty The response queue onto which events are put when all outgoing packets are sent.
+                    /// These events are forwarded to the application via the response method.
+                    /// \param data_available The response queue onto which events are put when data is available. These
+                    /// These events are forwarded to the application via the response method.
+                    /// \param connection_status The response queue into which events are put when a change in the connection
+                    /// state is detected. These events are forwarded to the application via the response method.
+                    /// \param max_datagram_size The size of the largest datagram that can be sent or received.
+                    /// Larger incoming datagrams are truncated and discarded, larger outgoing packets are discarded.
+                    /// \param batch_size The maximum number of datagrams received or sent in one go.
+                    /// \return a std::shared_ptr pointing to an instance of a ISocket object, or nullptr if no socket could be
+                    /// created.
+                    static std::shared_ptr<ISocket>
+                    create(IPacketSendBuffer<Packet>& tx_buffer, IPacketReceiveBuffer<Packet>& rx_buffer,
+                           smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                           smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                           smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                           int max_datagram_size = 1472,
+                           int batch_size = 8);
+
+                    virtual ~DatagramSocket()
+                    {
+                        log("Destructing");
+                    }
+
+                    bool start(std::shared_ptr<InetAddress> ip) override;
+                    void stop() override;
+                    bool restart() override;
+
+                    bool is_active() override;
+
+                    void readable() override;
+
+                    void writable() override;
+
+                protected:
+                    DatagramSocket(IPacketSendBuffer<Packet>& tx_buffer, IPacketReceiveBuffer<Packet>& rx_buffer,
+                                   smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                                   smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                                   smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                                   int max_datagram_size,
+                                   int batch_size);
+
+                    virtual bool create_socket();
+
+                    int get_socket_id() override
+                    {
+                        return socket_id;
+                    }
+
+                    bool has_send_expired() const override
+                    {
+                        // Datagrams are either sent or dropped, never left half-sent.
+                        return false;
+                    }
+
+                    std::chrono::milliseconds get_send_time_left() const override
+                    {
+                        return std::chrono::milliseconds::max();
+                    }
+
+                    IPacketSendBuffer<Packet>& tx_buffer;
+                    IPacketReceiveBuffer<Packet>& rx_buffer;
+                    smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available;
+                    smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty;
+
+                private:
+                    bool internal_start() override;
+
+                    bool is_connected() override
+                    {
+                        return connected;
+                    }
+
+                    bool set_non_blocking();
+
+                    void resolved(uint32_t request, const AddressList& resolved_addresses);
+
+                    int get_alternate_socket_id() override
+                    {
+                        return -1;
+                    }
+
+                    bool check_connection_attempts() override
+                    {
+                        // There is no connection to establish.
+                        return false;
+                    }
+
+                    SocketStatistics& get_statistics() override
+                    {
+                        return statistics;
+                    }
+
+                    bool has_data_to_transmit() override
+                    {
+                        return connected && (tx_count > 0 || !tx_buffer.is_empty());
+                    }
+
+                    bool has_staged_input() override
+                    {
+                        return started && rx_count > 0;
+                    }
+
+                    bool has_pending_input() override
+                    {
+                        // Received datagrams that couldn't be assembled because the receive buffer was full.
+                        return has_staged_input() && !rx_buffer.is_full();
+                    }
+
+                    int receive_datagrams();
+                    void assemble_datagrams();
+                    void fill_send_batch();
+                    int send_datagrams();
+
+                    uint8_t* rx_slot(int ix)
+                    {
+                        return &rx_data[static_cast<size_t>(ix) * static_cast<size_t>(max_datagram_size)];
+                    }
+
+                    uint8_t* tx_slot(int ix)
+                    {
+                        return &tx_data[static_cast<size_t>(ix) * static_cast<size_t>(max_datagram_size)];
+                    }
+
+                    void log(const char* message);
+                    void loge(const char* message);
+
+                    void publish_connected_status() override;
+                    void stop_internal() override;
+                    void clear_socket_id() override;
+
+                    int socket_id = -1;
+                    std::shared_ptr<InetAddress> ip;
+                    bool started = false;
+                    bool connected = false;
+                    smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status;
+                    std::mutex address_guard{};
+                    // The address actually connected to; the first one a HostName resolves to.
+                    std::shared_ptr<InetAddress> remote{};
+                    uint32_t resolve_request = 0;
+#ifdef ESP_PLATFORM
+                    // lwip doesn't signal SIGPIPE
+                    const int SEND_FLAGS = 0;
+#else
+                    // Disable SIGPIPE during send()-calls.
+                    const int SEND_FLAGS = MSG_NOSIGNAL;
+#endif
+                    const int max_datagram_size;
+                    const int batch_size;
+
+                    // Received datagrams, one per slot. rx_ix is the next one to assemble.
+                    std::vector<uint8_t> rx_data;
+                    std::vector<int> rx_length;
+                    int rx_ix = 0;
+                    int rx_count = 0;
+
+                    // Datagrams waiting to be sent, one per slot. tx_ix is the next one to send.
+                    std::vector<uint8_t> tx_data;
+                    std::vector<int> tx_length;
+                    int tx_ix = 0;
+                    int tx_count = 0;
+
+                    SocketStatistics statistics{};
+                    bool reported_connected = false;
+
+#ifdef SMOOTH_HAS_MMSG
+                    std::vector<mmsghdr> messages;
+                    std::vector<iovec> vectors;
+#endif
+            };
+
+
+            template<typename Packet>
+            std::shared_ptr<ISocket> DatagramSocket<Packet>::create(IPacketSendBuffer<Packet>& tx_buffer,
+                                                                    IPacketReceiveBuffer<Packet>& rx_buffer,
+                                                                    smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                                                                    smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                                                                    smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                                                                    int max_datagram_size,
+                                                                    int batch_size)
+            {
+                // This class is solely used to enabled access to the protected DatagramSocket<Packet> constructor from std::make_shared<>
+                class MakeSharedActivator
+                        : public DatagramSocket<Packet>
+                {
+                    public:
+                        MakeSharedActivator(IPacketSendBuffer<Packet>& tx_buffer,
+                                            IPacketReceiveBuffer<Packet>& rx_buffer,
+                                            smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                                            smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                                            smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                                            int max_datagram_size,
+                                            int batch_size)
+                                : DatagramSocket<Packet>(tx_buffer, rx_buffer, tx_empty, data_available, connection_status,
+                                                         max_datagram_size, batch_size)
+                        {
+                        }
+
+                };
+
+                std::shared_ptr<ISocket> s;
+
+                if (max_datagram_size > 0 && batch_size > 0)
+                {
+                    s = std::make_shared<MakeSharedActivator>(tx_buffer,
+                                                              rx_buffer,
+                                                              tx_empty,
+                                                              data_available,
+                                                              connection_status,
+                                                              max_datagram_size,
+                                                              batch_size);
+                }
+
+                return s;
+            }
+
+            template<typename Packet>
+            DatagramSocket<Packet>::DatagramSocket(IPacketSendBuffer<Packet>& tx_buffer,
+                                                   IPacketReceiveBuffer<Packet>& rx_buffer,
+                                                   smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                                                   smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                                                   smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                                                   int max_datagram_size,
+                                                   int batch_size
+            )
+                    :
+                    tx_buffer(tx_buffer),
+                    rx_buffer(rx_buffer),
+                    data_available(data_available),
+                    tx_empty(tx_empty),
+                    connection_status(connection_status),
+                    max_datagram_size(max_datagram_size),
+                    batch_size(batch_size),
+                    rx_data(static_cast<size_t>(max_datagram_size) * static_cast<size_t>(batch_size)),
+                    rx_length(static_cast<size_t>(batch_size)),
+                    tx_data(static_cast<size_t>(max_datagram_size) * static_cast<size_t>(batch_size)),
+                    tx_length(static_cast<size_t>(batch_size))
+#ifdef SMOOTH_HAS_MMSG
+                    , messages(static_cast<size_t>(batch_size)),
+                    vectors(static_cast<size_t>(batch_size))
+#endif
+            {
+            }
+
+            template<typename Packet>
+            bool DatagramSocket<Packet>::start(std::shared_ptr<InetAddress> ip)
+            {
+                bool res = false;
+                if (!started)
+                {
+                    this->ip = ip;
+                    res = ip->is_valid();
+                    if (res)
+                    {
+                        uint32_t request;
+                        {
+                            std::lock_guard<std::mutex> lock(address_guard);
+                            request = ++resolve_request;
+                            remote.reset();
+                        }
+
+                        if (ip->is_resolved())
+                        {
+                            resolved(request, AddressList{ip});
+                        }
+                        else
+                        {
+                            std::weak_ptr<ISocket> self = shared_from_this();
+                            DnsResolver::instance().resolve(ip->get_ip_as_string(),
+                                                            static_cast<uint16_t>(ip->get_port()),
+                                                            [self, request](const AddressList& resolved_addresses)
+                                                            {
+                                                                auto s = self.lock();
+                                                                if (s)
+                                                                {
+                                                                    std::static_pointer_cast<DatagramSocket<Packet>>(s)
+                                                                            ->resolved(request, resolved_addresses);
+                                                                }
+                                                            });
+                        }
+                    }
+                }
+
+                return res;
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::resolved(uint32_t request, const AddressList& resolved_addresses)
+            {
+                bool current;
+                {
+                    std::lock_guard<std::mutex> lock(address_guard);
+                    current = request == resolve_request;
+                    if (current && !resolved_addresses.empty())
+                    {
+                        remote = resolved_addresses.front();
+                    }
+                }
+
+                if (current)
+                {
+                    SocketDispatcher::instance().perform_op(SocketOperation::Op::Start, shared_from_this());
+                }
+            }
+
+            template<typename Packet>
+            bool DatagramSocket<Packet>::restart()
+            {
+                stop();
+                return start(ip);
+            }
+
+            template<typename Packet>
+            bool DatagramSocket<Packet>::create_socket()
+            {
+                bool res = false;
+
+                if (socket_id < 0)
+                {
+                    socket_id = socket(remote->get_protocol_family(), SOCK_DGRAM, 0);
+
+                    if (socket_id == -1)
+                    {
+                        loge("Failed to create socket");
+                    }
+                    else
+                    {
+                        res = set_non_blocking();
+                        if (res)
+                        {
+                            log("Created socket");
+                        }
+                    }
+                }
+                else
+                {
+                    res = true;
+                }
+
+                return res;
+            }
+
+            template<typename Packet>
+            bool DatagramSocket<Packet>::set_non_blocking()
+            {
+                bool res = true;
+
+                auto opts = fcntl(socket_id, F_GETFL, 0);
+                if (opts < 0)
+                {
+                    loge("Could not get socket flags");
+                    res = false;
+                }
+                else if (fcntl(socket_id, F_SETFL, opts | O_NONBLOCK) < 0)
+                {
+                    loge("Could not set non blocking flag");
+                    res = false;
+                }
+
+                return res;
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::readable()
+            {
+                if (started)
+                {
+                    // Finish any datagrams left from the previous round before receiving new ones.
+                    assemble_datagrams();
+
+                    if (started && rx_count == 0 && !rx_buffer.is_full())
+                    {
+                        rx_ix = 0;
+                        rx_count = receive_datagrams();
+                        assemble_datagrams();
+                    }
+                }
+            }
+
+            template<typename Packet>
+            int DatagramSocket<Packet>::receive_datagrams()
+            {
+                int received = 0;
+                errno = 0;
+
+#ifdef SMOOTH_HAS_MMSG
+                for (int i = 0; i < batch_size; ++i)
+                {
+                    vectors[i].iov_base = rx_slot(i);
+                    vectors[i].iov_len = static_cast<size_t>(max_datagram_size);
+                    memset(&messages[i], 0, sizeof(mmsghdr));
+                    messages[i].msg_hdr.msg_iov = &vectors[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                }
+
+                auto res = recvmmsg(socket_id, messages.data(), static_cast<unsigned int>(batch_size), MSG_DONTWAIT,
+                                    nullptr);
+
+                if (res > 0)
+                {
+                    received = res;
+                    for (int i = 0; i < received; ++i)
+                    {
+                        bool truncated = (messages[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+                        rx_length[i] = truncated ? -1 : static_cast<int>(messages[i].msg_len);
+                    }
+                }
+#else
+                bool done = false;
+                while (!done && received < batch_size)
+                {
+                    auto res = recv(socket_id, rx_slot(received), static_cast<size_t>(max_datagram_size), 0);
+                    if (res >= 0)
+                    {
+                        rx_length[received] = static_cast<int>(res);
+                        ++received;
+                    }
+                    else
+                    {
+                        done = true;
+                    }
+                }
+
+                if (received > 0)
+                {
+                    // Only the first failed recv() matters, and only if nothing was received.
+                    errno = 0;
+                }
+#endif
+
+                if (received == 0 && errno != 0 && errno != EWOULDBLOCK && errno != EAGAIN)
+                {
+                    if (errno == ECONNREFUSED)
+                    {
+                        // ICMP port unreachable from a previous send; the remote end may come back.
+                        log("Connection refused");
+                    }
+                    else
+                    {
+                        loge("Error during receive");
+                        stop();
+                    }
+                }
+
+                return received;
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::assemble_datagrams()
+            {
+                while (started && rx_count > 0 && !rx_buffer.is_full())
+                {
+                    auto length = rx_length[rx_ix];
+
+                    if (length < 0)
+                    {
+                        log("Datagram larger than max_datagram_size discarded");
+                    }
+                    else
+                    {
+                        auto consumed = rx_buffer.consume(rx_slot(rx_ix), length);
+                        statistics.bytes_received += static_cast<uint64_t>(length);
+
+                        if (rx_buffer.is_packet_complete())
+                        {
+                            ++statistics.packets_received;
+
+                            if (consumed != length)
+                            {
+                                log("Datagram holds more data than the packet");
+                            }
+
+                            DataAvailableEvent<Packet> d(&rx_buffer);
+                            data_available.push(d);
+                        }
+                        else if (rx_buffer.is_error())
+                        {
+                            log("Assembly error");
+                        }
+                        else
+                        {
+                            log("Datagram holds an incomplete packet");
+                        }
+                    }
+
+                    // A packet never spans datagrams, so always start over on the next one.
+                    rx_buffer.prepare_new_packet();
+                    ++rx_ix;
+                    --rx_count;
+                }
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::writable()
+            {
+                if (started)
+                {
+                    if (!connected && socket_id >= 0)
+                    {
+                        // Just connected
+                        connected = true;
+                        publish_connected_status();
+                    }
+
+                    if (connected)
+                    {
+                        if (tx_count == 0)
+                        {
+                            fill_send_batch();
+                        }
+
+                        if (tx_count > 0)
+                        {
+                            auto sent = send_datagrams();
+
+                            for (int i = 0; i < sent; ++i)
+                            {
+                                statistics.bytes_sent += static_cast<uint64_t>(tx_length[tx_ix + i]);
+                            }
+
+                            statistics.packets_sent += static_cast<uint32_t>(sent);
+                            if (started && sent < tx_count)
+                            {
+                                ++statistics.send_stalls;
+                            }
+
+                            tx_ix += sent;
+                            tx_count -= sent;
+                        }
+
+                        if (started && tx_count == 0 && tx_buffer.is_empty())
+                        {
+                            // Let the application know it may send more packets.
+                            smooth::core::network::TransmitBufferEmptyEvent event(shared_from_this());
+                            tx_empty.push(event);
+                        }
+                    }
+                }
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::fill_send_batch()
+            {
+                tx_ix = 0;
+                tx_count = 0;
+
+                while (tx_count < batch_size && !tx_buffer.is_empty())
+                {
+                    if (!tx_buffer.is_in_progress())
+                    {
+                        tx_buffer.prepare_next_packet();
+                    }
+
+                    if (tx_buffer.is_in_progress())
+                    {
+                        auto length = tx_buffer.get_remaining_data_length();
+                        size_t offset = 0;
+                        auto payload = tx_buffer.get_current_payload(offset);
+                        auto total = length + (payload ? payload->get_length() - offset : 0);
+
+                        if (total > static_cast<size_t>(max_datagram_size))
+                        {
+                            log("Packet larger than max_datagram_size discarded");
+                        }
+                        else if (payload
+                                 && payload->read(offset, tx_slot(tx_count) + length, total - length)
+                                    != static_cast<int>(total - length))
+                        {
+                            log("Could not read external payload, packet discarded");
+                        }
+                        else
+                        {
+                            // A datagram is always sent as a whole so the payload is copied along with the packet.
+                            memcpy(tx_slot(tx_count), tx_buffer.get_data_to_send(), length);
+                            tx_length[tx_count] = static_cast<int>(total);
+                            ++tx_count;
+                        }
+
+                        tx_buffer.data_has_been_sent(total);
+                    }
+                }
+            }
+
+            template<typename Packet>
+            int DatagramSocket<Packet>::send_datagrams()
+            {
+                int sent = 0;
+                errno = 0;
+
+#ifdef SMOOTH_HAS_MMSG
+                for (int i = 0; i < tx_count; ++i)
+                {
+                    vectors[i].iov_base = tx_slot(tx_ix + i);
+                    vectors[i].iov_len = static_cast<size_t>(tx_length[tx_ix + i]);
+                    memset(&messages[i], 0, sizeof(mmsghdr));
+                    messages[i].msg_hdr.msg_iov = &vectors[i];
+                    messages[i].msg_hdr.msg_iovlen = 1;
+                }
+
+                auto res = sendmmsg(socket_id, messages.data(), static_cast<unsigned int>(tx_count), SEND_FLAGS);
+                sent = std::max(0, res);
+#else
+                bool done = false;
+                while (!done && sent < tx_count)
+                {
+                    auto res = send(socket_id,
+                                    tx_slot(tx_ix + sent),
+                                    static_cast<size_t>(tx_length[tx_ix + sent]),
+                                    SEND_FLAGS);
+                    if (res >= 0)
+                    {
+                        ++sent;
+                    }
+                    else
+                    {
+                        done = true;
+                    }
+                }
+#endif
+
+                if (sent < tx_count && errno != 0 && errno != EWOULDBLOCK && errno != EAGAIN)
+                {
+                    if (errno == ECONNREFUSED)
+                    {
+                        // The remote end isn't listening (yet); drop the datagram and carry on.
+                        log("Connection refused, datagram dropped");
+                        ++sent;
+                    }
+                    else
+                    {
+                        loge("Failure during send");
+                        stop();
+                    }
+                }
+
+                return sent;
+            }
+
+            template<typename Packet>
+            bool DatagramSocket<Packet>::internal_start()
+            {
+                if (!is_active())
+                {
+                    rx_ix = 0;
+                    rx_count = 0;
+                    tx_ix = 0;
+                    tx_count = 0;
+
+                    {
+                        std::lock_guard<std::mutex> lock(address_guard);
+                        if (!remote)
+                        {
+                            log("No address to connect to");
+                        }
+                    }
+
+                    bool could_create = remote && create_socket();
+
+                    if (could_create)
+                    {
+                        // Connecting a datagram socket only sets the default remote endpoint
+                        // and filters incoming datagrams from other endpoints.
+                        log("Connecting");
+                        int res = connect(socket_id, remote->get_socket_address(), remote->get_socket_address_length());
+                        if (res == 0)
+                        {
+                            started = true;
+                        }
+                        else
+                        {
+                            loge("Error during connect");
+                        }
+                    }
+
+                    if (!started)
+                    {
+                        if (socket_id < 0)
+                        {
+                            // There is no socket for the SocketDispatcher to close, so report the failure here.
+                            publish_connected_status();
+                        }
+
+                        stop();
+                    }
+                }
+
+                return started;
+            }
+
+            template<typename Packet>
+            bool DatagramSocket<Packet>::is_active()
+            {
+                return started;
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::stop()
+            {
+                {
+                    // Cancel any ongoing name resolution.
+                    std::lock_guard<std::mutex> lock(address_guard);
+                    ++resolve_request;
+                }
+
+                stop_internal();
+                SocketDispatcher::instance().perform_op(SocketOperation::Op::Stop, shared_from_this());
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::stop_internal()
+            {
+                if (started)
+                {
+                    log("Stopping");
+                    started = false;
+                    connected = false;
+                    tx_buffer.clear();
+                    rx_buffer.clear();
+                }
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::publish_connected_status()
+            {
+                if (is_connected())
+                {
+                    log("Connected");
+                    ++statistics.connects;
+                    reported_connected = true;
+                }
+                else
+                {
+                    log("Disconnected");
+                    if (reported_connected)
+                    {
+                        ++statistics.disconnects;
+                    }
+                    else
+                    {
+                        ++statistics.connect_failures;
+                    }
+
+                    reported_connected = false;
+                }
+
+                auto self = shared_from_this();
+                ConnectionStatusEvent ev(self, is_connected());
+                connection_status.push(ev);
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::clear_socket_id()
+            {
+                socket_id = -1;
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::log(const char* message)
+            {
+                Log::verbose("DatagramSocket",
+                             Format("[{1}, {2}, {3}, {4}]: {5}",
+                                    Str(ip ? ip->get_ip_as_string() : ""),
+                                    Int32(ip ? ip->get_port() : 0),
+                                    Int32(socket_id),
+                                    Pointer(this),
+                                    Str(message)));
+            }
+
+            template<typename Packet>
+            void DatagramSocket<Packet>::loge(const char* message)
+            {
+                Log::error("DatagramSocket",
+                           Format("[{1}, {2}, {3} {4}]: {5}: {6} ({7})",
+                                  Str(ip ? ip->get_ip_as_string() : ""),
+                                  Int32(ip ? ip->get_port() : 0),
+                                  Int32(socket_id),
+                                  Pointer(this),
+                                  Str(message),
+                                  Str(strerror(errno)),
+                                  Int32(errno)));
+            }
+        }
+    }
+}
@@ -0,0 +1,137 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "IPacketAssembly.h"
+#include "IPacketDisassembly.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// A packet terminated by a delimiter, e.g. a line of text ending with '\n', for use with Socket<Packet>.
+            /// When the socket has a receive buffer (see the receive_buffer_size parameter of Socket<Packet>::create),
+            /// the received data is searched for the delimiter with memchr(), which is vectorized on most platforms,
+            /// and the packet is copied in one go. Without a receive buffer, the packet can't know how much to ask
+            /// for so it is read a byte at a time; avoid that for anything but the smallest amounts of data.
+            /// \tparam Delimiter The byte ending each packet.
+            /// \tparam MaxSize The largest packet accepted when receiving, including the delimiter. A longer packet
+            /// is an error.
+            template<uint8_t Delimiter, uint32_t MaxSize>
+            class DelimitedPacket
+                    : public IPacketAssembly, public IPacketDisassembly
+            {
+                public:
+                    DelimitedPacket() = default;
+
+                    /// Creates a packet to send. The delimiter is added after the data.
+                    /// \param data The data, which must not contain the delimiter.
+                    /// \param length The length of the data.
+                    DelimitedPacket(const uint8_t* data, uint32_t length)
+                    {
+                        frame.reserve(length + 1);
+                        frame.insert(frame.end(), data, data + length);
+                        frame.push_back(Delimiter);
+                        complete = true;
+                    }
+
+                    int get_wanted_amount() override
+                    {
+                        return 1;
+                    }
+
+                    void data_received(int length) override
+                    {
+                        written += static_cast<size_t>(length);
+                        frame.resize(written);
+                        check_end(written - static_cast<size_t>(length));
+                    }
+
+                    uint8_t* get_write_pos() override
+                    {
+                        frame.resize(written + 1);
+                        return frame.data() + written;
+                    }
+
+                    bool is_complete() override
+                    {
+                        return complete;
+                    }
+
+                    bool is_error() override
+                    {
+                        return error;
+                    }
+
+                    int consume(const uint8_t* data, int length) override
+                    {
+                        auto end = static_cast<const uint8_t*>(memchr(data, Delimiter, static_cast<size_t>(length)));
+                        auto amount = end == nullptr
+                                      ? static_cast<size_t>(length)
+                                      : static_cast<size_t>(end - data) + 1;
+
+                        frame.resize(written);
+                        frame.insert(frame.end(), data, data + amount);
+                        written = frame.size();
+                        complete = end != nullptr;
+                        error = written > MaxSize;
+
+                        return static_cast<int>(amount);
+                    }
+
+                    bool prepare_for_reuse() override
+                    {
+                        // clear() keeps the capacity of the vector.
+                        frame.clear();
+                        written = 0;
+                        complete = false;
+                        error = false;
+                        return true;
+                    }
+
+                    int get_send_length() override
+                    {
+                        return static_cast<int>(frame.size());
+                    }
+
+                    const uint8_t* get_data() override
+                    {
+                        return frame.data();
+                    }
+
+                    /// Gets the content of the packet, not including the delimiter.
+                    /// \return The first byte of the packet.
+                    const uint8_t* get_payload() const
+                    {
+                        return frame.data();
+                    }
+
+                    /// Gets the length of the content of the packet, not including the delimiter.
+                    /// \return Number of bytes
+                    uint32_t get_payload_length() const
+                    {
+                        return complete && !frame.empty() ? static_cast<uint32_t>(frame.size() - 1) : 0;
+                    }
+
+                private:
+                    void check_end(size_t from)
+                    {
+                        complete = memchr(frame.data() + from, Delimiter, written - from) != nullptr;
+                        error = written > MaxSize;
+                    }
+
+                    std::vector<uint8_t> frame{};
+                    size_t written = 0;
+                    bool complete = false;
+                    bool error = false;
+            };
+        }
+    }
+}
@@ -0,0 +1,104 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <chrono>
+#include <unordered_map>
+#include <smooth/core/Task.h>
+#include <smooth/core/ipc/TaskEventQueue.h>
+#include "InetAddress.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            typedef std::vector<std::shared_ptr<InetAddress>> AddressList;
+
+            /// A request to resolve a host name, as queued to the DnsResolver.
+            class ResolveRequest
+            {
+                public:
+                    ResolveRequest() = default;
+
+                    ResolveRequest(const std::string& host_name, uint16_t port,
+                                   std::function<void(const AddressList&)> callback)
+                            : host_name(host_name), port(port), callback(std::move(callback))
+                    {
+                    }
+
+                    std::string host_name{};
+                    uint16_t port = 0;
+                    std::function<void(const AddressList&)> callback{};
+            };
+
+            /// The DnsResolver resolves host names into IPv4 and IPv6 addresses in a task of its own so that
+            /// name lookups never block the application or the SocketDispatcher. Results are cached for
+            /// CONFIG_SMOOTH_DNS_CACHE_TTL seconds; when a lookup fails, an expired result is used rather than
+            /// none at all, so reconnecting doesn't depend on the name server being reachable.
+            class DnsResolver
+                    : public smooth::core::Task,
+                      public smooth::core::ipc::IEventListener<ResolveRequest>
+            {
+                public:
+                    static DnsResolver& instance();
+
+                    /// Resolves a host name.
+                    /// \param host_name The name to resolve.
+                    /// \param port The port the returned addresses shall have.
+                    /// \param callback Called with the addresses, or an empty list if the name could not be resolved.
+                    /// The addresses alternate between IPv6 and IPv4, starting with the family preferred by the
+                    /// system, as suitable for connecting Happy Eyeballs style. Cached names are returned directly
+                    /// from within this call, all others from the resolver task.
+                    void resolve(const std::string& host_name, uint16_t port,
+                                 std::function<void(const AddressList&)> callback);
+
+                    /// Adds a host with fixed addresses, which is then resolved without asking the name server,
+                    /// like an entry in a hosts file, e.g. for a broker on a network without DNS. The addresses
+                    /// are ordered like resolved ones, with the family of the first one preferred.
+                    /// \param host_name The name of the host.
+                    /// \param addresses Numeric IPv4 and IPv6 addresses; anything else is ignored.
+                    void add_host(const std::string& host_name, const std::vector<std::string>& addresses);
+
+                    /// Removes all cached names, e.g. when the network has changed. Hosts added via add_host()
+                    /// are kept.
+                    void clear_cache();
+
+                    void event(const ResolveRequest& request) override;
+
+                private:
+                    class CacheEntry
+                    {
+                        public:
+                            std::vector<std::pair<int, std::string>> addresses{};
+                            std::chrono::steady_clock::time_point expires{};
+                    };
+
+                    DnsResolver();
+
+                    bool get_cached(const std::string& host_name, uint16_t port, bool allow_expired,
+                                    AddressList& addresses);
+                    bool lookup(const std::string& host_name, CacheEntry& entry);
+                    static void interleave(const std::vector<std::pair<int, std::string>>& v4,
+                                           const std::vector<std::pair<int, std::string>>& v6,
+                                           bool v6_first, CacheEntry& entry);
+                    static AddressList create_addresses(const CacheEntry& entry, uint16_t port);
+
+                    smooth::core::ipc::TaskEventQueue<ResolveRequest> requests;
+                    std::unordered_map<std::string, CacheEntry> cache{};
+                    // Added via add_host(); these never expire.
+                    std::unordered_map<std::string, CacheEntry> hosts{};
+                    std::mutex cache_guard{};
+                    static constexpr const char* tag = "DnsResolver";
+            };
+        }
+    }
+}
@@ -0,0 +1,109 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <sys/types.h>
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// Data that is sent as part of a packet without first being copied into it. The data is either memory
+            /// owned elsewhere, kept alive for as long as the payload exists, or a region of a file. Sockets send it
+            /// straight from where it is kept when possible, i.e. with MSG_ZEROCOPY and sendfile() on Linux, and
+            /// otherwise copy it in small pieces. The data must not change until the packet has been sent.
+            /// Payloads are shared between copies of a packet via std::shared_ptr.
+            class ExternalPayload
+            {
+                public:
+                    /// Creates a payload referring to memory.
+                    /// \param owner Keeps the memory alive, e.g. the std::shared_ptr holding the object the data is part of.
+                    /// \param data Start of the data
+                    /// \param length Number of bytes
+                    ExternalPayload(std::shared_ptr<const void> owner, const uint8_t* data, size_t length)
+                            : owner(std::move(owner)), data(data), length(length)
+                    {
+                    }
+
+                    /// Creates a payload referring to the contents of a vector.
+                    /// \param data The data
+                    explicit ExternalPayload(std::shared_ptr<const std::vector<uint8_t>> data)
+                            : owner(data), data(data->data()), length(data->size())
+                    {
+                    }
+
+                    /// Creates a payload referring to a region of a file.
+                    /// \param file_descriptor A file descriptor open for reading. The payload takes ownership of it and
+                    /// closes it when destroyed.
+                    /// \param offset Offset of the first byte in the file.
+                    /// \param length Number of bytes
+                    ExternalPayload(int file_descriptor, off_t offset, size_t length)
+                            : file(file_descriptor), offset(offset), length(length)
+                    {
+                    }
+
+                    ~ExternalPayload();
+
+                    ExternalPayload(const ExternalPayload&) = delete;
+                    ExternalPayload& operator=(const ExternalPayload&) = delete;
+
+                    /// Returns a value indicating if the payload refers to a file.
+                    /// \return true for a file, false for memory.
+                    bool is_file() const
+                    {
+                        return file >= 0;
+                    }
+
+                    /// Gets the data of a memory payload.
+                    /// \return The data, or nullptr for a file payload.
+                    const uint8_t* get_data() const
+                    {
+                        return data;
+                    }
+
+                    /// Gets the file descriptor of a file payload.
+                    /// \return The file descriptor, or -1 for a memory payload.
+                    int get_file() const
+                    {
+                        return file;
+                    }
+
+                    /// Gets the offset in the file of the first byte of a file payload.
+                    /// \return The offset
+                    off_t get_offset() const
+                    {
+                        return offset;
+                    }
+
+                    /// Gets the number of bytes in the payload.
+                    /// \return Number of bytes
+                    size_t get_length() const
+                    {
+                        return length;
+                    }
+
+                    /// Copies part of the payload, regardless of where it is kept.
+                    /// \param position Position in the payload of the first byte to copy.
+                    /// \param target Where to copy the data to.
+                    /// \param max_length Maximum number of bytes to copy.
+                    /// \return The number of bytes copied, or -1 if the file could not be read.
+                    int read(size_t position, uint8_t* target, size_t max_length) const;
+
+                private:
+                    std::shared_ptr<const void> owner{};
+                    const uint8_t* data = nullptr;
+                    int file = -1;
+                    off_t offset = 0;
+                    size_t length = 0;
+            };
+        }
+    }
+}
@@ -0,0 +1,52 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include "InetAddress.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// Represents a host name and port number that is yet to be resolved into an IPv4 or IPv6 address.
+            /// Sockets started with a HostName resolve it via the DnsResolver before connecting.
+            class HostName
+                    : public InetAddress
+            {
+                public:
+                    /// Constructor
+                    /// \param host_name The host name, e.g. broker.example.com
+                    /// \param port The port to connect to.
+                    HostName(const std::string& host_name, uint16_t port)
+                            : InetAddress(host_name, port)
+                    {
+                        valid = !host_name.empty();
+                    }
+
+                    int get_address_family() const override
+                    {
+                        return AF_UNSPEC;
+                    }
+
+                    sockaddr* get_socket_address() override
+                    {
+                        return nullptr;
+                    }
+
+                    socklen_t get_socket_address_length() const override
+                    {
+                        return 0;
+                    }
+
+                    bool is_resolved() const override
+                    {
+                        return false;
+                    }
+            };
+        }
+    }
+}
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
 namespace smooth
 {
     namespace core
@@ -43,6 +47,43 @@ namespace smooth
                     /// \return true or false
                     virtual bool is_error() = 0;
 
+                    /// Assembles the packet from data that has already been received into a staging buffer.
+                    /// Consumes data up to, but never beyond, the end of this packet so that any remaining data
+                    /// can be used to assemble the next packet. The default implementation copies the data into
+                    /// the packet via get_wanted_amount(), get_write_pos() and data_received(); packet types that can
+                    /// frame themselves more efficiently may override it.
+                    /// \param data Start of the received data
+                    /// \param length Number of bytes available at data
+                    /// \return Number of bytes consumed
+                    virtual int consume(const uint8_t* data, int length)
+                    {
+                        int consumed = 0;
+
+                        while (consumed < length && !is_complete() && !is_error())
+                        {
+                            int amount = std::min(get_wanted_amount(), length - consumed);
+                            if (amount <= 0)
+                            {
+                                break;
+                            }
+
+                            memcpy(get_write_pos(), data + consumed, static_cast<size_t>(amount));
+                            data_received(amount);
+                            consumed += amount;
+                        }
+
+                        return consumed;
+                    }
+
+                    /// Prepares the packet for assembly of a new packet, keeping any memory it has allocated so
+                    /// that it can be reused without new allocations. Packet types that don't support this return
+                    /// false and are replaced with a default constructed instance instead.
+                    /// \return true if the packet has been reset, otherwise false.
+                    virtual bool prepare_for_reuse()
+                    {
+                        return false;
+                    }
+
                     virtual ~IPacketAssembly() = default;
             };
         }
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include "ExternalPayload.h"
+
 namespace smooth
 {
     namespace core
@@ -20,6 +24,21 @@ namespace smooth
                     /// Must return a pointer to the data to be sent.
                     /// \return The read position
                     virtual const uint8_t* get_data() = 0;
+                    /// May return data to be sent directly after the data returned by get_data(), but which is kept
+                    /// outside of the packet. get_send_length() does not include the length of the payload.
+                    /// \return The payload, or nullptr if there is none.
+                    virtual std::shared_ptr<const ExternalPayload> get_external_payload()
+                    {
+                        return nullptr;
+                    }
+
+                    /// Gets the total amount of bytes to send, including any external payload.
+                    /// \return Number of bytes to send
+                    size_t get_total_send_length()
+                    {
+                        auto payload = get_external_payload();
+                        return static_cast<size_t>(get_send_length()) + (payload ? payload->get_length() : 0);
+                    }
 
                     virtual ~IPacketDisassembly() = default;
             };
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace smooth
 {
     namespace core
@@ -27,6 +29,12 @@ namespace smooth
                     /// This method is called to notify the buffer that the specified amount of data has been written.
                     /// \param length The number of bytes written.
                     virtual void data_received(int length) = 0;
+                    /// Assembles the current packet from already received data, such as the contents of a
+                    /// staging buffer, without going via get_write_pos(). Stops at the end of the current packet.
+                    /// \param data Start of the received data
+                    /// \param length Number of bytes available at data
+                    /// \return The number of bytes consumed.
+                    virtual int consume(const uint8_t* data, int length) = 0;
                     /// Returns a value indicating if the current packet has been completed.
                     /// \return true of false.
                     virtual bool is_packet_complete() = 0;
@@ -4,6 +4,15 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <sys/socket.h>
+#ifndef ESP_PLATFORM
+#include <sys/uio.h>
+#endif
+#include "ExternalPayload.h"
+
 namespace smooth
 {
     namespace core
@@ -24,17 +33,62 @@ namespace smooth
                     /// Returns the start of the data to be sent.
                     /// \return A pointer to the first byte of the data to send.
                     virtual const uint8_t* get_data_to_send() = 0;
-                    /// Gets the number of bytes to be sent.
+                    /// Gets the number of bytes to be sent from get_data_to_send(), i.e. what remains of the current
+                    /// packet's own data, not including any external payload.
                     /// \return The number of bytes remaining to be sent.
                     virtual size_t get_remaining_data_length() = 0;
+                    /// Gets the external payload of the current packet, see IPacketDisassembly::get_external_payload().
+                    /// \param offset Set to the number of bytes of the payload that have already been sent.
+                    /// \return The payload, or nullptr if the current packet has none.
+                    virtual std::shared_ptr<const ExternalPayload> get_current_payload(size_t& offset) = 0;
+                    /// Gets the data to be sent as a list of vectors, allowing several packets to be sent with
+                    /// a single call. The first vectors are the remainder of the current packet, including an
+                    /// external payload kept in memory. A payload kept in a file is not included and ends the list,
+                    /// so the list is empty when only such a payload remains to be sent. After sending,
+                    /// data_has_been_sent() is called with the total amount sent.
+                    /// \param vectors The vectors to fill in.
+                    /// \param max_count The number of elements in vectors.
+                    /// \return The number of vectors filled in.
+                    virtual int get_send_vectors(iovec* vectors, int max_count)
+                    {
+                        int count = 0;
+
+                        if (max_count > 0 && is_in_progress())
+                        {
+                            auto length = get_remaining_data_length();
+
+                            if (length > 0)
+                            {
+                                vectors[count].iov_base = const_cast<uint8_t*>(get_data_to_send());
+                                vectors[count].iov_len = length;
+                                ++count;
+                            }
+
+                            size_t offset = 0;
+                            auto payload = get_current_payload(offset);
+
+                            if (payload && !payload->is_file() && count < max_count && offset < payload->get_length())
+                            {
+                                vectors[count].iov_base = const_cast<uint8_t*>(payload->get_data() + offset);
+                                vectors[count].iov_len = payload->get_length() - offset;
+                                ++count;
+                            }
+                        }
+
+                        return count;
+                    }
                     /// Called when the specified amount of data has been sent.
                     /// \param length The number of bytes that has been sent.
-                    virtual void data_has_been_sent(size_t length) = 0;
+                    /// \return The number of packets that were completely sent by this.
+                    virtual int data_has_been_sent(size_t length) = 0;
                     /// Perpares the next packet to be sent.
                     virtual void prepare_next_packet() = 0;
                     /// Puts an item into the buffer to be sent.
                     /// \return true if the item could be queued, otherwise false.
                     virtual bool put(const PacketType& item) = 0;
+                    /// Moves an item into the buffer to be sent.
+                    /// \return true if the item could be queued, otherwise false.
+                    virtual bool put(PacketType&& item) = 0;
                     /// Clears the buffer.
                     virtual void clear() = 0;
                     /// Returns an item indicating if the buffer is empty.
@@ -14,7 +14,6 @@ namespace smooth
         namespace network
         {
             /// Represents an IPv6 address and port number.
-            /// Note: Untested.
             class IPv6
                     : public InetAddress
             {
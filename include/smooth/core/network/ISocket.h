@@ -5,8 +5,10 @@
 #pragma once
 
 #include <memory>
+#include <chrono>
 
 #include "InetAddress.h"
+#include "SocketStatistics.h"
 
 namespace smooth
 {
@@ -47,10 +49,31 @@ namespace smooth
                     virtual void readable() = 0;
                     virtual void writable() = 0;
                     virtual bool has_data_to_transmit() = 0;
+                    /// Returns true if received data is waiting to be assembled into packets, whether or not the
+                    /// receive buffer has room for it. The SocketDispatcher only checks has_pending_input() for
+                    /// sockets for which this is true.
+                    virtual bool has_staged_input() = 0;
+                    /// Returns true if received data is waiting to be assembled and the receive buffer has room
+                    /// for it, i.e. if readable() would make progress although no new data has arrived.
+                    virtual bool has_pending_input() = 0;
                     virtual bool internal_start() = 0;
                     virtual void publish_connected_status() = 0;
                     virtual void stop_internal() = 0;
                     virtual void clear_socket_id() = 0;
+                    /// Returns the id of a connection attempt made in parallel with the one on get_socket_id(),
+                    /// or -1 if there is none.
+                    virtual int get_alternate_socket_id() = 0;
+                    /// Called periodically by the SocketDispatcher while the socket is connecting.
+                    /// \return true while the connection is still being established, false once the socket no
+                    /// longer needs to be checked.
+                    virtual bool check_connection_attempts() = 0;
+                    /// Gets the statistics of the socket. Only to be accessed from the SocketDispatcher's task,
+                    /// see SocketDispatcher::get_statistics().
+                    virtual SocketStatistics& get_statistics() = 0;
+                    /// Gets the time left until the send in progress expires, see has_send_expired().
+                    /// \return The remaining time, zero once expired, or std::chrono::milliseconds::max() when
+                    /// no send is in progress.
+                    virtual std::chrono::milliseconds get_send_time_left() const = 0;
             };
         }
     }
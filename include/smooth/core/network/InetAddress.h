@@ -26,6 +26,8 @@ namespace smooth
                     {
                     }
 
+                    virtual ~InetAddress() = default;
+
                     /// Gets the address family, e.g. AF_INET or AF_INET6
                     /// \return The adress family
                     virtual int get_address_family() const = 0;
@@ -66,6 +68,14 @@ namespace smooth
                         return valid;
                     }
 
+                    /// Returns a value indicating if this is an actual IP address or a name that must be resolved
+                    /// before it can be connected to.
+                    /// \return true or false
+                    virtual bool is_resolved() const
+                    {
+                        return true;
+                    }
+
                 protected:
                     bool valid = false;
                     std::string ip_as_string;
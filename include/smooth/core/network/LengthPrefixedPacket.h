@@ -0,0 +1,281 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "IPacketAssembly.h"
+#include "IPacketDisassembly.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// The encodings of the length in front of a LengthPrefixedPacket.
+            enum class LengthPrefix
+            {
+                /// Two bytes, most significant byte first.
+                U16BigEndian,
+                /// Four bytes, most significant byte first.
+                U32BigEndian,
+                /// One to five bytes, seven bits per byte with the least significant group first and the high
+                /// bit set on all but the last byte (LEB128, as used by Protocol Buffers).
+                VarInt
+            };
+
+            /// A packet consisting of a length followed by that many bytes of payload, for use with Socket<Packet>.
+            /// When the socket has a receive buffer (see the receive_buffer_size parameter of Socket<Packet>::create),
+            /// the payload is copied from the received data in one go, regardless of how many packets each receive
+            /// holds. Otherwise, the payload is read with a single receive once the length is known.
+            /// \tparam Prefix How the length is encoded.
+            /// \tparam MaxPayloadSize The largest payload accepted, both when receiving and sending; a larger length
+            /// is an error.
+            template<LengthPrefix Prefix, uint32_t MaxPayloadSize>
+            class LengthPrefixedPacket
+                    : public IPacketAssembly, public IPacketDisassembly
+            {
+                public:
+                    LengthPrefixedPacket() = default;
+
+                    /// Creates a packet to send. A payload larger than MaxPayloadSize, or than the prefix can express,
+                    /// is rejected rather than sent with a truncated length the receiver would misread; the packet
+                    /// is then in error (see is_error()) and holds no data, so sending it sends nothing.
+                    /// \param data The payload
+                    /// \param length The length of the payload.
+                    LengthPrefixedPacket(const uint8_t* data, uint32_t length)
+                    {
+                        if (length > max_send_length())
+                        {
+                            state = State::Error;
+                        }
+                        else
+                        {
+                            frame.reserve(max_prefix_length + length);
+                            encode_length(length);
+                            header_length = frame.size();
+                            payload_length = length;
+                            frame.insert(frame.end(), data, data + length);
+                            state = State::Complete;
+                        }
+                    }
+
+                    int get_wanted_amount() override
+                    {
+                        int wanted;
+
+                        if (state == State::Length)
+                        {
+                            // A varint is read a byte at a time since its length isn't known up front.
+                            wanted = Prefix == LengthPrefix::VarInt
+                                     ? 1
+                                     : static_cast<int>(fixed_length() - written);
+                        }
+                        else
+                        {
+                            wanted = static_cast<int>(header_length + payload_length - written);
+                        }
+
+                        return wanted;
+                    }
+
+                    void data_received(int length) override
+                    {
+                        written += static_cast<size_t>(length);
+                        frame.resize(written);
+
+                        if (state == State::Length)
+                        {
+                            decode_length();
+                        }
+                        else if (frame.size() == header_length + payload_length)
+                        {
+                            state = State::Complete;
+                        }
+                    }
+
+                    uint8_t* get_write_pos() override
+                    {
+                        frame.resize(written + static_cast<size_t>(get_wanted_amount()));
+                        return frame.data() + written;
+                    }
+
+                    bool is_complete() override
+                    {
+                        return state == State::Complete;
+                    }
+
+                    bool is_error() override
+                    {
+                        return state == State::Error;
+                    }
+
+                    int consume(const uint8_t* data, int length) override
+                    {
+                        int consumed = 0;
+                        // Drop any space reserved by get_write_pos().
+                        frame.resize(written);
+
+                        while (consumed < length && state == State::Length)
+                        {
+                            frame.push_back(data[consumed++]);
+                            decode_length();
+                        }
+
+                        if (consumed < length && state == State::Payload)
+                        {
+                            auto amount = std::min(static_cast<size_t>(length - consumed),
+                                                   header_length + payload_length - frame.size());
+                            frame.insert(frame.end(), data + consumed, data + consumed + amount);
+                            consumed += static_cast<int>(amount);
+
+                            if (frame.size() == header_length + payload_length)
+                            {
+                                state = State::Complete;
+                            }
+                        }
+
+                        written = frame.size();
+                        return consumed;
+                    }
+
+                    bool prepare_for_reuse() override
+                    {
+                        // clear() keeps the capacity of the vector.
+                        frame.clear();
+                        written = 0;
+                        header_length = 0;
+                        payload_length = 0;
+                        state = State::Length;
+                        return true;
+                    }
+
+                    int get_send_length() override
+                    {
+                        return static_cast<int>(frame.size());
+                    }
+
+                    const uint8_t* get_data() override
+                    {
+                        return frame.data();
+                    }
+
+                    /// Gets the payload of the packet.
+                    /// \return The first byte of the payload.
+                    const uint8_t* get_payload() const
+                    {
+                        return frame.data() + header_length;
+                    }
+
+                    /// Gets the length of the payload.
+                    /// \return Number of bytes
+                    uint32_t get_payload_length() const
+                    {
+                        return payload_length;
+                    }
+
+                private:
+                    enum class State
+                    {
+                        Length,
+                        Payload,
+                        Complete,
+                        Error
+                    };
+
+                    static size_t fixed_length()
+                    {
+                        return Prefix == LengthPrefix::U16BigEndian ? 2 : 4;
+                    }
+
+                    static uint32_t max_send_length()
+                    {
+                        // Four bytes and a five byte varint both hold any uint32_t.
+                        return Prefix == LengthPrefix::U16BigEndian
+                               ? std::min(MaxPayloadSize, static_cast<uint32_t>(0xFFFF))
+                               : MaxPayloadSize;
+                    }
+
+                    void encode_length(uint32_t length)
+                    {
+                        if (Prefix == LengthPrefix::VarInt)
+                        {
+                            do
+                            {
+                                auto b = static_cast<uint8_t>(length & 0x7F);
+                                length >>= 7;
+                                frame.push_back(length > 0 ? static_cast<uint8_t>(b | 0x80) : b);
+                            } while (length > 0);
+                        }
+                        else
+                        {
+                            for (auto shift = static_cast<int>(fixed_length() - 1) * 8; shift >= 0; shift -= 8)
+                            {
+                                frame.push_back(static_cast<uint8_t>(length >> shift));
+                            }
+                        }
+                    }
+
+                    void decode_length()
+                    {
+                        bool done;
+
+                        if (Prefix == LengthPrefix::VarInt)
+                        {
+                            done = !frame.empty() && (frame.back() & 0x80) == 0;
+
+                            if (!done && frame.size() >= max_prefix_length)
+                            {
+                                state = State::Error;
+                            }
+                        }
+                        else
+                        {
+                            done = frame.size() == fixed_length();
+                        }
+
+                        if (done)
+                        {
+                            uint64_t length = 0;
+
+                            for (size_t i = 0; i < frame.size(); ++i)
+                            {
+                                if (Prefix == LengthPrefix::VarInt)
+                                {
+                                    length |= static_cast<uint64_t>(frame[i] & 0x7F) << (7 * i);
+                                }
+                                else
+                                {
+                                    length = (length << 8) | frame[i];
+                                }
+                            }
+
+                            if (length > MaxPayloadSize)
+                            {
+                                state = State::Error;
+                            }
+                            else
+                            {
+                                header_length = frame.size();
+                                payload_length = static_cast<uint32_t>(length);
+                                state = payload_length == 0 ? State::Complete : State::Payload;
+                                frame.reserve(header_length + payload_length);
+                            }
+                        }
+                    }
+
+                    static const size_t max_prefix_length = Prefix == LengthPrefix::VarInt ? 5 : 4;
+                    std::vector<uint8_t> frame{};
+                    size_t written = 0;
+                    size_t header_length = 0;
+                    uint32_t payload_length = 0;
+                    State state = State::Length;
+            };
+        }
+    }
+}
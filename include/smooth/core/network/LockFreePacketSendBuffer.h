@@ -0,0 +1,225 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "IPacketSendBuffer.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// LockFreePacketSendBuffer is a single-producer, single-consumer send buffer that can hold Size packets
+            /// of type Packet without using any locks. Packets can be moved into the buffer and are sent straight
+            /// from the slot they were put in, i.e. never copied. Several queued packets can be handed to the
+            /// socket at once via get_send_vectors().
+            /// The application (the producer) may call put() from one thread at a time, the socket (the consumer)
+            /// calls all other methods except clear(), which may be called from any thread. Queued packets are
+            /// released by the consumer the next time it accesses the buffer.
+            /// Packet must provide the IPacketDisassembly interface (either directly or via inheritance) and
+            /// fulfill the following contract:
+            /// * Default constructable
+            /// * Must be copyable and movable
+            /// \tparam Packet The packet type
+            /// \tparam Size Number of items to hold in the buffer, must be a power of two.
+            template<typename Packet, int Size>
+            class LockFreePacketSendBuffer
+                    : public IPacketSendBuffer<Packet>
+            {
+                    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+                public:
+                    LockFreePacketSendBuffer()
+                            : slots()
+                    {
+                    }
+
+                    bool put(const Packet& item) override
+                    {
+                        Packet copy(item);
+                        return put(std::move(copy));
+                    }
+
+                    bool put(Packet&& item) override
+                    {
+                        auto write = write_ix.load(std::memory_order_relaxed);
+                        bool res = write - read_ix.load(std::memory_order_acquire) < static_cast<uint32_t>(Size);
+
+                        if (res)
+                        {
+                            slots[write % Size] = std::move(item);
+                            write_ix.store(write + 1, std::memory_order_release);
+                        }
+
+                        return res;
+                    }
+
+                    bool is_in_progress() override
+                    {
+                        apply_clear();
+                        return in_progress;
+                    }
+
+                    const uint8_t* get_data_to_send() override
+                    {
+                        return current().get_data() + bytes_sent;
+                    }
+
+                    size_t get_remaining_data_length() override
+                    {
+                        auto length = static_cast<size_t>(current().get_send_length());
+                        return bytes_sent < length ? length - bytes_sent : 0;
+                    }
+
+                    std::shared_ptr<const ExternalPayload> get_current_payload(size_t& offset) override
+                    {
+                        auto length = static_cast<size_t>(current().get_send_length());
+                        offset = bytes_sent > length ? bytes_sent - length : 0;
+                        return current().get_external_payload();
+                    }
+
+                    int get_send_vectors(iovec* vectors, int max_count) override
+                    {
+                        int count = 0;
+                        auto read = read_ix.load(std::memory_order_relaxed);
+                        auto write = write_ix.load(std::memory_order_acquire);
+
+                        if (in_progress)
+                        {
+                            // Remainder of the current packet, followed by as many of the queued ones as will fit.
+                            // A payload in a file can't be part of a vector so it ends the list.
+                            size_t offset = bytes_sent;
+                            bool more = true;
+
+                            for (auto ix = read; more && ix != write && count < max_count; ++ix)
+                            {
+                                auto& packet = slots[ix % Size];
+                                auto length = static_cast<size_t>(packet.get_send_length());
+
+                                if (offset < length)
+                                {
+                                    vectors[count].iov_base = const_cast<uint8_t*>(packet.get_data() + offset);
+                                    vectors[count].iov_len = length - offset;
+                                    ++count;
+                                }
+
+                                auto payload = packet.get_external_payload();
+
+                                if (payload)
+                                {
+                                    auto payload_offset = offset > length ? offset - length : 0;
+                                    more = !payload->is_file() && count < max_count;
+
+                                    if (more)
+                                    {
+                                        vectors[count].iov_base = const_cast<uint8_t*>(payload->get_data()
+                                                                                       + payload_offset);
+                                        vectors[count].iov_len = payload->get_length() - payload_offset;
+                                        ++count;
+                                    }
+                                }
+
+                                offset = 0;
+                            }
+                        }
+
+                        return count;
+                    }
+
+                    int data_has_been_sent(size_t length) override
+                    {
+                        bytes_sent += length;
+                        int completed = 0;
+
+                        // The sent data may span several packets, see get_send_vectors().
+                        while (in_progress && bytes_sent >= current().get_total_send_length())
+                        {
+                            bytes_sent -= current().get_total_send_length();
+                            release_current();
+                            ++completed;
+                            in_progress = bytes_sent > 0;
+                        }
+
+                        return completed;
+                    }
+
+                    void prepare_next_packet() override
+                    {
+                        apply_clear();
+
+                        if (!in_progress)
+                        {
+                            bytes_sent = 0;
+                            in_progress = read_ix.load(std::memory_order_relaxed)
+                                          != write_ix.load(std::memory_order_acquire);
+                        }
+                    }
+
+                    void clear() override
+                    {
+                        // Only the consumer may release packets, so just note how far to clear.
+                        clear_to.store(write_ix.load(std::memory_order_acquire), std::memory_order_relaxed);
+                        clear_generation.fetch_add(1, std::memory_order_release);
+                    }
+
+                    bool is_empty() override
+                    {
+                        apply_clear();
+                        return !in_progress
+                               && read_ix.load(std::memory_order_relaxed) == write_ix.load(std::memory_order_acquire);
+                    }
+
+                private:
+                    Packet& current()
+                    {
+                        return slots[read_ix.load(std::memory_order_relaxed) % Size];
+                    }
+
+                    void release_current()
+                    {
+                        auto read = read_ix.load(std::memory_order_relaxed);
+                        // Release the memory held by the packet before handing the slot back to the producer.
+                        slots[read % Size] = Packet();
+                        read_ix.store(read + 1, std::memory_order_release);
+                    }
+
+                    void apply_clear()
+                    {
+                        auto generation = clear_generation.load(std::memory_order_acquire);
+
+                        if (generation != seen_generation)
+                        {
+                            seen_generation = generation;
+                            auto target = clear_to.load(std::memory_order_relaxed);
+
+                            // Packets put after clear() was called are kept.
+                            while (static_cast<int32_t>(target - read_ix.load(std::memory_order_relaxed)) > 0)
+                            {
+                                release_current();
+                            }
+
+                            in_progress = false;
+                            bytes_sent = 0;
+                        }
+                    }
+
+                    std::array<Packet, Size> slots;
+                    // Free running indexes, the slot is index % Size.
+                    std::atomic<uint32_t> write_ix{0};
+                    std::atomic<uint32_t> read_ix{0};
+                    std::atomic<uint32_t> clear_to{0};
+                    std::atomic<uint32_t> clear_generation{0};
+                    // Consumer only
+                    uint32_t seen_generation = 0;
+                    size_t bytes_sent = 0;
+                    bool in_progress = false;
+            };
+        }
+    }
+}
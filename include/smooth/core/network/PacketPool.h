@@ -0,0 +1,152 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <smooth/core/util/make_unique.h>
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// Usage statistics of a PacketPool, or of a single buffer borrowing packets from one.
+            class PacketPoolStatistics
+            {
+                public:
+                    /// The maximum number of packets that may be borrowed at the same time.
+                    int capacity = 0;
+                    /// The number of packets currently borrowed.
+                    int in_use = 0;
+                    /// The highest number of packets borrowed at the same time.
+                    int peak_in_use = 0;
+                    /// The total number of times a packet has been borrowed.
+                    uint32_t borrowed = 0;
+                    /// The number of times a packet could not be borrowed because the limit was reached.
+                    uint32_t exhausted = 0;
+
+                    void on_borrow()
+                    {
+                        ++in_use;
+                        ++borrowed;
+                        peak_in_use = std::max(peak_in_use, in_use);
+                    }
+
+                    void on_give_back()
+                    {
+                        --in_use;
+                    }
+            };
+
+            /// PacketPool holds packets shared by several PooledPacketSendBuffers and PooledPacketReceiveBuffers,
+            /// so that memory for packets is only used by sockets that actually have data queued, rather than
+            /// every socket having buffers sized for its worst case. Packets are allocated when first needed
+            /// and kept for reuse once given back, up to the capacity of the pool, together with the memory they
+            /// hold when the packet type supports IPacketAssembly::prepare_for_reuse().
+            /// Packet must fulfill the following contract:
+            /// * Default constructable
+            /// * Must be copyable and movable
+            /// * Must implement IPacketAssembly
+            /// The pool must outlive all buffers borrowing from it.
+            /// \tparam Packet The packet type
+            template<typename Packet>
+            class PacketPool
+            {
+                public:
+                    /// Constructor
+                    /// \param capacity The maximum number of packets that may be borrowed at the same time,
+                    /// across all buffers.
+                    explicit PacketPool(int capacity)
+                    {
+                        stats.capacity = capacity;
+                    }
+
+                    PacketPool(const PacketPool&) = delete;
+                    PacketPool& operator=(const PacketPool&) = delete;
+
+                    /// Borrows a packet.
+                    /// \return A default constructed packet, or nullptr if the pool is exhausted.
+                    std::unique_ptr<Packet> borrow()
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        std::unique_ptr<Packet> res;
+
+                        if (stats.in_use >= stats.capacity)
+                        {
+                            ++stats.exhausted;
+                        }
+                        else
+                        {
+                            if (free_packets.empty())
+                            {
+                                res = smooth::core::util::make_unique<Packet>();
+                            }
+                            else
+                            {
+                                res = std::move(free_packets.back());
+                                free_packets.pop_back();
+                            }
+
+                            stats.on_borrow();
+                        }
+
+                        return res;
+                    }
+
+                    /// Gives back a borrowed packet to the pool.
+                    /// \param packet The packet
+                    void give_back(std::unique_ptr<Packet> packet)
+                    {
+                        if (packet)
+                        {
+                            // Keep the memory of the packet for the next one borrowed; shrink() releases it.
+                            if (!packet->prepare_for_reuse())
+                            {
+                                *packet = Packet();
+                            }
+
+                            std::lock_guard<std::mutex> lock(guard);
+                            free_packets.push_back(std::move(packet));
+                            stats.on_give_back();
+                        }
+                    }
+
+                    /// Releases the packets not currently borrowed, and the memory they hold.
+                    void shrink()
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        free_packets.clear();
+                        free_packets.shrink_to_fit();
+                    }
+
+                    /// Gets the usage statistics of the pool.
+                    /// \return The statistics
+                    PacketPoolStatistics get_statistics()
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return stats;
+                    }
+
+                    /// Returns a value indicating if all packets are borrowed.
+                    /// \return true or false
+                    bool is_exhausted()
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return stats.in_use >= stats.capacity;
+                    }
+
+                private:
+                    std::mutex guard{};
+                    std::vector<std::unique_ptr<Packet>> free_packets{};
+                    PacketPoolStatistics stats{};
+            };
+        }
+    }
+}
@@ -15,11 +15,16 @@ namespace smooth
         namespace network
         {
             /// PacketReceiveBuffer is a buffer that can hold Size items of type Packet
-            /// and helps with assembling of data packets.
+            /// and helps with assembling of data packets. Packets are moved, never copied, on their way
+            /// through the buffer and spent packets are recycled so that, once their memory has grown to fit
+            /// the received data, assembly needs no further heap allocations. To benefit from this, pass the
+            /// same instance to get() each time.
             /// Packet must provide the IPacketAssembly interface (either directly or via inheritance)
             /// and fulfill the following contract:
             /// * Default constructable
             /// * Must be copyable
+            /// * Should be movable; completed packets are moved into the buffer.
+            /// * Should implement IPacketAssembly::prepare_for_reuse().
             /// \tparam Packet The type of packet to assemble
             /// \tparam Size  The Number of items to hold in the buffer.
             template<typename Packet, int Size>
@@ -28,7 +33,7 @@ namespace smooth
             {
                 public:
                     PacketReceiveBuffer()
-                            : guard(), current_item(), buffer()
+                            : guard(), current_item(), buffer(), spent()
                     {
                     }
 
@@ -54,31 +59,50 @@ namespace smooth
                     {
                         std::lock_guard<std::mutex> lock(guard);
                         current_item.data_received(length);
-                        if (current_item.is_complete())
-                        {
-                            buffer.put(current_item);
-                            in_progress = false;
-                        }
+                        store_if_complete();
+                    }
+
+                    int consume(const uint8_t* data, int length) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        int consumed = current_item.consume(data, length);
+                        store_if_complete();
+                        return consumed;
                     }
 
                     bool is_packet_complete() override
                     {
                         std::lock_guard<std::mutex> lock(guard);
-                        return current_item.is_complete();
+                        return packet_complete;
                     }
 
                     bool get(Packet& target) override
                     {
                         std::lock_guard<std::mutex> lock(guard);
-                        return buffer.get(target);
+                        bool res = !buffer.is_empty();
+
+                        if (res)
+                        {
+                            // Keep the memory of the packet the target held until now for assembly of a later packet.
+                            spent.put(std::move(target));
+                            buffer.get(target);
+                        }
+
+                        return res;
                     }
 
                     void clear() override
                     {
                         std::lock_guard<std::mutex> lock(guard);
-                        buffer.clear();
+                        Packet p;
+                        while (buffer.get(p))
+                        {
+                            spent.put(std::move(p));
+                        }
+
                         // Clear out any packets in progress too.
                         in_progress = false;
+                        packet_complete = false;
                         ReplacePacketWithDefault();
                     }
 
@@ -94,12 +118,20 @@ namespace smooth
                         // Use placement new to prepare a new instance, but first destroy the current one.
                         ReplacePacketWithDefault();
                         in_progress = true;
+                        packet_complete = false;
                     }
 
                     void ReplacePacketWithDefault()
                     {
-                        current_item.~Packet();
-                        new(&current_item) Packet();
+                        // Prefer a recycled packet, which keeps the memory it has already allocated.
+                        spent.get(current_item);
+
+                        if (!current_item.prepare_for_reuse())
+                        {
+                            // Use placement new to prepare a new instance, but first destroy the current one.
+                            current_item.~Packet();
+                            new(&current_item) Packet();
+                        }
                     }
 
                     bool is_error() override
@@ -109,10 +141,25 @@ namespace smooth
                     }
 
                 private:
+                    void store_if_complete()
+                    {
+                        if (current_item.is_complete())
+                        {
+                            // The packet is replaced before assembly of the next one starts, so move it
+                            // into the buffer instead of copying it.
+                            buffer.put(std::move(current_item));
+                            in_progress = false;
+                            packet_complete = true;
+                        }
+                    }
+
                     std::mutex guard;
                     bool in_progress = false;
+                    bool packet_complete = false;
                     Packet current_item;
                     smooth::core::util::CircularBuffer<Packet, Size> buffer;
+                    // Packets given back by get(), one for each that can be in circulation.
+                    smooth::core::util::CircularBuffer<Packet, Size + 1> spent;
             };
         }
     }
@@ -32,7 +32,7 @@ namespace smooth
                     {
                     }
 
-                    bool put(const Packet& item)
+                    bool put(const Packet& item) override
                     {
                         std::lock_guard<std::mutex> lock(guard);
                         bool res = !buffer.is_full();
@@ -43,6 +43,17 @@ namespace smooth
                         return res;
                     }
 
+                    bool put(Packet&& item) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        bool res = !buffer.is_full();
+                        if (res)
+                        {
+                            buffer.put(std::move(item));
+                        }
+                        return res;
+                    }
+
                     bool is_in_progress() override
                     {
                         std::lock_guard<std::mutex> lock(guard);
@@ -58,17 +69,28 @@ namespace smooth
                     size_t get_remaining_data_length() override
                     {
                         std::lock_guard<std::mutex> lock(guard);
-                        return current_item.get_send_length() - bytes_sent;
+                        auto length = static_cast<size_t>(current_item.get_send_length());
+                        return bytes_sent < length ? length - bytes_sent : 0;
                     }
 
-                    void data_has_been_sent(size_t length) override
+                    std::shared_ptr<const ExternalPayload> get_current_payload(size_t& offset) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        auto length = static_cast<size_t>(current_item.get_send_length());
+                        offset = bytes_sent > length ? bytes_sent - length : 0;
+                        return current_item.get_external_payload();
+                    }
+
+                    int data_has_been_sent(size_t length) override
                     {
                         std::lock_guard<std::mutex> lock(guard);
                         bytes_sent += length;
-                        if(current_item.get_send_length() >= bytes_sent)
+                        if (bytes_sent >= current_item.get_total_send_length())
                         {
                             in_progress = false;
                         }
+
+                        return in_progress ? 0 : 1;
                     }
 
                     void prepare_next_packet() override
@@ -0,0 +1,212 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include "IPacketReceiveBuffer.h"
+#include "PacketPool.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// PooledPacketReceiveBuffer is a receive buffer which, instead of holding a fixed number of packets
+            /// of its own, borrows a packet from a PacketPool when assembly of a new packet starts and gives it
+            /// back once the application has retrieved it. The packet is assembled in place, so completing it
+            /// involves no copying. While the pool is exhausted, the buffer reports itself as full so that the
+            /// socket leaves incoming data in the network stack until a packet is available again.
+            /// Packet must provide the IPacketAssembly interface (either directly or via inheritance) and
+            /// fulfill the contract of the PacketPool.
+            /// \tparam Packet The type of packet to assemble
+            template<typename Packet>
+            class PooledPacketReceiveBuffer
+                    : public IPacketReceiveBuffer<Packet>
+            {
+                public:
+                    /// Constructor
+                    /// \param pool The pool to borrow packets from.
+                    /// \param max_packets The maximum number of completed packets this buffer may hold at the
+                    /// same time, so that a single socket can't exhaust the pool.
+                    PooledPacketReceiveBuffer(PacketPool<Packet>& pool, int max_packets)
+                            : pool(pool), slots(static_cast<size_t>(max_packets))
+                    {
+                        // Includes the packet being assembled.
+                        stats.capacity = max_packets + 1;
+                    }
+
+                    ~PooledPacketReceiveBuffer()
+                    {
+                        clear();
+                    }
+
+                    bool is_full() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return count >= static_cast<int>(slots.size()) || !borrow_current();
+                    }
+
+                    int amount_wanted() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return borrow_current() ? current->get_wanted_amount() : 0;
+                    }
+
+                    uint8_t* get_write_pos() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return borrow_current() ? current->get_write_pos() : nullptr;
+                    }
+
+                    void data_received(int length) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        if (current)
+                        {
+                            current->data_received(length);
+                            store_if_complete();
+                        }
+                    }
+
+                    int consume(const uint8_t* data, int length) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        int consumed = 0;
+
+                        if (borrow_current())
+                        {
+                            consumed = current->consume(data, length);
+                            store_if_complete();
+                        }
+
+                        return consumed;
+                    }
+
+                    bool is_packet_complete() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return packet_complete;
+                    }
+
+                    bool get(Packet& target) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        bool res = count > 0;
+
+                        if (res)
+                        {
+                            target = std::move(*slots[read_ix]);
+                            give_back(slots[read_ix]);
+                            read_ix = (read_ix + 1) % slots.size();
+                            --count;
+                        }
+
+                        return res;
+                    }
+
+                    void clear() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+
+                        while (count > 0)
+                        {
+                            give_back(slots[read_ix]);
+                            read_ix = (read_ix + 1) % slots.size();
+                            --count;
+                        }
+
+                        read_ix = 0;
+                        // Clear out any packets in progress too.
+                        give_back(current);
+                        in_progress = false;
+                        packet_complete = false;
+                    }
+
+                    bool is_in_progress() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return in_progress;
+                    }
+
+                    void prepare_new_packet() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        // A packet is borrowed once there is data to assemble.
+                        give_back(current);
+                        in_progress = true;
+                        packet_complete = false;
+                    }
+
+                    bool is_error() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return current && current->is_error();
+                    }
+
+                    /// Gets the usage statistics of this buffer.
+                    /// \return The statistics
+                    PacketPoolStatistics get_statistics()
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return stats;
+                    }
+
+                private:
+                    bool borrow_current()
+                    {
+                        if (!current)
+                        {
+                            current = pool.borrow();
+
+                            if (current)
+                            {
+                                stats.on_borrow();
+                            }
+                            else
+                            {
+                                ++stats.exhausted;
+                            }
+                        }
+
+                        return current != nullptr;
+                    }
+
+                    void give_back(std::unique_ptr<Packet>& packet)
+                    {
+                        if (packet)
+                        {
+                            pool.give_back(std::move(packet));
+                            stats.on_give_back();
+                        }
+                    }
+
+                    void store_if_complete()
+                    {
+                        if (current->is_complete())
+                        {
+                            // Hand over the borrowed packet as is; the next one is borrowed when needed.
+                            slots[(read_ix + static_cast<size_t>(count)) % slots.size()] = std::move(current);
+                            ++count;
+                            in_progress = false;
+                            packet_complete = true;
+                        }
+                    }
+
+                    PacketPool<Packet>& pool;
+                    std::mutex guard{};
+                    std::vector<std::unique_ptr<Packet>> slots;
+                    size_t read_ix = 0;
+                    int count = 0;
+                    std::unique_ptr<Packet> current{};
+                    bool in_progress = false;
+                    bool packet_complete = false;
+                    PacketPoolStatistics stats{};
+            };
+        }
+    }
+}
@@ -0,0 +1,193 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "IPacketSendBuffer.h"
+#include "PacketPool.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// PooledPacketSendBuffer is a send buffer which, instead of holding a fixed number of packets of its
+            /// own, borrows a packet from a PacketPool for each queued packet and gives it back once sent.
+            /// Packet must provide the IPacketDisassembly interface (either directly or via inheritance) and
+            /// fulfill the contract of the PacketPool.
+            /// \tparam Packet The packet type
+            template<typename Packet>
+            class PooledPacketSendBuffer
+                    : public IPacketSendBuffer<Packet>
+            {
+                public:
+                    /// Constructor
+                    /// \param pool The pool to borrow packets from.
+                    /// \param max_packets The maximum number of packets this buffer may hold at the same time,
+                    /// so that a single socket can't exhaust the pool.
+                    PooledPacketSendBuffer(PacketPool<Packet>& pool, int max_packets)
+                            : pool(pool), slots(static_cast<size_t>(max_packets))
+                    {
+                        stats.capacity = max_packets;
+                    }
+
+                    ~PooledPacketSendBuffer() override
+                    {
+                        clear();
+                    }
+
+                    bool put(const Packet& item) override
+                    {
+                        Packet copy(item);
+                        return put(std::move(copy));
+                    }
+
+                    bool put(Packet&& item) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+
+                        bool res = count < static_cast<int>(slots.size());
+                        if (res)
+                        {
+                            auto packet = pool.borrow();
+                            res = packet != nullptr;
+
+                            if (res)
+                            {
+                                // The item gets the memory kept by the pooled packet in exchange, so that a caller
+                                // that fills the same item again doesn't have to allocate.
+                                std::swap(*packet, item);
+                                slots[index(count)] = std::move(packet);
+                                ++count;
+                                stats.on_borrow();
+                            }
+                        }
+
+                        if (!res)
+                        {
+                            ++stats.exhausted;
+                        }
+
+                        return res;
+                    }
+
+                    bool is_in_progress() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return current != nullptr;
+                    }
+
+                    const uint8_t* get_data_to_send() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return current->get_data() + bytes_sent;
+                    }
+
+                    size_t get_remaining_data_length() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        auto length = static_cast<size_t>(current->get_send_length());
+                        return bytes_sent < length ? length - bytes_sent : 0;
+                    }
+
+                    std::shared_ptr<const ExternalPayload> get_current_payload(size_t& offset) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        auto length = static_cast<size_t>(current->get_send_length());
+                        offset = bytes_sent > length ? bytes_sent - length : 0;
+                        return current->get_external_payload();
+                    }
+
+                    int data_has_been_sent(size_t length) override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        bytes_sent += length;
+                        int completed = 0;
+
+                        if (bytes_sent >= current->get_total_send_length())
+                        {
+                            give_back_current();
+                            completed = 1;
+                        }
+
+                        return completed;
+                    }
+
+                    void prepare_next_packet() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        give_back_current();
+
+                        if (count > 0)
+                        {
+                            current = std::move(slots[read_ix]);
+                            read_ix = index(1);
+                            --count;
+                        }
+                    }
+
+                    void clear() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        give_back_current();
+
+                        while (count > 0)
+                        {
+                            pool.give_back(std::move(slots[read_ix]));
+                            stats.on_give_back();
+                            read_ix = index(1);
+                            --count;
+                        }
+
+                        read_ix = 0;
+                    }
+
+                    bool is_empty() override
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return current == nullptr && count == 0;
+                    }
+
+                    /// Gets the usage statistics of this buffer.
+                    /// \return The statistics
+                    PacketPoolStatistics get_statistics()
+                    {
+                        std::lock_guard<std::mutex> lock(guard);
+                        return stats;
+                    }
+
+                private:
+                    size_t index(int offset) const
+                    {
+                        return (read_ix + static_cast<size_t>(offset)) % slots.size();
+                    }
+
+                    void give_back_current()
+                    {
+                        if (current)
+                        {
+                            pool.give_back(std::move(current));
+                            stats.on_give_back();
+                        }
+
+                        bytes_sent = 0;
+                    }
+
+                    PacketPool<Packet>& pool;
+                    std::mutex guard{};
+                    std::vector<std::unique_ptr<Packet>> slots;
+                    size_t read_ix = 0;
+                    int count = 0;
+                    std::unique_ptr<Packet> current{};
+                    size_t bytes_sent = 0;
+                    PacketPoolStatistics stats{};
+            };
+        }
+    }
+}
@@ -0,0 +1,366 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cerrno>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include "Socket.h"
+#include "TlsContext.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// SecureSocket is used to perform TLS encrypted TCP/IP communication. The TLS handshake is performed
+            /// non-blocking within the SocketDispatcher once the TCP connection is established and the connection
+            /// is not reported as connected until the handshake has completed. Incoming data is decrypted directly
+            /// into the receive staging buffer (or the packet being assembled), so no additional buffers are used.
+            /// When the TLS context verifies the peer, the server certificate must also be issued for the server name
+            /// given to create(). On ESP_PLATFORM the OpenSSL wrapper in IDF lacks the means to check the name, so
+            /// there any certificate signed by a trusted CA is accepted.
+            /// \tparam Packet The type of the packet used for communication on this socket
+            template<typename Packet>
+            class SecureSocket
+                    : public Socket<Packet>
+            {
+                public:
+                    /// Creates a socket for secure network communication, with the specified packet type.
+                    /// \param tx_buffer The transmit buffer where outgoing packets are put by the application.
+                    /// \param rx_buffer The receive buffer used when receiving data
+                    /// \param tx_empty The response queue onto which events are put when all outgoing packets are sent.
+                    /// \param data_available The response queue onto which events are put when data is available.
+                    /// \param connection_status The response queue into which events are put when a change in the connection
+                    /// state is detected.
+                    /// \param tls_context The TLS configuration to use. Sessions are saved in the context so that
+                    /// later connections to the same server, also by other sockets, can resume them.
+                    /// \param server_name The host name or IP address of the server, used for SNI, to verify the server
+                    /// certificate and as key for session resumption. Required if the TLS context verifies the peer;
+                    /// without it, connecting fails.
+                    /// \param send_timeout See Socket::create()
+                    /// \param receive_buffer_size See Socket::create()
+                    /// \param connect_timeout See Socket::create()
+                    /// \param options See Socket::create()
+                    /// \return a std::shared_ptr pointing to an instance of a ISocket object, or nullptr if no socket could be
+                    /// created.
+                    static std::shared_ptr<ISocket>
+                    create(IPacketSendBuffer<Packet>& tx_buffer, IPacketReceiveBuffer<Packet>& rx_buffer,
+                           smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                           smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                           smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                           std::shared_ptr<TlsContext> tls_context,
+                           const std::string& server_name = "",
+                           std::chrono::milliseconds send_timeout = std::chrono::milliseconds(1500),
+                           int receive_buffer_size = 0,
+                           std::chrono::milliseconds connect_timeout = std::chrono::seconds(10),
+                           const SocketOptions& options = SocketOptions());
+
+                    ~SecureSocket() override
+                    {
+                        free_ssl();
+                    }
+
+                protected:
+                    SecureSocket(IPacketSendBuffer<Packet>& tx_buffer, IPacketReceiveBuffer<Packet>& rx_buffer,
+                                 smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                                 smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                                 smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                                 std::shared_ptr<TlsContext> tls_context,
+                                 const std::string& server_name,
+                                 std::chrono::milliseconds send_timeout,
+                                 int receive_buffer_size,
+                                 std::chrono::milliseconds connect_timeout,
+                                 const SocketOptions& options);
+
+                    int receive(uint8_t* target, int max_length) override;
+
+                    int transmit(const iovec* vectors, int count) override;
+
+                    bool can_send_directly() override
+                    {
+                        // Data must pass through the TLS layer.
+                        return false;
+                    }
+
+                    bool establish_session() override;
+
+                    bool session_wants_write() override
+                    {
+                        return handshake_wants_write;
+                    }
+
+                    bool has_buffered_input() override
+                    {
+                        return ssl != nullptr && SSL_pending(ssl) > 0;
+                    }
+
+                    void clear_socket_id() override;
+
+                private:
+                    bool create_ssl();
+                    int translate_result(int res);
+                    void free_ssl();
+
+                    std::shared_ptr<TlsContext> tls_context;
+                    std::string server_name;
+                    SSL* ssl = nullptr;
+                    bool handshake_wants_write = false;
+            };
+
+            template<typename Packet>
+            std::shared_ptr<ISocket>
+            SecureSocket<Packet>::create(IPacketSendBuffer<Packet>& tx_buffer, IPacketReceiveBuffer<Packet>& rx_buffer,
+                                         smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                                         smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                                         smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                                         std::shared_ptr<TlsContext> tls_context,
+                                         const std::string& server_name,
+                                         std::chrono::milliseconds send_timeout,
+                                         int receive_buffer_size,
+                                         std::chrono::milliseconds connect_timeout,
+                                         const SocketOptions& options)
+            {
+                // This class is solely used to enabled access to the protected SecureSocket<Packet> constructor from std::make_shared<>
+                class MakeSharedActivator
+                        : public SecureSocket<Packet>
+                {
+                    public:
+                        MakeSharedActivator(IPacketSendBuffer<Packet>& tx_buffer,
+                                            IPacketReceiveBuffer<Packet>& rx_buffer,
+                                            smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                                            smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                                            smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                                            std::shared_ptr<TlsContext> tls_context,
+                                            const std::string& server_name,
+                                            std::chrono::milliseconds send_timeout,
+                                            int receive_buffer_size,
+                                            std::chrono::milliseconds connect_timeout,
+                                            const SocketOptions& options)
+                                : SecureSocket<Packet>(tx_buffer, rx_buffer, tx_empty, data_available, connection_status,
+                                                       tls_context, server_name, send_timeout, receive_buffer_size,
+                                                       connect_timeout, options)
+                        {
+                        }
+
+                };
+
+                std::shared_ptr<ISocket> s;
+
+                if (tls_context && tls_context->is_valid())
+                {
+                    s = std::make_shared<MakeSharedActivator>(tx_buffer,
+                                                              rx_buffer,
+                                                              tx_empty,
+                                                              data_available,
+                                                              connection_status,
+                                                              tls_context,
+                                                              server_name,
+                                                              send_timeout,
+                                                              receive_buffer_size,
+                                                              connect_timeout,
+                                                              options);
+                }
+
+                return s;
+            }
+
+            template<typename Packet>
+            SecureSocket<Packet>::SecureSocket(IPacketSendBuffer<Packet>& tx_buffer,
+                                               IPacketReceiveBuffer<Packet>& rx_buffer,
+                                               smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
+                                               smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
+                                               smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
+                                               std::shared_ptr<TlsContext> tls_context,
+                                               const std::string& server_name,
+                                               std::chrono::milliseconds send_timeout,
+                                               int receive_buffer_size,
+                                               std::chrono::milliseconds connect_timeout,
+                                               const SocketOptions& options)
+                    : Socket<Packet>(tx_buffer, rx_buffer, tx_empty, data_available, connection_status,
+                                     send_timeout, receive_buffer_size, connect_timeout, options),
+                      tls_context(tls_context),
+                      server_name(server_name)
+            {
+            }
+
+            template<typename Packet>
+            bool SecureSocket<Packet>::create_ssl()
+            {
+                // Created once connected, as the socket id may change while connecting.
+                handshake_wants_write = false;
+                bool res = false;
+
+                if (tls_context->is_verifying_peer() && server_name.empty())
+                {
+                    // Any certificate signed by a trusted CA would be accepted, whoever it was issued to.
+                    this->loge("A server name is required to verify the server certificate");
+                }
+                else
+                {
+                    ssl = SSL_new(tls_context->get_context());
+                    res = ssl != nullptr && SSL_set_fd(ssl, this->get_socket_id()) == 1;
+
+#ifndef ESP_PLATFORM
+                    if (res && !server_name.empty())
+                    {
+                        // An IP address is matched against the addresses in the certificate and is not sent
+                        // as SNI, which only takes host names.
+                        res = X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), server_name.c_str()) == 1
+                              || (SSL_set_tlsext_host_name(ssl, server_name.c_str()) == 1
+                                  && SSL_set1_host(ssl, server_name.c_str()) == 1);
+                    }
+#endif
+
+                    if (res)
+                    {
+                        SSL_set_connect_state(ssl);
+                        tls_context->resume_session(server_name, ssl);
+                    }
+                    else
+                    {
+                        this->loge("Failed to create TLS session");
+                        free_ssl();
+                    }
+                }
+
+                return res;
+            }
+
+            template<typename Packet>
+            bool SecureSocket<Packet>::establish_session()
+            {
+                bool established = false;
+
+                if (ssl == nullptr && !create_ssl())
+                {
+                    this->stop();
+                }
+                else
+                {
+#ifndef ESP_PLATFORM
+                    ERR_clear_error();
+#endif
+                    errno = 0;
+                    int res = SSL_connect(ssl);
+                    established = res == 1;
+
+                    if (established)
+                    {
+                        handshake_wants_write = false;
+#ifdef ESP_PLATFORM
+                        this->log("TLS session established");
+#else
+                        this->log(SSL_session_reused(ssl) ? "TLS session resumed" : "TLS session established");
+#endif
+                    }
+                    else
+                    {
+                        auto err = SSL_get_error(ssl, res);
+
+                        if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
+                        {
+                            handshake_wants_write = err == SSL_ERROR_WANT_WRITE;
+                        }
+                        else
+                        {
+                            this->loge("TLS handshake failed");
+                            this->stop();
+                        }
+                    }
+                }
+
+                return established;
+            }
+
+            template<typename Packet>
+            int SecureSocket<Packet>::receive(uint8_t* target, int max_length)
+            {
+#ifndef ESP_PLATFORM
+                ERR_clear_error();
+#endif
+                return translate_result(SSL_read(ssl, target, max_length));
+            }
+
+            template<typename Packet>
+            int SecureSocket<Packet>::transmit(const iovec* vectors, int count)
+            {
+                // Each SSL_write() produces at least one record, so send one vector at a time. A retry after
+                // SSL_ERROR_WANT_WRITE then also gets the same data, as required.
+                (void) count;
+#ifndef ESP_PLATFORM
+                ERR_clear_error();
+#endif
+                return translate_result(SSL_write(ssl, vectors[0].iov_base, static_cast<int>(vectors[0].iov_len)));
+            }
+
+            template<typename Packet>
+            int SecureSocket<Packet>::translate_result(int res)
+            {
+                // Map the result onto the semantics of recv()/send() expected by Socket<Packet>.
+                if (res <= 0)
+                {
+                    auto err = SSL_get_error(ssl, res);
+
+                    if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
+                    {
+                        errno = EWOULDBLOCK;
+                        res = -1;
+                    }
+                    else if (err == SSL_ERROR_ZERO_RETURN)
+                    {
+                        res = 0;
+                    }
+                    else
+                    {
+                        if (errno == 0)
+                        {
+                            errno = ECONNRESET;
+                        }
+
+                        res = -1;
+                    }
+                }
+
+                return res;
+            }
+
+            template<typename Packet>
+            void SecureSocket<Packet>::clear_socket_id()
+            {
+                if (ssl != nullptr)
+                {
+                    if (SSL_is_init_finished(ssl))
+                    {
+                        tls_context->save_session(server_name, ssl);
+                    }
+
+                    free_ssl();
+                }
+
+                Socket<Packet>::clear_socket_id();
+            }
+
+            template<typename Packet>
+            void SecureSocket<Packet>::free_ssl()
+            {
+                if (ssl != nullptr)
+                {
+#ifndef ESP_PLATFORM
+                    // The socket is already closed so no close_notify can be sent; mark the connection as
+                    // shut down so that OpenSSL doesn't invalidate the session for resumption when freeing it.
+                    SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+#endif
+                    SSL_free(ssl);
+                    ssl = nullptr;
+                }
+            }
+        }
+    }
+}
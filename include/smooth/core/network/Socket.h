@@ -8,16 +8,21 @@
 #include "InetAddress.h"
 #include "ISocket.h"
 #include <cstring>
+#include <algorithm>
 #include <array>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <chrono>
 #include <smooth/core/util/CircularBuffer.h>
+#include <smooth/core/util/ByteRing.h>
 #include <smooth/core/timer/ElapsedTime.h>
 #include <smooth/core/ipc/TaskEventQueue.h>
 #include <smooth/core/network/TransmitBufferEmptyEvent.h>
 #include <smooth/core/network/DataAvailableEvent.h>
 #include <smooth/core/network/PacketSendBuffer.h>
 #include <smooth/core/network/SocketDispatcher.h>
+#include <smooth/core/network/DnsResolver.h>
 #include <smooth/core/network/ConnectionStatusEvent.h>
 #include <smooth/core/logging/log.h>
 
@@ -25,10 +30,22 @@
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <netinet/in.h>
 #include <netinet/tcp.h>
 
 #endif
 
+#if defined(__linux__) && !defined(ESP_PLATFORM)
+// Sending of external payloads kept in files via sendfile()
+#define SMOOTH_HAS_SENDFILE
+#include <sys/sendfile.h>
+#ifdef MSG_ZEROCOPY
+// Sending of external payloads kept in memory via MSG_ZEROCOPY, with completions read from the error queue.
+#define SMOOTH_HAS_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
+#endif
+
 using namespace smooth::core::logging;
 
 namespace smooth
@@ -39,6 +56,10 @@ namespace smooth
         {
 
             /// Socket is used to perform TCP/IP communication.
+            /// When started with a HostName, the name is resolved via the DnsResolver and the socket then connects
+            /// to the resulting addresses Happy Eyeballs style (RFC 8305); if a connection attempt has not succeeded
+            /// within 250ms, an attempt to the next address (typically of the other address family) is started
+            /// in parallel and the first one to connect is used.
             /// \tparam Packet The type of the packet used for communication on this socket
             template<typename Packet>
             class Socket
@@ -59,6 +80,14 @@ namespace smooth
                     /// \param send_timeout The amount of time to wait for outgoing data to actually be sent to remote
                     /// endpoint (i.e. the maximum time between send() being called and the socket being writable again).
                     /// If this time is exceeded, the socket will be closed.
+                    /// \param receive_buffer_size Size, in bytes, of the staging buffer incoming data is read into. When
+                    /// non-zero, the socket reads as much data as fits into the staging buffer on each receive and the
+                    /// packets then assemble themselves from it via IPacketAssembly::consume(), meaning several small
+                    /// packets are received with a single call to recv(). When zero, the socket reads exactly the amount
+                    /// each packet asks for via IPacketAssembly::get_wanted_amount().
+                    /// \param connect_timeout The maximum time a connection attempt, including any session set up on top
+                    /// of the connection such as a TLS handshake, may take before the socket is closed.
+                    /// \param options Tuning options applied to the socket each time it connects.
                     /// \return a std::shared_ptr pointing to an instance of a ISocket object, or nullptr if no socket could be
                     /// created.
                     static std::shared_ptr<ISocket>
@@ -66,7 +95,10 @@ namespace smooth
                            smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
                            smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
                            smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
-                           std::chrono::milliseconds send_timeout = std::chrono::milliseconds(1500));
+                           std::chrono::milliseconds send_timeout = std::chrono::milliseconds(1500),
+                           int receive_buffer_size = 0,
+                           std::chrono::milliseconds connect_timeout = std::chrono::seconds(10),
+                           const SocketOptions& options = SocketOptions());
 
                     virtual ~Socket()
                     {
@@ -88,14 +120,70 @@ namespace smooth
                            smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
                            smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
                            smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
-                           std::chrono::milliseconds send_timeout);
+                           std::chrono::milliseconds send_timeout,
+                           int receive_buffer_size,
+                           std::chrono::milliseconds connect_timeout,
+                           const SocketOptions& options);
 
-                    virtual bool create_socket();
+                    /// Creates a non-blocking socket for connecting to the given address.
+                    /// \param address The address that is to be connected to.
+                    /// \return The socket id, or -1 on failure.
+                    virtual int create_socket(const std::shared_ptr<InetAddress>& address);
 
                     virtual void read_data(uint8_t* target, int max_length);
 
+                    virtual void read_to_staging();
+
+                    void assemble_staged_packets();
+
                     virtual void write_data();
 
+                    /// Receives data from the connection. Has the same semantics as recv(), i.e. returns the number of
+                    /// bytes received, 0 when the remote end has closed the connection or -1 on error with errno set,
+                    /// where EWOULDBLOCK means no data is available right now.
+                    virtual int receive(uint8_t* target, int max_length);
+
+                    /// Sends data on the connection. Has the same semantics as sendmsg(), i.e. returns the total
+                    /// number of bytes sent from the vectors, in order, or -1 on error with errno set.
+                    virtual int transmit(const iovec* vectors, int count);
+
+                    /// Returns true if data passed to transmit() is written to the connection as is, allowing
+                    /// external payloads to be handed straight to the kernel via sendfile() and MSG_ZEROCOPY.
+                    /// Sockets that transform the data, e.g. by encrypting it, must return false in which case
+                    /// external payloads are copied through transmit().
+                    virtual bool can_send_directly()
+                    {
+                        return true;
+                    }
+
+                    /// Called once the transport connection is established, and then on each readable/writable
+                    /// event until it returns true. Used to set up a session on top of the connection, e.g. a TLS
+                    /// handshake. The socket is not reported as connected to the application until the session is
+                    /// established.
+                    /// \return true when the session is established.
+                    virtual bool establish_session()
+                    {
+                        return true;
+                    }
+
+                    /// Returns true if establish_session() needs to wait for the socket to become writable.
+                    virtual bool session_wants_write()
+                    {
+                        return false;
+                    }
+
+                    /// Returns true if data has already been read from the connection by a lower layer but not yet
+                    /// been passed on via receive(), e.g. decrypted data buffered by a TLS implementation.
+                    virtual bool has_buffered_input()
+                    {
+                        return false;
+                    }
+
+                    bool is_session_established() const
+                    {
+                        return session_established;
+                    }
+
                     int get_socket_id() override
                     {
                         return socket_id;
@@ -107,40 +195,107 @@ namespace smooth
                                && elapsed_send_time.get_running_time() > send_timeout;
                     }
 
-                    IPacketSendBuffer<Packet>& tx_buffer;
-                    IPacketReceiveBuffer<Packet>& rx_buffer;
-                    smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available;
-                    smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty;
+                    std::chrono::milliseconds get_send_time_left() const override
+                    {
+                        auto left = std::chrono::milliseconds::max();
 
-                private:
+                        if (elapsed_send_time.is_running())
+                        {
+                            auto running = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    elapsed_send_time.get_running_time());
+                            left = has_send_expired()
+                                   ? std::chrono::milliseconds(0)
+                                   : std::max(send_timeout - running, std::chrono::milliseconds(1));
+                        }
 
-                    bool internal_start() override;
+                        return left;
+                    }
 
                     bool is_connected() override
                     {
                         return connected;
                     }
 
-                    bool set_non_blocking();
-
                     bool has_data_to_transmit() override
                     {
                         // Also check on connected state so that we don't try to send data
                         // when the socket just has been closed while in SocketDispatcher::tick()
-                        return connected && !tx_buffer.is_empty();
+                        return connected
+                               && (session_established ? !tx_buffer.is_empty() : session_wants_write());
+                    }
+
+                    void clear_socket_id() override;
+
+                    int get_alternate_socket_id() override
+                    {
+                        return alternate_socket_id;
                     }
 
+                    bool check_connection_attempts() override;
+
                     void log(const char* message);
                     void loge(const char* message);
 
+                    IPacketSendBuffer<Packet>& tx_buffer;
+                    IPacketReceiveBuffer<Packet>& rx_buffer;
+                    smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available;
+                    smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty;
+
+                private:
+
+                    bool internal_start() override;
+
+                    bool set_non_blocking(int id);
+
+                    void resolved(uint32_t request, const AddressList& resolved_addresses);
+
+                    bool connect_next(int& id);
+
+                    bool is_connect_complete(int id, bool& failed);
+
+                    void check_connect_result();
+
+                    void close_alternate();
+
+                    bool has_staged_input() override
+                    {
+                        return started && (!rx_staging.is_empty() || (session_established && has_buffered_input()));
+                    }
+
+                    bool has_pending_input() override
+                    {
+                        // Staged or buffered data that couldn't be assembled because the receive buffer was full.
+                        return has_staged_input() && !rx_buffer.is_full();
+                    }
+
+                    void try_establish_session();
+
+                    void packet_assembled();
+
+                    void update_send_statistics(size_t offered, size_t amount_sent, int completed);
+
+                    int transmit_file(const ExternalPayload& payload, size_t offset);
+
+                    bool use_zero_copy(const ExternalPayload& payload);
+
+                    int transmit_zero_copy(const iovec* vectors, int count,
+                                           const std::shared_ptr<const ExternalPayload>& payload);
+
+                    void release_zero_copy_completions();
+
+                    SocketStatistics& get_statistics() override
+                    {
+                        return statistics;
+                    }
+
                     void publish_connected_status() override;
                     int socket_id = -1;
                     std::shared_ptr<InetAddress> ip;
                     bool started = false;
                     bool connected = false;
+                    bool session_established = false;
                     smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status;
                     void stop_internal() override;
-                    void clear_socket_id() override;
 #ifdef ESP_PLATFORM
                     // lwip doesn't signal SIGPIPE
                     const int SEND_FLAGS = 0;
@@ -149,7 +304,34 @@ namespace smooth
                     const int SEND_FLAGS = MSG_NOSIGNAL;
 #endif
                     std::chrono::milliseconds send_timeout;
+                    std::chrono::milliseconds connect_timeout;
+                    SocketOptions options;
+                    bool corked = false;
                     smooth::core::timer::ElapsedTime elapsed_send_time{};
+                    smooth::core::util::ByteRing rx_staging;
+                    std::mutex address_guard{};
+                    AddressList addresses{};
+                    uint32_t resolve_request = 0;
+                    AddressList candidates{};
+                    int alternate_socket_id = -1;
+                    smooth::core::timer::ElapsedTime connect_time{};
+                    // Connection Attempt Delay, RFC 8305 section 5.
+                    const std::chrono::milliseconds connection_attempt_delay{250};
+                    static const int max_send_vectors = 8;
+                    SocketStatistics statistics{};
+                    bool reported_connected = false;
+                    smooth::core::timer::ElapsedTime connection_time{};
+                    smooth::core::timer::ElapsedTime packet_send_time{};
+                    smooth::core::timer::ElapsedTime packet_receive_time{};
+                    // Payloads in files are copied through this buffer when they can't be sent directly.
+                    std::vector<uint8_t> file_chunk{};
+                    const size_t file_chunk_size = 4096;
+#ifdef SMOOTH_HAS_ZEROCOPY
+                    // Payloads handed to the kernel by zero-copy sends, kept until the kernel reports that it is done
+                    // with them. Each zero-copy send on a socket is numbered, starting at zero.
+                    std::deque<std::pair<uint32_t, std::shared_ptr<const ExternalPayload>>> zero_copy_pending{};
+                    uint32_t zero_copy_next_id = 0;
+#endif
             };
 
 
@@ -159,7 +341,10 @@ namespace smooth
                                                             smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
                                                             smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
                                                             smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
-                                                            std::chrono::milliseconds send_timeout)
+                                                            std::chrono::milliseconds send_timeout,
+                                                            int receive_buffer_size,
+                                                            std::chrono::milliseconds connect_timeout,
+                                                            const SocketOptions& options)
             {
 
                 // This class is solely used to enabled access to the protected Socket<Packet> constructor from std::make_shared<>
@@ -172,9 +357,12 @@ namespace smooth
                                             smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
                                             smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
                                             smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
-                                            std::chrono::milliseconds send_timeout)
+                                            std::chrono::milliseconds send_timeout,
+                                            int receive_buffer_size,
+                                            std::chrono::milliseconds connect_timeout,
+                                            const SocketOptions& options)
                                 : Socket<Packet>(tx_buffer, rx_buffer, tx_empty, data_available, connection_status,
-                                                 send_timeout)
+                                                 send_timeout, receive_buffer_size, connect_timeout, options)
                         {
                         }
 
@@ -185,7 +373,10 @@ namespace smooth
                                                                                    tx_empty,
                                                                                    data_available,
                                                                                    connection_status,
-                                                                                   send_timeout);
+                                                                                   send_timeout,
+                                                                                   receive_buffer_size,
+                                                                                   connect_timeout,
+                                                                                   options);
                 return s;
             }
 
@@ -194,7 +385,10 @@ namespace smooth
                                    smooth::core::ipc::TaskEventQueue<smooth::core::network::TransmitBufferEmptyEvent>& tx_empty,
                                    smooth::core::ipc::TaskEventQueue<smooth::core::network::DataAvailableEvent<Packet>>& data_available,
                                    smooth::core::ipc::TaskEventQueue<smooth::core::network::ConnectionStatusEvent>& connection_status,
-                                   std::chrono::milliseconds send_timeout
+                                   std::chrono::milliseconds send_timeout,
+                                   int receive_buffer_size,
+                                   std::chrono::milliseconds connect_timeout,
+                                   const SocketOptions& options
             )
                     :
                     tx_buffer(tx_buffer),
@@ -202,7 +396,10 @@ namespace smooth
                     data_available(data_available),
                     tx_empty(tx_empty),
                     connection_status(connection_status),
-                    send_timeout(send_timeout)
+                    send_timeout(send_timeout),
+                    connect_timeout(connect_timeout),
+                    options(options),
+                    rx_staging(static_cast<size_t>(std::max(0, receive_buffer_size)))
             {
             }
 
@@ -217,13 +414,58 @@ namespace smooth
                     res = ip->is_valid();
                     if (res)
                     {
-                        SocketDispatcher::instance().perform_op(SocketOperation::Op::Start, shared_from_this());
+                        uint32_t request;
+                        {
+                            std::lock_guard<std::mutex> lock(address_guard);
+                            request = ++resolve_request;
+                            addresses.clear();
+                        }
+
+                        if (ip->is_resolved())
+                        {
+                            resolved(request, AddressList{ip});
+                        }
+                        else
+                        {
+                            std::weak_ptr<ISocket> self = shared_from_this();
+                            DnsResolver::instance().resolve(ip->get_ip_as_string(),
+                                                            static_cast<uint16_t>(ip->get_port()),
+                                                            [self, request](const AddressList& resolved_addresses)
+                                                            {
+                                                                auto s = self.lock();
+                                                                if (s)
+                                                                {
+                                                                    std::static_pointer_cast<Socket<Packet>>(s)
+                                                                            ->resolved(request, resolved_addresses);
+                                                                }
+                                                            });
+                        }
                     }
                 }
 
                 return res;
             }
 
+            template<typename Packet>
+            void Socket<Packet>::resolved(uint32_t request, const AddressList& resolved_addresses)
+            {
+                bool current;
+                {
+                    std::lock_guard<std::mutex> lock(address_guard);
+                    // Ignore the result if the socket has been stopped or restarted while resolving.
+                    current = request == resolve_request;
+                    if (current)
+                    {
+                        addresses = resolved_addresses;
+                    }
+                }
+
+                if (current)
+                {
+                    SocketDispatcher::instance().perform_op(SocketOperation::Op::Start, shared_from_this());
+                }
+            }
+
             template<typename Packet>
             bool Socket<Packet>::restart()
             {
@@ -232,53 +474,46 @@ namespace smooth
             }
 
             template<typename Packet>
-            bool Socket<Packet>::create_socket()
+            int Socket<Packet>::create_socket(const std::shared_ptr<InetAddress>& address)
             {
-                bool res = false;
+                int id = socket(address->get_protocol_family(), SOCK_STREAM, 0);
 
-                if (socket_id < 0)
+                if (id == -1)
                 {
-                    socket_id = socket(ip->get_protocol_family(), SOCK_STREAM, 0);
-
-                    if (socket_id == -1)
+                    loge("Failed to create socket");
+                }
+                else
+                {
+                    bool res = set_non_blocking(id);
+                    if (res)
                     {
-                        loge("Failed to create socket");
+                        statistics.applied_options = options.apply(id, address->get_protocol_family());
+                        corked = false;
+                        log("Created socket");
                     }
                     else
                     {
-                        res = set_non_blocking();
-                        int no_delay = 1;
-                        res &= setsockopt(socket_id, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)) == 0;
-                        if (res)
-                        {
-                            log("Created socket");
-                        }
-                        else
-                        {
-                            loge("Failed to set socket options");
-                        }
+                        loge("Failed to set socket options");
+                        close(id);
+                        id = -1;
                     }
                 }
-                else
-                {
-                    res = true;
-                }
 
-                return res;
+                return id;
             }
 
             template<typename Packet>
-            bool Socket<Packet>::set_non_blocking()
+            bool Socket<Packet>::set_non_blocking(int id)
             {
                 bool res = true;
 
-                auto opts = fcntl(socket_id, F_GETFL, 0);
+                auto opts = fcntl(id, F_GETFL, 0);
                 if (opts < 0)
                 {
                     loge("Could not get socket flags");
                     res = false;
                 }
-                else if (fcntl(socket_id, F_SETFL, opts | O_NONBLOCK) < 0)
+                else if (fcntl(id, F_SETFL, opts | O_NONBLOCK) < 0)
                 {
                     loge("Could not set non blocking flag");
                     res = false;
@@ -290,13 +525,31 @@ namespace smooth
             template<typename Packet>
             void Socket<Packet>::readable()
             {
-                if (started && !rx_buffer.is_full())
+                if (started && !session_established)
                 {
-                    // How much data to assemble the current packet?
-                    int wanted_length = rx_buffer.amount_wanted();
+                    try_establish_session();
+                }
+                else if (started)
+                {
+                    if (rx_staging.size() > 0)
+                    {
+                        read_to_staging();
+                    }
+                    else if (!rx_buffer.is_full())
+                    {
+                        // How much data to assemble the current packet?
+                        int wanted_length = rx_buffer.amount_wanted();
 
-                    // Try to read the desired amount
-                    read_data(rx_buffer.get_write_pos(), wanted_length);
+                        // Try to read the desired amount
+                        read_data(rx_buffer.get_write_pos(), wanted_length);
+                    }
+
+                    release_zero_copy_completions();
+
+                    if (started && statistics.applied_options.quick_ack)
+                    {
+                        SocketOptions::set_quick_ack(socket_id);
+                    }
                 }
             }
 
@@ -309,12 +562,18 @@ namespace smooth
 
                     if (!connected && socket_id >= 0)
                     {
-                        // Just connected
-                        connected = true;
-                        publish_connected_status();
-                    }
+                        check_connect_result();
 
-                    if (connected)
+                        if (connected)
+                        {
+                            try_establish_session();
+                        }
+                    }
+                    else if (connected && !session_established)
+                    {
+                        try_establish_session();
+                    }
+                    else if (connected)
                     {
                         // Any data to send?
                         if (tx_buffer.is_empty())
@@ -328,11 +587,25 @@ namespace smooth
                             if (!tx_buffer.is_in_progress())
                             {
                                 tx_buffer.prepare_next_packet();
+                                packet_send_time.start();
                             }
 
                             if (tx_buffer.is_in_progress())
                             {
+                                if (statistics.applied_options.cork_batches && !corked)
+                                {
+                                    // Hold back partial frames for as long as there are more packets to send.
+                                    SocketOptions::set_cork(socket_id, true);
+                                    corked = true;
+                                }
+
                                 write_data();
+
+                                if (corked && started && tx_buffer.is_empty())
+                                {
+                                    SocketOptions::set_cork(socket_id, false);
+                                    corked = false;
+                                }
                             }
                         }
                     }
@@ -344,7 +617,7 @@ namespace smooth
             {
                 errno = 0;
                 // Try to read the desired amount
-                int read_count = recv(socket_id, target, max_length, 0);
+                int read_count = receive(target, max_length);
 
                 if (read_count == -1)
                 {
@@ -354,8 +627,19 @@ namespace smooth
                         stop();
                     }
                 }
+                else if (read_count == 0 && max_length > 0)
+                {
+                    log("Connection closed by remote end");
+                    stop();
+                }
                 else if (read_count > 0)
                 {
+                    statistics.bytes_received += static_cast<uint64_t>(read_count);
+                    if (!packet_receive_time.is_running())
+                    {
+                        packet_receive_time.start();
+                    }
+
                     rx_buffer.data_received(read_count);
                     if (rx_buffer.is_error())
                     {
@@ -364,12 +648,124 @@ namespace smooth
                     }
                     else if (rx_buffer.is_packet_complete())
                     {
-                        DataAvailableEvent<Packet> d(&rx_buffer);
-                        data_available.push(d);
-                        rx_buffer.prepare_new_packet();
+                        packet_assembled();
+                    }
+                }
+
+            }
+
+            template<typename Packet>
+            void Socket<Packet>::read_to_staging()
+            {
+                // First assemble what is left from the previous read, then read as much as will fit.
+                assemble_staged_packets();
+
+                if (started && !rx_buffer.is_full() && !rx_staging.is_full())
+                {
+                    errno = 0;
+                    int read_count = receive(rx_staging.get_write_pos(),
+                                             static_cast<int>(rx_staging.get_contiguous_write_length()));
+
+                    if (read_count == -1)
+                    {
+                        if (errno != EWOULDBLOCK)
+                        {
+                            loge("Error during receive");
+                            stop();
+                        }
+                    }
+                    else if (read_count == 0)
+                    {
+                        log("Connection closed by remote end");
+                        stop();
+                    }
+                    else if (read_count > 0)
+                    {
+                        statistics.bytes_received += static_cast<uint64_t>(read_count);
+                        rx_staging.data_written(static_cast<size_t>(read_count));
+                        assemble_staged_packets();
+                    }
+                }
+            }
+
+            template<typename Packet>
+            void Socket<Packet>::assemble_staged_packets()
+            {
+                bool progress = true;
+
+                // Data that doesn't fit into the receive buffer stays staged until the application
+                // has made room for it, see has_pending_input().
+                while (progress && started && !rx_staging.is_empty() && !rx_buffer.is_full())
+                {
+                    if (!packet_receive_time.is_running())
+                    {
+                        packet_receive_time.start();
+                    }
+
+                    auto consumed = rx_buffer.consume(rx_staging.get_read_pos(),
+                                                      static_cast<int>(rx_staging.get_contiguous_read_length()));
+                    rx_staging.data_consumed(static_cast<size_t>(consumed));
+
+                    if (rx_buffer.is_error())
+                    {
+                        log("Assembly error");
+                        stop();
+                    }
+                    else if (rx_buffer.is_packet_complete())
+                    {
+                        packet_assembled();
+                    }
+                    else
+                    {
+                        progress = consumed > 0;
                     }
                 }
+            }
 
+            template<typename Packet>
+            void Socket<Packet>::packet_assembled()
+            {
+                ++statistics.packets_received;
+                statistics.receive_time.add(packet_receive_time.get_running_time());
+                packet_receive_time.stop();
+
+                DataAvailableEvent<Packet> d(&rx_buffer);
+                data_available.push(d);
+                rx_buffer.prepare_new_packet();
+            }
+
+            template<typename Packet>
+            int Socket<Packet>::receive(uint8_t* target, int max_length)
+            {
+                return static_cast<int>(recv(socket_id, target, static_cast<size_t>(max_length), 0));
+            }
+
+            template<typename Packet>
+            int Socket<Packet>::transmit(const iovec* vectors, int count)
+            {
+#ifdef ESP_PLATFORM
+                // lwip doesn't support sendmsg() on TCP sockets before 2.1, so send one vector at a time.
+                (void) count;
+                return static_cast<int>(send(socket_id, vectors[0].iov_base, vectors[0].iov_len, SEND_FLAGS));
+#else
+                msghdr message{};
+                message.msg_iov = const_cast<iovec*>(vectors);
+                message.msg_iovlen = static_cast<size_t>(count);
+                return static_cast<int>(sendmsg(socket_id, &message, SEND_FLAGS));
+#endif
+            }
+
+            template<typename Packet>
+            void Socket<Packet>::try_establish_session()
+            {
+                session_established = establish_session();
+
+                // The session may have failed and stopped the socket.
+                if (session_established && started)
+                {
+                    statistics.connect_time.add(connection_time.get_running_time());
+                    publish_connected_status();
+                }
             }
 
             template<typename Packet>
@@ -377,22 +773,67 @@ namespace smooth
             {
                 // Try to send as much as possible. The only guarantee POSIX gives when a socket is writable
                 // is that send( id, some_data, some_length ) will be >= 1 and may or may not send the entire
-                // packet.
-                auto data_to_send = tx_buffer.get_data_to_send();
-                auto length = tx_buffer.get_remaining_data_length();
-                auto amount_sent = send(socket_id,
-                                        data_to_send,
-                                        length,
-                                        SEND_FLAGS);
+                // packet. Buffers that can, hand over several queued packets at once.
+                iovec vectors[max_send_vectors];
+                auto count = tx_buffer.get_send_vectors(vectors, max_send_vectors);
+                size_t payload_offset = 0;
+                auto payload = tx_buffer.get_current_payload(payload_offset);
+                size_t offered = 0;
+                errno = 0;
+                int amount_sent;
+
+                if (payload && payload->is_file() && tx_buffer.get_remaining_data_length() == 0)
+                {
+                    // All that remains of the current packet is in a file.
+                    offered = payload->get_length() - payload_offset;
+                    amount_sent = transmit_file(*payload, payload_offset);
+                }
+                else
+                {
+                    if (payload && !payload->is_file() && use_zero_copy(*payload))
+                    {
+                        // Only the current packet, i.e. its own remaining data followed by the payload.
+                        count = tx_buffer.get_remaining_data_length() > 0 ? 2 : 1;
+                        amount_sent = transmit_zero_copy(vectors, count, payload);
+                    }
+                    else
+                    {
+                        // Leave any large payload later in the batch for the next send, so that it is sent
+                        // as the current packet, i.e. without being copied.
+                        auto threshold = statistics.applied_options.zero_copy_threshold;
 
-                if (amount_sent == -1)
+                        for (int i = 1; i < count && threshold > 0; ++i)
+                        {
+                            if (vectors[i].iov_len >= static_cast<size_t>(threshold))
+                            {
+                                count = i;
+                            }
+                        }
+
+                        amount_sent = transmit(vectors, count);
+                    }
+
+                    for (int i = 0; i < count; ++i)
+                    {
+                        offered += vectors[i].iov_len;
+                    }
+                }
+
+                if (amount_sent == -1 && (errno == EWOULDBLOCK || errno == EAGAIN))
+                {
+                    // Only possible when a lower layer, such as TLS, needs to wait for the connection.
+                    ++statistics.send_stalls;
+                    elapsed_send_time.start();
+                }
+                else if (amount_sent == -1)
                 {
                     loge("Failure during send");
                     stop();
                 }
                 else
                 {
-                    tx_buffer.data_has_been_sent(static_cast<size_t>(amount_sent));
+                    auto completed = tx_buffer.data_has_been_sent(static_cast<size_t>(amount_sent));
+                    update_send_statistics(offered, static_cast<size_t>(amount_sent), completed);
 
                     // Was a complete packet sent?
                     if (tx_buffer.is_in_progress())
@@ -410,29 +851,204 @@ namespace smooth
 
 
             template<typename Packet>
-            bool Socket<Packet>::internal_start()
+            void Socket<Packet>::update_send_statistics(size_t offered, size_t amount_sent, int completed)
             {
-                if (!is_active())
+                statistics.bytes_sent += amount_sent;
+
+                if (amount_sent < offered)
+                {
+                    ++statistics.partial_writes;
+                }
+
+                if (completed > 0)
+                {
+                    statistics.packets_sent += static_cast<uint32_t>(completed);
+                    statistics.send_time.add(packet_send_time.get_running_time());
+                    // Any packet still in progress was taken from the buffer along with the completed ones.
+                    packet_send_time.start();
+                }
+            }
+
+            template<typename Packet>
+            int Socket<Packet>::transmit_file(const ExternalPayload& payload, size_t offset)
+            {
+                auto length = payload.get_length() - offset;
+                int res;
+
+#ifdef SMOOTH_HAS_SENDFILE
+                if (can_send_directly())
                 {
-                    bool could_create = create_socket();
+                    auto position = payload.get_offset() + static_cast<off_t>(offset);
+                    res = static_cast<int>(sendfile(socket_id, payload.get_file(), &position, length));
+                }
+                else
+#endif
+                {
+                    // Copy a piece at a time; whatever isn't sent is read again on the next call.
+                    file_chunk.resize(file_chunk_size);
+                    res = payload.read(offset, file_chunk.data(), file_chunk.size());
 
-                    if (could_create)
+                    if (res > 0)
                     {
-                        // The socket is non-blocking so we expect return value of either 0, or -1 with errno == EINPROGRESS
-                        log("Connecting");
-                        int res = connect(socket_id, ip->get_socket_address(), ip->get_socket_address_length());
-                        if (res == 0 || (res == -1 && errno == EINPROGRESS))
+                        iovec chunk{file_chunk.data(), static_cast<size_t>(res)};
+                        res = transmit(&chunk, 1);
+                    }
+                }
+
+                if (res == 0 && length > 0)
+                {
+                    // The file is shorter than the payload claims.
+                    errno = EIO;
+                    res = -1;
+                }
+
+                return res;
+            }
+
+            template<typename Packet>
+            bool Socket<Packet>::use_zero_copy(const ExternalPayload& payload)
+            {
+#ifdef SMOOTH_HAS_ZEROCOPY
+                auto threshold = statistics.applied_options.zero_copy_threshold;
+                return can_send_directly() && threshold > 0 && payload.get_length() >= static_cast<size_t>(threshold);
+#else
+                (void) payload;
+                return false;
+#endif
+            }
+
+            template<typename Packet>
+            int Socket<Packet>::transmit_zero_copy(const iovec* vectors, int count,
+                                                   const std::shared_ptr<const ExternalPayload>& payload)
+            {
+#ifdef SMOOTH_HAS_ZEROCOPY
+                int res = 0;
+
+                if (count > 1)
+                {
+                    // The packet's own data, typically a small header, is released as soon as it has been sent
+                    // so it must be copied. MSG_MORE lets it share a segment with the payload.
+                    res = static_cast<int>(send(socket_id, vectors[0].iov_base, vectors[0].iov_len,
+                                                SEND_FLAGS | MSG_MORE));
+                }
+
+                if (res == static_cast<int>(vectors[0].iov_len) || count == 1)
+                {
+                    auto& data = vectors[count - 1];
+                    auto sent = static_cast<int>(send(socket_id, data.iov_base, data.iov_len,
+                                                      SEND_FLAGS | MSG_ZEROCOPY));
+
+                    if (sent == -1 && errno == ENOBUFS)
+                    {
+                        // Too much memory pinned by zero-copy sends already, copy it this time.
+                        sent = static_cast<int>(send(socket_id, data.iov_base, data.iov_len, SEND_FLAGS));
+                    }
+                    else if (sent >= 0)
+                    {
+                        zero_copy_pending.emplace_back(zero_copy_next_id++, payload);
+                        ++statistics.zero_copy_sends;
+                    }
+
+                    if (sent >= 0)
+                    {
+                        res += sent;
+                    }
+                    else if (res == 0)
+                    {
+                        res = -1;
+                    }
+                }
+
+                return res;
+#else
+                (void) payload;
+                return transmit(vectors, count);
+#endif
+            }
+
+            template<typename Packet>
+            void Socket<Packet>::release_zero_copy_completions()
+            {
+#ifdef SMOOTH_HAS_ZEROCOPY
+                bool more = !zero_copy_pending.empty();
+
+                while (more)
+                {
+                    uint8_t control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+                    msghdr message{};
+                    message.msg_control = control;
+                    message.msg_controllen = sizeof(control);
+
+                    more = recvmsg(socket_id, &message, MSG_ERRQUEUE) >= 0;
+
+                    for (auto cmsg = more ? CMSG_FIRSTHDR(&message) : nullptr;
+                         cmsg != nullptr;
+                         cmsg = CMSG_NXTHDR(&message, cmsg))
+                    {
+                        sock_extended_err err{};
+
+                        if ((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                            || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
                         {
-                            started = true;
+                            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
                         }
-                        else
+
+                        if (err.ee_origin == SO_EE_ORIGIN_ZEROCOPY)
                         {
-                            loge("Error during connect");
+                            // The kernel is done with sends ee_info to ee_data, inclusive.
+                            auto first = err.ee_info;
+                            auto span = err.ee_data - first;
+
+                            if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                            {
+                                ++statistics.zero_copy_fallbacks;
+                            }
+
+                            zero_copy_pending.erase(
+                                    std::remove_if(zero_copy_pending.begin(), zero_copy_pending.end(),
+                                                   [first, span](const std::pair<uint32_t,
+                                                           std::shared_ptr<const ExternalPayload>>& p)
+                                                   {
+                                                       return p.first - first <= span;
+                                                   }),
+                                    zero_copy_pending.end());
                         }
                     }
+                }
+#endif
+            }
+
+            template<typename Packet>
+            bool Socket<Packet>::internal_start()
+            {
+                if (!is_active())
+                {
+                    // Any staged data belongs to the previous connection.
+                    rx_staging.clear();
+
+                    {
+                        std::lock_guard<std::mutex> lock(address_guard);
+                        candidates = addresses;
+                    }
+
+                    if (candidates.empty())
+                    {
+                        log("No address to connect to");
+                    }
+                    else
+                    {
+                        connection_time.start();
+                        started = connect_next(socket_id);
+                    }
 
                     if (!started)
                     {
+                        if (socket_id < 0)
+                        {
+                            // There is no socket for the SocketDispatcher to close, so report the failure here.
+                            publish_connected_status();
+                        }
+
                         stop();
                     }
                 }
@@ -440,6 +1056,140 @@ namespace smooth
                 return started;
             }
 
+            template<typename Packet>
+            bool Socket<Packet>::connect_next(int& id)
+            {
+                bool res = false;
+
+                while (!res && !candidates.empty())
+                {
+                    auto address = candidates.front();
+                    candidates.erase(candidates.begin());
+
+                    id = create_socket(address);
+                    if (id >= 0)
+                    {
+                        // The socket is non-blocking so we expect return value of either 0, or -1 with errno == EINPROGRESS
+                        log("Connecting");
+                        int connect_res = connect(id, address->get_socket_address(), address->get_socket_address_length());
+                        res = connect_res == 0 || (connect_res == -1 && errno == EINPROGRESS);
+
+                        if (!res)
+                        {
+                            loge("Error during connect");
+                            close(id);
+                            id = -1;
+                        }
+                    }
+                }
+
+                connect_time.start();
+
+                return res;
+            }
+
+            template<typename Packet>
+            bool Socket<Packet>::check_connection_attempts()
+            {
+                if (started && !session_established && connection_time.get_running_time() > connect_timeout)
+                {
+                    log("Connection attempt timed out");
+                    stop();
+                }
+                else if (started && !connected && alternate_socket_id < 0 && !candidates.empty()
+                         && connect_time.get_running_time() > connection_attempt_delay)
+                {
+                    // The current attempt hasn't succeeded within the attempt delay, start the next one in parallel.
+                    connect_next(alternate_socket_id);
+                }
+
+                // The connect timeout also covers establishing the session, e.g. the TLS handshake.
+                return started && !session_established;
+            }
+
+            template<typename Packet>
+            bool Socket<Packet>::is_connect_complete(int id, bool& failed)
+            {
+                bool res = false;
+                int error = 0;
+                socklen_t len = sizeof(error);
+
+                if (getsockopt(id, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error != 0)
+                {
+                    errno = error;
+                    failed = true;
+                }
+                else
+                {
+                    // Writable without error doesn't necessarily mean connected; only a connected socket has a peer.
+                    sockaddr_storage peer;
+                    socklen_t peer_len = sizeof(peer);
+                    res = getpeername(id, reinterpret_cast<sockaddr*>(&peer), &peer_len) == 0;
+                }
+
+                return res;
+            }
+
+            template<typename Packet>
+            void Socket<Packet>::check_connect_result()
+            {
+                bool failed = false;
+                bool alternate_failed = false;
+
+                if (is_connect_complete(socket_id, failed))
+                {
+                    close_alternate();
+                    connected = true;
+                }
+                else if (alternate_socket_id >= 0 && is_connect_complete(alternate_socket_id, alternate_failed))
+                {
+                    // The parallel attempt won the race.
+                    close(socket_id);
+                    socket_id = alternate_socket_id;
+                    alternate_socket_id = -1;
+                    connected = true;
+                }
+                else
+                {
+                    if (alternate_failed)
+                    {
+                        close_alternate();
+                    }
+
+                    if (failed)
+                    {
+                        loge("Connection attempt failed");
+
+                        if (alternate_socket_id < 0)
+                        {
+                            connect_next(alternate_socket_id);
+                        }
+
+                        if (alternate_socket_id >= 0)
+                        {
+                            close(socket_id);
+                            socket_id = alternate_socket_id;
+                            alternate_socket_id = -1;
+                        }
+                        else
+                        {
+                            // Out of addresses, leave the socket for the SocketDispatcher to close.
+                            stop();
+                        }
+                    }
+                }
+            }
+
+            template<typename Packet>
+            void Socket<Packet>::close_alternate()
+            {
+                if (alternate_socket_id >= 0)
+                {
+                    close(alternate_socket_id);
+                    alternate_socket_id = -1;
+                }
+            }
+
             template<typename Packet>
             bool Socket<Packet>::is_active()
             {
@@ -449,6 +1199,12 @@ namespace smooth
             template<typename Packet>
             void Socket<Packet>::stop()
             {
+                {
+                    // Cancel any ongoing name resolution.
+                    std::lock_guard<std::mutex> lock(address_guard);
+                    ++resolve_request;
+                }
+
                 stop_internal();
                 SocketDispatcher::instance().perform_op(SocketOperation::Op::Stop, shared_from_this());
             }
@@ -461,9 +1217,11 @@ namespace smooth
                     log("Stopping");
                     started = false;
                     connected = false;
+                    session_established = false;
                     tx_buffer.clear();
                     rx_buffer.clear();
                     elapsed_send_time.stop_and_zero();
+                    packet_receive_time.stop();
                 }
             }
 
@@ -473,10 +1231,22 @@ namespace smooth
                 if (is_connected())
                 {
                     log("Connected");
+                    ++statistics.connects;
+                    reported_connected = true;
                 }
                 else
                 {
                     log("Disconnected");
+                    if (reported_connected)
+                    {
+                        ++statistics.disconnects;
+                    }
+                    else
+                    {
+                        ++statistics.connect_failures;
+                    }
+
+                    reported_connected = false;
                 }
 
                 auto self = shared_from_this();
@@ -487,7 +1257,12 @@ namespace smooth
             template<typename Packet>
             void Socket<Packet>::clear_socket_id()
             {
+                close_alternate();
                 socket_id = -1;
+#ifdef SMOOTH_HAS_ZEROCOPY
+                zero_copy_pending.clear();
+                zero_copy_next_id = 0;
+#endif
             }
 
             template<typename Packet>
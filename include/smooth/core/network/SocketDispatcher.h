@@ -4,17 +4,19 @@
 
 #pragma once
 
+#include <array>
 #include <cstring>
-#include <map>
 #include <vector>
 #include <mutex>
 #include <sys/socket.h>
 #include <smooth/core/Task.h>
 #include <smooth/core/ipc/TaskEventQueue.h>
 #include <smooth/core/ipc/SubscribingTaskEventQueue.h>
+#include <smooth/core/timer/TimerWheel.h>
 #include "ISocket.h"
 #include "NetworkStatus.h"
 #include "SocketOperation.h"
+#include "SocketStatistics.h"
 
 namespace smooth
 {
@@ -31,6 +33,8 @@ namespace smooth
                       public smooth::core::ipc::IEventListener<SocketOperation>
             {
                 public:
+                    /// The statistics of each socket, paired with the socket itself.
+                    typedef std::vector<std::pair<std::shared_ptr<ISocket>, SocketStatistics>> StatisticsSnapshot;
 
                     ~SocketDispatcher() override = default;
 
@@ -38,6 +42,11 @@ namespace smooth
 
                     void perform_op(SocketOperation::Op op, std::shared_ptr<ISocket> socket);
 
+                    /// Gets a copy of the statistics of all sockets currently started, including those
+                    /// waiting for the network to become available.
+                    /// \return The statistics.
+                    StatisticsSnapshot get_statistics();
+
                     void tick() override;
                     void event(const NetworkStatus& event) override;
                     void event(const SocketOperation& event);
@@ -45,6 +54,48 @@ namespace smooth
 
                 protected:
                 private:
+                    /// The lists of slots kept by the dispatcher, so that each tick only walks the sockets that
+                    /// need attention instead of the whole table.
+                    enum SlotList
+                    {
+                        /// Slots holding a socket.
+                        Occupied = 0,
+                        /// Sockets with received data not yet assembled, see ISocket::has_staged_input().
+                        StagedInput,
+                        /// Sockets still establishing their connection, see ISocket::check_connection_attempts().
+                        Connecting,
+                        SlotListCount
+                    };
+
+                    /// An entry in the socket table, which is indexed by socket id. Socket ids are small integers
+                    /// allocated lowest first, so the table stays dense.
+                    class SocketSlot
+                    {
+                        public:
+                            /// The previous and next slot in each list, by index, or -1 at either end.
+                            std::array<int, SlotListCount> previous{{-1, -1, -1}};
+                            std::array<int, SlotListCount> next{{-1, -1, -1}};
+                            std::array<bool, SlotListCount> linked{{false, false, false}};
+                            /// The socket using this id, if any.
+                            std::shared_ptr<ISocket> socket{};
+                            /// A socket making a parallel connection attempt on this id, see
+                            /// ISocket::get_alternate_socket_id(). Owned by the slot of its own id. Only valid
+                            /// during a tick.
+                            ISocket* connecting = nullptr;
+                            /// Changed each time the slot is given to another socket, to detect stale references.
+                            uint32_t generation = 0;
+                            /// true while a send timeout is scheduled for the socket.
+                            bool send_timeout_scheduled = false;
+                    };
+
+                    /// Refers to a socket in the table, valid until the slot changes generation.
+                    class SocketReference
+                    {
+                        public:
+                            int socket_id;
+                            uint32_t generation;
+                    };
+
                     SocketDispatcher();
                     int build_sets();
                     void clear_sets();
@@ -54,12 +105,30 @@ namespace smooth
                     void remove_socket_from_collection(std::vector<std::shared_ptr<ISocket>>& col,
                                                        std::shared_ptr<ISocket> socket);
                     void remove_socket_from_active_sockets(std::shared_ptr<ISocket>& socket);
+                    void add_to_active_sockets(int socket_id, std::shared_ptr<ISocket> socket);
+                    void vacate_slot(size_t ix);
+                    void link(SlotList list, size_t ix);
+                    void unlink(SlotList list, size_t ix);
+
+                    int next_slot(SlotList list, int ix) const
+                    {
+                        return active_sockets[static_cast<size_t>(ix)].next[list];
+                    }
+
+                    void schedule_send_timeout(int socket_id);
+                    void send_timeout_expired(const SocketReference& reference);
 
                     void start_socket(std::shared_ptr<ISocket> socket);
                     void shutdown_socket(std::shared_ptr<ISocket> socket);
 
-                    std::map<int, std::shared_ptr<ISocket>> active_sockets;
+                    std::vector<SocketSlot> active_sockets;
+                    /// The first slot of each list, or -1 if it is empty.
+                    std::array<int, SlotListCount> list_heads{{-1, -1, -1}};
+                    /// The ids of the parallel connection attempts added to the write set, see build_sets().
+                    std::vector<int> alternate_ids{};
                     std::vector<std::shared_ptr<ISocket>> inactive_sockets;
+                    // Sockets waiting for a send to complete, checked when their send timeout is due.
+                    smooth::core::timer::TimerWheel<SocketReference, 64> send_timeouts{std::chrono::milliseconds(100)};
                     std::mutex socket_guard;
                     smooth::core::ipc::SubscribingTaskEventQueue<NetworkStatus> network_events;
                     smooth::core::ipc::TaskEventQueue<SocketOperation> socket_op;
@@ -70,6 +139,8 @@ namespace smooth
                     bool has_ip = false;
                     static constexpr const char* tag = "SocketDispatcher";
                     void check_socket_send_timeout();
+                    void check_pending_input();
+                    void check_connecting_sockets();
             };
         }
     }
@@ -0,0 +1,68 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// Tuning options applied to a TCP socket when it is created. Zero, false or -1 leaves the setting at
+            /// the system default. Options not supported by the platform, such as the Linux specific ones on the
+            /// ESP32, are ignored; check SocketStatistics::applied_options to see what is in effect.
+            class SocketOptions
+            {
+                public:
+                    /// Disable Nagle's algorithm (TCP_NODELAY), sending small packets immediately.
+                    bool no_delay = true;
+                    /// Size of the kernel send buffer in bytes (SO_SNDBUF).
+                    int socket_send_buffer = 0;
+                    /// Size of the kernel receive buffer in bytes (SO_RCVBUF).
+                    int socket_receive_buffer = 0;
+                    /// Enable TCP keep-alive probes (SO_KEEPALIVE).
+                    bool keep_alive = false;
+                    /// Seconds of idle time before the first keep-alive probe is sent (TCP_KEEPIDLE).
+                    int keep_alive_idle = 0;
+                    /// Seconds between keep-alive probes (TCP_KEEPINTVL).
+                    int keep_alive_interval = 0;
+                    /// Number of unanswered keep-alive probes before the connection is considered lost (TCP_KEEPCNT).
+                    int keep_alive_count = 0;
+                    /// Hold back partial frames while a batch of packets is being sent, so that the batch goes out
+                    /// in as few segments as possible (TCP_CORK, Linux only).
+                    bool cork_batches = false;
+                    /// Acknowledge received data immediately rather than delaying the ACK (TCP_QUICKACK, Linux only).
+                    /// The kernel clears this after a while so it is set again after each receive.
+                    bool quick_ack = false;
+                    /// Microseconds to busy poll the device queue on receive (SO_BUSY_POLL, Linux only).
+                    int busy_poll = 0;
+                    /// Type of service / traffic class of outgoing packets (IP_TOS or IPV6_TCLASS), e.g. a DSCP value
+                    /// shifted two bits to the left.
+                    int type_of_service = -1;
+                    /// External payloads (see ExternalPayload) of at least this many bytes are sent without being
+                    /// copied into the kernel (SO_ZEROCOPY and MSG_ZEROCOPY, Linux only). Zero-copy sends have a
+                    /// fixed cost of their own, so this only pays off for large payloads, typically 10KB and up.
+                    int zero_copy_threshold = 0;
+
+                    /// Applies the options to a socket. Failing to apply an option is logged, but not an error.
+                    /// \param socket_id The socket
+                    /// \param protocol_family The protocol family of the socket, PF_INET or PF_INET6.
+                    /// \return The options in effect after applying them, as reported by the system.
+                    SocketOptions apply(int socket_id, int protocol_family) const;
+
+                    /// Enables or disables corking of a socket, see cork_batches.
+                    /// \param socket_id The socket
+                    /// \param enable true to hold back partial frames, false to send them.
+                    static void set_cork(int socket_id, bool enable);
+
+                    /// Requests the ACK for received data to be sent immediately, see quick_ack.
+                    /// \param socket_id The socket
+                    static void set_quick_ack(int socket_id);
+            };
+        }
+    }
+}
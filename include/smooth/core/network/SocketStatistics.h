@@ -0,0 +1,96 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "SocketOptions.h"
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// Summary of a series of time measurements. Only the summary is kept, not the samples themselves.
+            class LatencyStatistics
+            {
+                public:
+                    /// Adds a measurement.
+                    /// \param sample The measured time.
+                    void add(std::chrono::microseconds sample)
+                    {
+                        last = sample;
+                        min = count == 0 ? sample : std::min(min, sample);
+                        max = std::max(max, sample);
+                        total += sample;
+                        ++count;
+                    }
+
+                    /// Gets the average of all measurements.
+                    /// \return The average, or zero if there are no measurements.
+                    std::chrono::microseconds get_average() const
+                    {
+                        return count == 0 ? std::chrono::microseconds(0) : total / count;
+                    }
+
+                    /// The number of measurements.
+                    uint32_t count = 0;
+                    /// The most recent measurement.
+                    std::chrono::microseconds last{0};
+                    /// The lowest measurement.
+                    std::chrono::microseconds min{0};
+                    /// The highest measurement.
+                    std::chrono::microseconds max{0};
+                    /// The sum of all measurements.
+                    std::chrono::microseconds total{0};
+            };
+
+            /// Counters and time measurements of a socket, kept for as long as the socket exists,
+            /// i.e. across reconnects.
+            class SocketStatistics
+            {
+                public:
+                    /// The number of bytes handed to the connection.
+                    uint64_t bytes_sent = 0;
+                    /// The number of bytes received from the connection.
+                    uint64_t bytes_received = 0;
+                    /// The number of packets completely sent.
+                    uint32_t packets_sent = 0;
+                    /// The number of packets assembled from received data.
+                    uint32_t packets_received = 0;
+                    /// The number of sends that didn't send all data offered, leaving the rest for a later send.
+                    uint32_t partial_writes = 0;
+                    /// The number of sends that couldn't send anything because the connection wasn't ready.
+                    uint32_t send_stalls = 0;
+                    /// The number of times the socket was closed because a send didn't complete in time.
+                    uint32_t send_timeouts = 0;
+                    /// The number of times the socket was reported as connected; more than one means it has reconnected.
+                    uint32_t connects = 0;
+                    /// The number of times a connected socket was reported as disconnected.
+                    uint32_t disconnects = 0;
+                    /// The number of times a connection attempt failed.
+                    uint32_t connect_failures = 0;
+                    /// The number of sends that handed an external payload to the kernel without copying it.
+                    uint32_t zero_copy_sends = 0;
+                    /// The number of times the kernel reported that it had to copy the data of zero-copy sends
+                    /// anyway, e.g. because the network device doesn't support it. If this grows along with
+                    /// zero_copy_sends, zero-copy sends only add overhead and should be turned off.
+                    uint32_t zero_copy_fallbacks = 0;
+                    /// Time from the start of a connection attempt until the connection, including any session
+                    /// on top of it such as TLS, is established.
+                    LatencyStatistics connect_time{};
+                    /// Time from the socket taking a packet from the send buffer until it has been completely sent.
+                    LatencyStatistics send_time{};
+                    /// Time from receiving the first data of a packet until the packet is passed on to the
+                    /// application via a DataAvailableEvent.
+                    LatencyStatistics receive_time{};
+                    /// The options in effect on the most recently created connection, as reported by the system.
+                    SocketOptions applied_options{};
+            };
+        }
+    }
+}
@@ -0,0 +1,77 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <openssl/ssl.h>
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace network
+        {
+            /// Holds the TLS configuration shared by one or more SecureSockets, i.e. the protocol version,
+            /// trusted CA certificates and whether the server certificate is to be verified.
+            class TlsContext
+            {
+                public:
+                    /// Constructor
+                    /// \param verify_peer If true, the handshake fails unless the server certificate is signed by
+                    /// one of the CA certificates added via add_ca_certificate() and, except on ESP_PLATFORM, issued
+                    /// for the server name the SecureSocket connects to.
+                    explicit TlsContext(bool verify_peer = true);
+
+                    ~TlsContext();
+
+                    TlsContext(const TlsContext&) = delete;
+                    TlsContext& operator=(const TlsContext&) = delete;
+
+                    /// Adds a trusted CA certificate.
+                    /// \param certificate The certificate in PEM format.
+                    /// \return true if the certificate could be added.
+                    bool add_ca_certificate(const std::string& certificate);
+
+                    /// Returns a value indicating if the context could be created.
+                    /// \return true or false
+                    bool is_valid() const
+                    {
+                        return ctx != nullptr;
+                    }
+
+                    /// Returns a value indicating if the server certificate is verified during the handshake.
+                    /// \return true or false
+                    bool is_verifying_peer() const
+                    {
+                        return verify_peer;
+                    }
+
+                    SSL_CTX* get_context()
+                    {
+                        return ctx;
+                    }
+
+                    /// Keeps the session of an established connection so that the next connection to the same
+                    /// server can resume it, skipping the full handshake.
+                    /// \param server_name The name of the server the connection is made to.
+                    /// \param ssl The connection
+                    void save_session(const std::string& server_name, SSL* ssl);
+
+                    /// Sets up the connection to resume a previously saved session to the same server, if any.
+                    /// \param server_name The name of the server the connection is made to.
+                    /// \param ssl The connection, not yet connected.
+                    void resume_session(const std::string& server_name, SSL* ssl);
+
+                private:
+                    SSL_CTX* ctx = nullptr;
+                    bool verify_peer;
+                    std::mutex session_guard{};
+                    std::unordered_map<std::string, SSL_SESSION*> sessions{};
+            };
+        }
+    }
+}
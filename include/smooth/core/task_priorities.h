@@ -16,6 +16,7 @@ namespace smooth
         // system.
         const uint32_t APPLICATION_BASE_PRIO = 5;
 
+        const uint32_t DNS_RESOLVER_PRIO = 18;
         const uint32_t TIMER_SERVICE_PRIO = 19;
         const uint32_t SOCKET_DISPATCHER_PRIO = 20;
     }
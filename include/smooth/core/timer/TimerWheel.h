@@ -0,0 +1,102 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace timer
+        {
+            /// A hashed timer wheel, used to keep track of a large number of timeouts. Items are put in one of
+            /// SlotCount slots, each covering resolution worth of time, so scheduling an item is O(1) and advancing
+            /// the wheel only touches the items in the slots that have expired. An item expires within one
+            /// resolution after its due time. Items scheduled further ahead than the wheel spans, i.e.
+            /// (SlotCount - 1) * resolution, expire at the end of the span and must be rescheduled by the caller
+            /// for the time that remains. There is no way to cancel an item, so they typically refer to their owner
+            /// in a way that lets the caller detect if the item is stale. Not thread-safe.
+            /// \tparam T The item type
+            /// \tparam SlotCount The number of slots
+            template<typename T, int SlotCount>
+            class TimerWheel
+            {
+                    static_assert(SlotCount > 1, "SlotCount must be at least 2");
+
+                public:
+                    /// Constructor
+                    /// \param resolution The time each slot covers.
+                    explicit TimerWheel(std::chrono::milliseconds resolution)
+                            : resolution(resolution), slots(), last(std::chrono::steady_clock::now())
+                    {
+                    }
+
+                    /// Schedules an item to expire after the given delay.
+                    /// \param item The item
+                    /// \param delay The time until the item expires, rounded up to the resolution.
+                    void schedule(const T& item, std::chrono::milliseconds delay)
+                    {
+                        auto ticks = (delay.count() + resolution.count() - 1) / resolution.count();
+                        ticks = std::max<decltype(ticks)>(1, std::min<decltype(ticks)>(ticks, SlotCount - 1));
+                        slots[(current + static_cast<uint64_t>(ticks)) % SlotCount].push_back(item);
+                        ++count;
+                    }
+
+                    /// Advances the wheel to the given time, passing each item that has expired to the callback.
+                    /// The callback may schedule new items.
+                    /// \param now The current time
+                    /// \param expired Callable taking a const T&.
+                    template<typename Callback>
+                    void advance(std::chrono::steady_clock::time_point now, Callback expired)
+                    {
+                        auto ticks = std::chrono::duration_cast<std::chrono::milliseconds>(now - last).count()
+                                     / resolution.count();
+                        last += resolution * ticks;
+
+                        decltype(ticks) visited = 0;
+
+                        // After a full turn every slot has been visited, and there is no need to visit empty ones.
+                        for (; visited < ticks && visited < SlotCount && count > 0; ++visited)
+                        {
+                            ++current;
+                            auto& slot = slots[current % SlotCount];
+                            // Take the items out so that the callback can schedule new ones into the same slot.
+                            std::swap(slot, expiring);
+                            count -= expiring.size();
+
+                            for (auto& item : expiring)
+                            {
+                                expired(item);
+                            }
+
+                            expiring.clear();
+                        }
+
+                        current += static_cast<uint64_t>(ticks - visited);
+                    }
+
+                    /// Gets the number of scheduled items.
+                    /// \return Number of items
+                    size_t size() const
+                    {
+                        return count;
+                    }
+
+                private:
+                    std::chrono::milliseconds resolution;
+                    std::array<std::vector<T>, SlotCount> slots;
+                    std::vector<T> expiring{};
+                    std::chrono::steady_clock::time_point last;
+                    uint64_t current = 0;
+                    size_t count = 0;
+            };
+        }
+    }
+}
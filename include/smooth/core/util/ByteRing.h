@@ -0,0 +1,144 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+namespace smooth
+{
+    namespace core
+    {
+        namespace util
+        {
+            /// A ring of bytes with a size set at construction, giving direct access to its contiguous
+            /// readable and writable regions so that data can be read into and consumed from it in place,
+            /// e.g. by recv() and packet framing. Not thread-safe.
+            class ByteRing
+            {
+                public:
+                    /// Constructor
+                    /// \param size The number of bytes the ring can hold. The memory is allocated once, here.
+                    explicit ByteRing(size_t size)
+                            : buff(size)
+                    {
+                    }
+
+                    ByteRing(const ByteRing&) = delete;
+                    ByteRing& operator=(const ByteRing&) = delete;
+
+                    /// Gets the total number of bytes the ring can hold.
+                    /// \return The capacity
+                    size_t size() const
+                    {
+                        return buff.size();
+                    }
+
+                    /// Returns a value indicating if the ring is empty.
+                    /// \return true or false
+                    bool is_empty() const
+                    {
+                        return count == 0;
+                    }
+
+                    /// Returns a value indicating if the ring is full.
+                    /// \return true or false
+                    bool is_full() const
+                    {
+                        return count == buff.size();
+                    }
+
+                    /// Gets the number of bytes waiting to be consumed.
+                    /// \return Number of bytes
+                    size_t available_data() const
+                    {
+                        return count;
+                    }
+
+                    /// Gets the number of bytes that can be written into the ring.
+                    /// \return Number of bytes
+                    size_t available_space() const
+                    {
+                        return buff.size() - count;
+                    }
+
+                    /// Gets the position of the first unconsumed byte.
+                    /// \return The read position.
+                    const uint8_t* get_read_pos() const
+                    {
+                        return buff.data() + read_ix;
+                    }
+
+                    /// Gets the number of bytes that can be read from get_read_pos() without wrapping.
+                    /// \return Number of bytes
+                    size_t get_contiguous_read_length() const
+                    {
+                        return std::min(count, buff.size() - read_ix);
+                    }
+
+                    /// Marks the specified number of bytes as consumed.
+                    /// \param length Number of bytes, must be <= get_contiguous_read_length()
+                    void data_consumed(size_t length)
+                    {
+                        count -= length;
+
+                        if (count == 0)
+                        {
+                            // Restart from the beginning so that the next write gets the
+                            // entire ring as one contiguous region.
+                            read_ix = 0;
+                        }
+                        else
+                        {
+                            read_ix = (read_ix + length) % buff.size();
+                        }
+                    }
+
+                    /// Gets the position where the next byte is to be written.
+                    /// \return The write position.
+                    uint8_t* get_write_pos()
+                    {
+                        return buff.data() + write_index();
+                    }
+
+                    /// Gets the number of bytes that can be written to get_write_pos() without wrapping.
+                    /// \return Number of bytes
+                    size_t get_contiguous_write_length() const
+                    {
+                        auto write_ix = write_index();
+                        return write_ix < read_ix || (write_ix == read_ix && count > 0)
+                               ? read_ix - write_ix
+                               : buff.size() - write_ix;
+                    }
+
+                    /// Marks the specified number of bytes as written.
+                    /// \param length Number of bytes, must be <= get_contiguous_write_length()
+                    void data_written(size_t length)
+                    {
+                        count += length;
+                    }
+
+                    /// Clears the ring
+                    void clear()
+                    {
+                        read_ix = 0;
+                        count = 0;
+                    }
+
+                private:
+                    size_t write_index() const
+                    {
+                        return buff.empty() ? 0 : (read_ix + count) % buff.size();
+                    }
+
+                    std::vector<uint8_t> buff;
+                    size_t read_ix = 0;
+                    size_t count = 0;
+            };
+        }
+    }
+}
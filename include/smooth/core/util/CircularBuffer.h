@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <utility>
+
 namespace smooth
 {
     namespace core
@@ -19,6 +21,8 @@ namespace smooth
 
                     /// Puts data onto the buffer
                     virtual void put(const T& data) = 0;
+                    /// Moves data onto the buffer
+                    virtual void put(T&& data) = 0;
                     /// Gets data from the buffer
                     /// \param t The item to put on the buffer
                     /// \return true on success, false on failure.
@@ -53,6 +57,7 @@ namespace smooth
                     virtual ~CircularBuffer() = default;
 
                     void put(const T& data) override;
+                    void put(T&& data) override;
                     bool get(T& d) override;
 
                     bool is_empty() override
@@ -126,6 +131,25 @@ namespace smooth
                 write_pos = next_pos(write_pos);
             }
 
+            template<typename T, int Size>
+            void CircularBuffer<T, Size>::put(T&& data)
+            {
+                this->data[write_pos] = std::move(data);
+
+                if (!is_full())
+                {
+                    ++count;
+                }
+
+                // Overwrite data not yet read
+                if (is_full() && read_pos == write_pos)
+                {
+                    read_pos = next_pos(read_pos);
+                }
+
+                write_pos = next_pos(write_pos);
+            }
+
             template<typename T, int Size>
             bool CircularBuffer<T, Size>::get(T& d)
             {
@@ -133,7 +157,8 @@ namespace smooth
 
                 if (!is_empty())
                 {
-                    d = data[read_pos];
+                    // The slot is free from now on, so move the item out rather than copying it.
+                    d = std::move(data[read_pos]);
                     read_pos = next_pos(read_pos);
                     --count;
 
@@ -0,0 +1,168 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks the delays of BackoffPolicy: that they grow by the multiplier up to the maximum and start over after a
+// reset, that the jitter only ever shortens a delay and by no more than its fraction, that it actually spreads the
+// delays apart, also between policies, and that out of range arguments are clamped.
+//
+// Usage: backoff_policy
+// The exit code is non-zero if any case fails.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <vector>
+#include <smooth/core/network/BackoffPolicy.h>
+
+using namespace std::chrono;
+using smooth::core::network::BackoffPolicy;
+
+namespace smooth
+{
+    namespace test
+    {
+        class BackoffPolicyTest
+        {
+            public:
+                int run()
+                {
+                    grows_to_maximum();
+                    jitter_stays_within_bounds(0.5);
+                    jitter_stays_within_bounds(1.0);
+                    policies_are_spread_apart();
+                    arguments_are_clamped();
+
+                    printf("%d failed\n", failed);
+                    return failed == 0 ? 0 : 1;
+                }
+
+            private:
+                void check(const char* desc, bool passed)
+                {
+                    printf("%s: %s\n", passed ? "PASS" : "FAIL", desc);
+
+                    if (!passed)
+                    {
+                        ++failed;
+                    }
+                }
+
+                static std::vector<milliseconds::rep> delays(BackoffPolicy& policy, int count)
+                {
+                    std::vector<milliseconds::rep> res;
+
+                    for (int i = 0; i < count; ++i)
+                    {
+                        res.push_back(policy.next_delay().count());
+                    }
+
+                    return res;
+                }
+
+                void grows_to_maximum()
+                {
+                    BackoffPolicy policy(milliseconds(100), milliseconds(1000), 2.0, 0.0);
+
+                    check("Without jitter, delays double up to the maximum",
+                          delays(policy, 7) == std::vector<milliseconds::rep>{100, 200, 400, 800, 1000, 1000, 1000});
+                    check("Attempts are counted", policy.get_attempts() == 7);
+
+                    policy.reset();
+                    auto attempts = policy.get_attempts();
+                    check("A reset starts over",
+                          attempts == 0 && delays(policy, 2) == std::vector<milliseconds::rep>{100, 200});
+
+                    BackoffPolicy fast(milliseconds(1), seconds(60), 10.0, 0.0);
+                    auto many = delays(fast, 200);
+                    check("Many attempts stay at the maximum", many.back() == 60000
+                                                              && *std::max_element(many.begin(), many.end()) == 60000);
+                }
+
+                void jitter_stays_within_bounds(double jitter)
+                {
+                    const milliseconds::rep nominal[] = {1000, 2000, 4000, 8000, 10000, 10000};
+                    bool within = true;
+                    std::set<milliseconds::rep> first_delays;
+                    auto lowest = nominal[0];
+                    auto highest = static_cast<milliseconds::rep>(0);
+
+                    for (int run = 0; run < 1000; ++run)
+                    {
+                        BackoffPolicy policy(seconds(1), seconds(10), 2.0, jitter);
+
+                        for (auto n : nominal)
+                        {
+                            auto delay = policy.next_delay().count();
+                            // The reduction is truncated to whole milliseconds.
+                            within = within && delay <= n && delay >= n - static_cast<milliseconds::rep>(n * jitter);
+
+                            if (n == nominal[0])
+                            {
+                                first_delays.insert(delay);
+                                lowest = std::min(lowest, delay);
+                                highest = std::max(highest, delay);
+                            }
+                        }
+                    }
+
+                    auto spread = static_cast<milliseconds::rep>(nominal[0] * jitter);
+                    printf("Jitter %.1f: first delays from %lld to %lld ms, %u distinct\n", jitter,
+                           static_cast<long long>(lowest), static_cast<long long>(highest),
+                           static_cast<unsigned>(first_delays.size()));
+
+                    check(jitter < 1 ? "Half jitter only shortens delays, by up to half"
+                                     : "Full jitter gives delays from zero up to the nominal one", within);
+                    check(jitter < 1 ? "Half jitter covers its range" : "Full jitter covers its range",
+                          lowest < nominal[0] - spread * 9 / 10 && highest > nominal[0] - spread / 10
+                          && first_delays.size() > 100);
+                }
+
+                void policies_are_spread_apart()
+                {
+                    BackoffPolicy a;
+                    BackoffPolicy b;
+
+                    check("Policies are seeded independently", delays(a, 20) != delays(b, 20));
+                }
+
+                void arguments_are_clamped()
+                {
+                    BackoffPolicy shrinking(milliseconds(500), seconds(10), 0.5, 0.0);
+                    check("A multiplier below one keeps the delay constant",
+                          delays(shrinking, 3) == std::vector<milliseconds::rep>{500, 500, 500});
+
+                    BackoffPolicy low_max(seconds(2), seconds(1), 2.0, 0.0);
+                    check("The maximum is at least the initial delay",
+                          delays(low_max, 3) == std::vector<milliseconds::rep>{2000, 2000, 2000});
+
+                    BackoffPolicy negative(milliseconds(100), seconds(1), 2.0, -1.0);
+                    check("A negative jitter means none",
+                          delays(negative, 3) == std::vector<milliseconds::rep>{100, 200, 400});
+
+                    bool within = true;
+
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        BackoffPolicy excessive(milliseconds(100), seconds(1), 2.0, 5.0);
+                        auto delay = excessive.next_delay().count();
+                        within = within && delay >= 0 && delay <= 100;
+                    }
+
+                    check("A jitter above one never makes a delay negative", within);
+                }
+
+                int failed = 0;
+        };
+    }
+}
+
+int main(int, char**)
+{
+    smooth::test::BackoffPolicyTest test;
+    auto res = test.run();
+    fflush(stdout);
+
+    return res;
+}
@@ -0,0 +1,67 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<uint64_t> allocations{0};
+
+    void* allocate(std::size_t size)
+    {
+        ++allocations;
+        auto p = std::malloc(size == 0 ? 1 : size);
+
+        if (p == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        return p;
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace smooth
+{
+    namespace test
+    {
+        uint64_t AllocationCounter::get_count()
+        {
+            return allocations;
+        }
+    }
+}
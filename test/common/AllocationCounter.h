@@ -0,0 +1,22 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace smooth
+{
+    namespace test
+    {
+        /// Counts heap allocations made through operator new, by all threads. Linking this in replaces the global
+        /// operator new and delete of the program.
+        class AllocationCounter
+        {
+            public:
+                /// \return The number of allocations made since the program started.
+                static uint64_t get_count();
+        };
+    }
+}
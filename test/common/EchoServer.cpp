@@ -0,0 +1,23 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "EchoServer.h"
+#include <vector>
+
+namespace smooth
+{
+    namespace test
+    {
+        void EchoServer::serve(Connection& connection)
+        {
+            std::vector<uint8_t> buffer(64 * 1024);
+            int length;
+
+            do
+            {
+                length = connection.read(buffer.data(), static_cast<int>(buffer.size()));
+            } while (length > 0 && connection.write(buffer.data(), length));
+        }
+    }
+}
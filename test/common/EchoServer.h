@@ -0,0 +1,32 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include "LoopbackServer.h"
+
+namespace smooth
+{
+    namespace test
+    {
+        /// Sends back everything it receives, byte for byte, so it works with any framing.
+        class EchoServer
+                : public LoopbackServer
+        {
+            public:
+                explicit EchoServer(SSL_CTX* tls_context = nullptr)
+                        : LoopbackServer(tls_context)
+                {
+                }
+
+                ~EchoServer() override
+                {
+                    stop();
+                }
+
+            protected:
+                void serve(Connection& connection) override;
+        };
+    }
+}
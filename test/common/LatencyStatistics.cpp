@@ -0,0 +1,49 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "LatencyStatistics.h"
+#include <algorithm>
+
+namespace smooth
+{
+    namespace test
+    {
+        LatencyStatistics::LatencyStatistics(size_t expected_samples)
+        {
+            samples.reserve(expected_samples);
+        }
+
+        void LatencyStatistics::add(std::chrono::nanoseconds latency)
+        {
+            samples.push_back(static_cast<uint64_t>(latency.count()));
+            sorted = false;
+        }
+
+        void LatencyStatistics::clear()
+        {
+            samples.clear();
+            sorted = true;
+        }
+
+        std::chrono::microseconds LatencyStatistics::get_percentile(double percentile)
+        {
+            uint64_t res = 0;
+
+            if (!samples.empty())
+            {
+                if (!sorted)
+                {
+                    std::sort(samples.begin(), samples.end());
+                    sorted = true;
+                }
+
+                // Nearest rank
+                auto rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(samples.size()));
+                res = samples[std::min(rank, samples.size() - 1)];
+            }
+
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(res));
+        }
+    }
+}
@@ -0,0 +1,43 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace smooth
+{
+    namespace test
+    {
+        /// Collects latency samples and reports percentiles of them.
+        class LatencyStatistics
+        {
+            public:
+                /// Constructor
+                /// \param expected_samples The number of samples to reserve room for, so that collecting them
+                /// doesn't allocate while a benchmark runs.
+                explicit LatencyStatistics(size_t expected_samples = 0);
+
+                void add(std::chrono::nanoseconds latency);
+
+                void clear();
+
+                size_t get_count() const
+                {
+                    return samples.size();
+                }
+
+                /// \param percentile The percentile, e.g. 99.9
+                /// \return The latency at the percentile, or zero if there are no samples.
+                std::chrono::microseconds get_percentile(double percentile);
+
+            private:
+                std::vector<uint64_t> samples{};
+                bool sorted = true;
+        };
+    }
+}
@@ -0,0 +1,201 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "LoopbackServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace smooth
+{
+    namespace test
+    {
+        int LoopbackServer::Connection::read(uint8_t* target, int max_length)
+        {
+            int res;
+
+            do
+            {
+                res = ssl != nullptr
+                      ? SSL_read(ssl, target, max_length)
+                      : static_cast<int>(recv(socket_id, target, static_cast<size_t>(max_length), 0));
+            } while (res < 0 && ssl == nullptr && errno == EINTR);
+
+            return std::max(res, 0);
+        }
+
+        bool LoopbackServer::Connection::read_all(uint8_t* target, int length)
+        {
+            int done = 0;
+            int res = 1;
+
+            while (done < length && res > 0)
+            {
+                res = read(target + done, length - done);
+                done += res;
+            }
+
+            return done == length;
+        }
+
+        bool LoopbackServer::Connection::write(const uint8_t* data, int length)
+        {
+            int done = 0;
+            int res = 1;
+
+            while (done < length && res > 0)
+            {
+                res = ssl != nullptr
+                      ? SSL_write(ssl, data + done, length - done)
+                      : static_cast<int>(send(socket_id, data + done, static_cast<size_t>(length - done),
+                                              MSG_NOSIGNAL));
+
+                if (res > 0)
+                {
+                    done += res;
+                }
+                else if (ssl == nullptr && res < 0 && errno == EINTR)
+                {
+                    res = 1;
+                }
+            }
+
+            return done == length;
+        }
+
+        LoopbackServer::LoopbackServer(SSL_CTX* tls_context)
+                : tls_context(tls_context)
+        {
+        }
+
+        LoopbackServer::~LoopbackServer()
+        {
+            stop();
+        }
+
+        bool LoopbackServer::start()
+        {
+            // A client closing its end while a TLS record is written must not end the process.
+            signal(SIGPIPE, SIG_IGN);
+
+            listen_id = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            // Port 0 lets the system pick a free port, so that tests can run in parallel.
+            address.sin_port = 0;
+            socklen_t length = sizeof(address);
+
+            bool res = listen_id >= 0
+                       && bind(listen_id, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+                       && listen(listen_id, 64) == 0
+                       && getsockname(listen_id, reinterpret_cast<sockaddr*>(&address), &length) == 0;
+
+            if (res)
+            {
+                port = ntohs(address.sin_port);
+                running = true;
+                acceptor = std::thread([this]() { accept_connections(); });
+            }
+
+            return res;
+        }
+
+        void LoopbackServer::stop()
+        {
+            if (running)
+            {
+                running = false;
+                // Wakes up the thread blocked in accept().
+                shutdown(listen_id, SHUT_RDWR);
+                acceptor.join();
+                close(listen_id);
+                listen_id = -1;
+
+                std::vector<std::thread> stopping;
+
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+
+                    for (auto id : open_connections)
+                    {
+                        shutdown(id, SHUT_RDWR);
+                    }
+
+                    stopping.swap(workers);
+                }
+
+                for (auto& worker : stopping)
+                {
+                    worker.join();
+                }
+            }
+        }
+
+        void LoopbackServer::accept_connections()
+        {
+            while (running)
+            {
+                auto id = accept(listen_id, nullptr, nullptr);
+
+                if (id >= 0)
+                {
+                    int one = 1;
+                    setsockopt(id, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    ++connection_count;
+
+                    std::lock_guard<std::mutex> lock(guard);
+                    open_connections.push_back(id);
+                    workers.emplace_back([this, id]() { run(id); });
+                }
+                else if (errno != EINTR && errno != ECONNABORTED)
+                {
+                    break;
+                }
+            }
+        }
+
+        void LoopbackServer::run(int socket_id)
+        {
+            SSL* ssl = nullptr;
+            bool ok = true;
+
+            if (tls_context != nullptr)
+            {
+                ssl = SSL_new(tls_context);
+                ok = ssl != nullptr && SSL_set_fd(ssl, socket_id) == 1 && SSL_accept(ssl) == 1;
+
+                if (!ok)
+                {
+                    ++failed_handshakes;
+                }
+                else if (SSL_session_reused(ssl))
+                {
+                    ++resumed_sessions;
+                }
+            }
+
+            if (ok)
+            {
+                Connection connection(socket_id, ssl);
+                serve(connection);
+            }
+
+            if (ssl != nullptr)
+            {
+                SSL_shutdown(ssl);
+                SSL_free(ssl);
+            }
+
+            std::lock_guard<std::mutex> lock(guard);
+            open_connections.erase(std::find(open_connections.begin(), open_connections.end(), socket_id));
+            close(socket_id);
+        }
+    }
+}
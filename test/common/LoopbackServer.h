@@ -0,0 +1,120 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <openssl/ssl.h>
+
+namespace smooth
+{
+    namespace test
+    {
+        /// A TCP server on the loopback interface, standing in for the remote end in tests and benchmarks. It
+        /// listens on a port chosen by the system and serves each connection on a thread of its own, outside of
+        /// the SocketDispatcher, using plain blocking socket calls.
+        class LoopbackServer
+        {
+            public:
+                /// A connection accepted by the server.
+                class Connection
+                {
+                    public:
+                        Connection(int socket_id, SSL* ssl)
+                                : socket_id(socket_id), ssl(ssl)
+                        {
+                        }
+
+                        /// Reads what is available, waiting for at least one byte.
+                        /// \return The number of bytes read, or 0 when the connection is closed or failed.
+                        int read(uint8_t* target, int max_length);
+
+                        /// Reads exactly the given number of bytes.
+                        /// \return true on success, false when the connection is closed or failed.
+                        bool read_all(uint8_t* target, int length);
+
+                        /// Writes all the data.
+                        /// \return true on success, false when the connection is closed or failed.
+                        bool write(const uint8_t* data, int length);
+
+                        /// \return The TLS session, or nullptr on a plain connection.
+                        SSL* get_ssl() const
+                        {
+                            return ssl;
+                        }
+
+                    private:
+                        int socket_id;
+                        SSL* ssl;
+                };
+
+                /// Constructor
+                /// \param tls_context If set, connections are accepted as TLS connections using this context,
+                /// which the caller keeps ownership of.
+                explicit LoopbackServer(SSL_CTX* tls_context = nullptr);
+
+                virtual ~LoopbackServer();
+
+                LoopbackServer(const LoopbackServer&) = delete;
+                LoopbackServer& operator=(const LoopbackServer&) = delete;
+
+                /// Starts listening.
+                /// \return true on success.
+                bool start();
+
+                /// Stops listening and closes all connections. Called by the destructor; classes overriding
+                /// serve() must call it from their own destructor.
+                void stop();
+
+                /// \return The port the server listens on, once started.
+                uint16_t get_port() const
+                {
+                    return port;
+                }
+
+                /// \return The number of connections accepted, including failed TLS handshakes.
+                int get_connection_count() const
+                {
+                    return connection_count;
+                }
+
+                /// \return The number of TLS handshakes that failed.
+                int get_failed_handshake_count() const
+                {
+                    return failed_handshakes;
+                }
+
+                /// \return The number of TLS handshakes that resumed a previous session.
+                int get_resumed_session_count() const
+                {
+                    return resumed_sessions;
+                }
+
+            protected:
+                /// Serves a connection until it is closed. Called on the thread of the connection.
+                virtual void serve(Connection& connection) = 0;
+
+            private:
+                void accept_connections();
+                void run(int socket_id);
+
+                SSL_CTX* tls_context;
+                int listen_id = -1;
+                uint16_t port = 0;
+                std::atomic<bool> running{false};
+                std::atomic<int> connection_count{0};
+                std::atomic<int> failed_handshakes{0};
+                std::atomic<int> resumed_sessions{0};
+                std::thread acceptor{};
+                std::mutex guard{};
+                std::vector<std::thread> workers{};
+                std::vector<int> open_connections{};
+        };
+    }
+}
@@ -0,0 +1,348 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "MqttBrokerDouble.h"
+#include <algorithm>
+
+namespace smooth
+{
+    namespace test
+    {
+        // Packet types, as found in the upper four bits of the fixed header.
+        static const uint8_t connect = 1;
+        static const uint8_t publish = 3;
+        static const uint8_t pub_ack = 4;
+        static const uint8_t pub_rec = 5;
+        static const uint8_t pub_rel = 6;
+        static const uint8_t pub_comp = 7;
+        static const uint8_t subscribe_request = 8;
+        static const uint8_t unsubscribe_request = 10;
+        static const uint8_t ping_request = 12;
+        static const uint8_t disconnect = 14;
+
+        static uint16_t read_u16(const uint8_t* data)
+        {
+            return static_cast<uint16_t>(data[0] << 8 | data[1]);
+        }
+
+        static void append_u16(std::vector<uint8_t>& out, uint16_t value)
+        {
+            out.push_back(static_cast<uint8_t>(value >> 8));
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        void MqttBrokerDouble::serve(Connection& connection)
+        {
+            Session session(connection);
+
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                sessions.push_back(&session);
+            }
+
+            uint8_t header;
+            std::vector<uint8_t> body;
+
+            while (read_packet(connection, header, body) && handle(session, header, body))
+            {
+            }
+
+            std::lock_guard<std::mutex> lock(guard);
+            sessions.erase(std::find(sessions.begin(), sessions.end(), &session));
+        }
+
+        bool MqttBrokerDouble::read_packet(Connection& connection, uint8_t& header, std::vector<uint8_t>& body)
+        {
+            bool res = connection.read_all(&header, 1);
+            size_t length = 0;
+            uint8_t b = 0x80;
+
+            for (int shift = 0; res && (b & 0x80) != 0 && shift < 28; shift += 7)
+            {
+                res = connection.read_all(&b, 1);
+                length |= static_cast<size_t>(b & 0x7F) << shift;
+            }
+
+            if (res)
+            {
+                // resize() keeps the capacity, so the body only allocates when it grows.
+                body.resize(length);
+                res = length == 0 || connection.read_all(body.data(), static_cast<int>(length));
+            }
+
+            return res;
+        }
+
+        bool MqttBrokerDouble::handle(Session& session, uint8_t header, const std::vector<uint8_t>& body)
+        {
+            auto type = static_cast<uint8_t>(header >> 4);
+            bool res = true;
+
+            if (type == connect)
+            {
+                // Session present: no, return code: accepted.
+                std::lock_guard<std::mutex> lock(guard);
+                session.out.assign({0x20, 0x02, 0x00, 0x00});
+                res = session.connection.write(session.out.data(), static_cast<int>(session.out.size()));
+            }
+            else if (type == publish && body.size() >= 2)
+            {
+                auto qos = static_cast<uint8_t>((header >> 1) & 0x03);
+                auto topic_length = read_u16(body.data());
+                size_t pos = 2u + topic_length + (qos > 0 ? 2u : 0u);
+
+                if (pos <= body.size())
+                {
+                    ++published;
+                    route(reinterpret_cast<const char*>(body.data() + 2), topic_length, body.data() + pos,
+                          body.size() - pos, qos);
+
+                    auto packet_identifier = read_u16(body.data() + 2 + topic_length);
+
+                    // Messages are routed when they arrive, so there's nothing to wait for with QoS 2.
+                    if (qos == 2 && pub_rec_batch > 1)
+                    {
+                        hold_pub_rec(session, packet_identifier);
+                    }
+                    else if (qos > 0)
+                    {
+                        acknowledge(session, qos == 1 ? pub_ack << 4 : pub_rec << 4, packet_identifier);
+                    }
+                }
+            }
+            else if (type == pub_rel && body.size() >= 2)
+            {
+                acknowledge(session, pub_comp << 4, read_u16(body.data()));
+            }
+            else if (type == pub_rec && body.size() >= 2)
+            {
+                // For a QoS 2 message routed to the client.
+                acknowledge(session, pub_rel << 4 | 0x02, read_u16(body.data()));
+            }
+            else if (type == subscribe_request && body.size() >= 2)
+            {
+                subscribe(session, body);
+            }
+            else if (type == unsubscribe_request && body.size() >= 2)
+            {
+                unsubscribe(session, body);
+            }
+            else if (type == ping_request)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                session.out.assign({0xD0, 0x00});
+                res = session.connection.write(session.out.data(), static_cast<int>(session.out.size()));
+            }
+            else if (type == disconnect)
+            {
+                res = false;
+            }
+
+            // PUBACK and PUBCOMP for messages routed to the client end their flows; nothing is resent.
+            return res;
+        }
+
+        void MqttBrokerDouble::subscribe(Session& session, const std::vector<uint8_t>& body)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            std::vector<uint8_t> granted;
+            size_t pos = 2;
+
+            while (pos + 2 <= body.size())
+            {
+                size_t length = read_u16(body.data() + pos);
+                pos += 2;
+
+                // The filter is followed by the QoS requested for it.
+                if (pos + length + 1 <= body.size())
+                {
+                    std::string filter(reinterpret_cast<const char*>(body.data() + pos), length);
+                    auto qos = std::min(body[pos + length], static_cast<uint8_t>(2));
+                    pos += length + 1;
+
+                    auto existing = std::find_if(session.subscriptions.begin(), session.subscriptions.end(),
+                                                 [&filter](const std::pair<std::string, uint8_t>& s)
+                                                 {
+                                                     return s.first == filter;
+                                                 });
+
+                    if (existing == session.subscriptions.end())
+                    {
+                        session.subscriptions.emplace_back(std::move(filter), qos);
+                    }
+                    else
+                    {
+                        existing->second = qos;
+                    }
+
+                    granted.push_back(qos);
+                }
+                else
+                {
+                    pos = body.size();
+                }
+            }
+
+            session.out.clear();
+            begin_packet(session.out, 0x90, 2 + granted.size());
+            session.out.insert(session.out.end(), body.begin(), body.begin() + 2);
+            session.out.insert(session.out.end(), granted.begin(), granted.end());
+            session.connection.write(session.out.data(), static_cast<int>(session.out.size()));
+        }
+
+        void MqttBrokerDouble::unsubscribe(Session& session, const std::vector<uint8_t>& body)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            size_t pos = 2;
+
+            while (pos + 2 <= body.size())
+            {
+                size_t length = read_u16(body.data() + pos);
+                pos += 2;
+                std::string filter(reinterpret_cast<const char*>(body.data() + pos),
+                                   std::min(length, body.size() - pos));
+                pos += length;
+
+                session.subscriptions.erase(
+                        std::remove_if(session.subscriptions.begin(), session.subscriptions.end(),
+                                       [&filter](const std::pair<std::string, uint8_t>& s)
+                                       {
+                                           return s.first == filter;
+                                       }),
+                        session.subscriptions.end());
+            }
+
+            session.out.clear();
+            begin_packet(session.out, 0xB0, 2);
+            session.out.insert(session.out.end(), body.begin(), body.begin() + 2);
+            session.connection.write(session.out.data(), static_cast<int>(session.out.size()));
+        }
+
+        void MqttBrokerDouble::route(const char* topic, size_t topic_length, const uint8_t* payload,
+                                     size_t payload_length, uint8_t qos)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+
+            for (auto session : sessions)
+            {
+                // Delivered once per connection, at the highest QoS of the matching subscriptions.
+                int granted = -1;
+
+                for (auto& subscription : session->subscriptions)
+                {
+                    if (matches(subscription.first, topic, topic_length))
+                    {
+                        granted = std::max(granted, static_cast<int>(subscription.second));
+                    }
+                }
+
+                if (granted >= 0)
+                {
+                    auto delivered = static_cast<uint8_t>(std::min(static_cast<int>(qos), granted));
+                    auto& out = session->out;
+                    out.clear();
+                    begin_packet(out, static_cast<uint8_t>(publish << 4 | delivered << 1),
+                                 2 + topic_length + (delivered > 0 ? 2 : 0) + payload_length);
+                    append_u16(out, static_cast<uint16_t>(topic_length));
+                    out.insert(out.end(), topic, topic + topic_length);
+
+                    if (delivered > 0)
+                    {
+                        // Zero is not a valid packet identifier.
+                        if (++session->next_packet_identifier == 0)
+                        {
+                            ++session->next_packet_identifier;
+                        }
+
+                        append_u16(out, session->next_packet_identifier);
+                    }
+
+                    out.insert(out.end(), payload, payload + payload_length);
+                    session->connection.write(out.data(), static_cast<int>(out.size()));
+                }
+            }
+        }
+
+        void MqttBrokerDouble::acknowledge(Session& session, uint8_t header, uint16_t packet_identifier)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            session.out.clear();
+            begin_packet(session.out, header, 2);
+            append_u16(session.out, packet_identifier);
+            session.connection.write(session.out.data(), static_cast<int>(session.out.size()));
+        }
+
+        void MqttBrokerDouble::hold_pub_rec(Session& session, uint16_t packet_identifier)
+        {
+            std::lock_guard<std::mutex> lock(guard);
+            begin_packet(session.held_pub_recs, pub_rec << 4, 2);
+            append_u16(session.held_pub_recs, packet_identifier);
+
+            if (++session.held_pub_rec_count >= pub_rec_batch)
+            {
+                session.connection.write(session.held_pub_recs.data(), static_cast<int>(session.held_pub_recs.size()));
+                session.held_pub_recs.clear();
+                session.held_pub_rec_count = 0;
+            }
+        }
+
+        void MqttBrokerDouble::begin_packet(std::vector<uint8_t>& out, uint8_t header, size_t remaining_length)
+        {
+            out.push_back(header);
+
+            do
+            {
+                auto b = static_cast<uint8_t>(remaining_length & 0x7F);
+                remaining_length >>= 7;
+                out.push_back(remaining_length > 0 ? static_cast<uint8_t>(b | 0x80) : b);
+            } while (remaining_length > 0);
+        }
+
+        bool MqttBrokerDouble::matches(const std::string& filter, const char* topic, size_t length)
+        {
+            size_t f = 0;
+            size_t t = 0;
+            bool res = false;
+            bool done = false;
+
+            while (!done)
+            {
+                done = true;
+
+                if (f == filter.size())
+                {
+                    res = t == length;
+                }
+                else if (filter[f] == '#')
+                {
+                    res = true;
+                }
+                else if (filter[f] == '+')
+                {
+                    // A single level, possibly empty.
+                    while (t < length && topic[t] != '/')
+                    {
+                        ++t;
+                    }
+
+                    ++f;
+                    done = false;
+                }
+                else if (t < length && topic[t] == filter[f])
+                {
+                    ++f;
+                    ++t;
+                    done = false;
+                }
+                else
+                {
+                    // "a/#" also matches "a" itself.
+                    res = t == length && filter.compare(f, std::string::npos, "/#") == 0;
+                }
+            }
+
+            return res;
+        }
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "LoopbackServer.h"
+
+namespace smooth
+{
+    namespace test
+    {
+        /// A minimal MQTT 3.1.1 broker on loopback, standing in for a real one in tests and benchmarks.
+        /// It accepts any client, starts every session clean and keeps no retained messages. Published messages
+        /// are routed to the connections subscribed to a matching filter, + and # wildcards included, at the lower
+        /// of the published and the subscribed QoS. The QoS 1 and 2 flows are acknowledged in both directions, but
+        /// nothing is ever resent. Once a connection has sent its first messages, routing them doesn't allocate.
+        class MqttBrokerDouble
+                : public LoopbackServer
+        {
+            public:
+                MqttBrokerDouble() = default;
+
+                ~MqttBrokerDouble() override
+                {
+                    stop();
+                }
+
+                /// \return The number of PUBLISH packets received from clients.
+                int get_published_count() const
+                {
+                    return published;
+                }
+
+                /// Holds back PUBREC packets until the given number of them are due on a connection, then sends them
+                /// together, as a loaded broker may. Unless the count matches the window of the client, its QoS 2
+                /// messages stall. The default, one, sends each PUBREC right away.
+                void set_pub_rec_batch(size_t count)
+                {
+                    pub_rec_batch = count;
+                }
+
+            protected:
+                void serve(Connection& connection) override;
+
+            private:
+                class Session
+                {
+                    public:
+                        explicit Session(Connection& connection)
+                                : connection(connection)
+                        {
+                        }
+
+                        Connection& connection;
+                        // Topic filters and their QoS.
+                        std::vector<std::pair<std::string, uint8_t>> subscriptions{};
+                        uint16_t next_packet_identifier = 0;
+                        // Reused for the packets sent on the connection.
+                        std::vector<uint8_t> out{};
+                        // PUBREC packets held back, see set_pub_rec_batch().
+                        std::vector<uint8_t> held_pub_recs{};
+                        size_t held_pub_rec_count = 0;
+                };
+
+                static bool read_packet(Connection& connection, uint8_t& header, std::vector<uint8_t>& body);
+
+                // Returns false when the connection is to be closed.
+                bool handle(Session& session, uint8_t header, const std::vector<uint8_t>& body);
+
+                void subscribe(Session& session, const std::vector<uint8_t>& body);
+
+                void unsubscribe(Session& session, const std::vector<uint8_t>& body);
+
+                void route(const char* topic, size_t topic_length, const uint8_t* payload, size_t payload_length,
+                           uint8_t qos);
+
+                // Sends a packet consisting of the header and a packet identifier, such as PUBACK.
+                void acknowledge(Session& session, uint8_t header, uint16_t packet_identifier);
+
+                void hold_pub_rec(Session& session, uint16_t packet_identifier);
+
+                static void begin_packet(std::vector<uint8_t>& out, uint8_t header, size_t remaining_length);
+
+                static bool matches(const std::string& filter, const char* topic, size_t length);
+
+                // Guards the sessions and writing to them, as any connection may route messages to the others.
+                std::mutex guard{};
+                std::vector<Session*> sessions{};
+                std::atomic<int> published{0};
+                std::atomic<size_t> pub_rec_batch{1};
+        };
+    }
+}
@@ -0,0 +1,111 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#include "SelfSignedCertificate.h"
+#include <openssl/ec.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+namespace smooth
+{
+    namespace test
+    {
+        SelfSignedCertificate::SelfSignedCertificate()
+        {
+            auto key_context = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+
+            bool res = key_context != nullptr
+                       && EVP_PKEY_keygen_init(key_context) == 1
+                       && EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_context, NID_X9_62_prime256v1) == 1
+                       && EVP_PKEY_keygen(key_context, &key) == 1;
+
+            if (key_context != nullptr)
+            {
+                EVP_PKEY_CTX_free(key_context);
+            }
+
+            certificate = res ? X509_new() : nullptr;
+            res = certificate != nullptr;
+
+            if (res)
+            {
+                X509_set_version(certificate, 2);
+                ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+                X509_gmtime_adj(X509_getm_notBefore(certificate), -60);
+                X509_gmtime_adj(X509_getm_notAfter(certificate), 24 * 60 * 60);
+
+                auto name = X509_get_subject_name(certificate);
+                X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                           reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+                X509_set_issuer_name(certificate, name);
+                X509_set_pubkey(certificate, key);
+
+                X509V3_CTX extension_context;
+                X509V3_set_ctx_nodb(&extension_context);
+                X509V3_set_ctx(&extension_context, certificate, certificate, nullptr, nullptr, 0);
+                auto alt_name = X509V3_EXT_conf_nid(nullptr, &extension_context, NID_subject_alt_name,
+                                                    "DNS:localhost");
+
+                res = alt_name != nullptr
+                      && X509_add_ext(certificate, alt_name, -1) == 1
+                      && X509_sign(certificate, key, EVP_sha256()) > 0;
+
+                if (alt_name != nullptr)
+                {
+                    X509_EXTENSION_free(alt_name);
+                }
+            }
+
+            if (res)
+            {
+                auto bio = BIO_new(BIO_s_mem());
+                res = bio != nullptr && PEM_write_bio_X509(bio, certificate) == 1;
+
+                if (res)
+                {
+                    char* data;
+                    auto length = BIO_get_mem_data(bio, &data);
+                    pem.assign(data, static_cast<size_t>(length));
+                }
+
+                if (bio != nullptr)
+                {
+                    BIO_free(bio);
+                }
+            }
+
+            if (res)
+            {
+                server_context = SSL_CTX_new(TLS_server_method());
+                res = server_context != nullptr
+                      && SSL_CTX_use_certificate(server_context, certificate) == 1
+                      && SSL_CTX_use_PrivateKey(server_context, key) == 1;
+
+                if (!res && server_context != nullptr)
+                {
+                    SSL_CTX_free(server_context);
+                    server_context = nullptr;
+                }
+            }
+        }
+
+        SelfSignedCertificate::~SelfSignedCertificate()
+        {
+            if (server_context != nullptr)
+            {
+                SSL_CTX_free(server_context);
+            }
+
+            if (certificate != nullptr)
+            {
+                X509_free(certificate);
+            }
+
+            if (key != nullptr)
+            {
+                EVP_PKEY_free(key);
+            }
+        }
+    }
+}
@@ -0,0 +1,53 @@
+//
+// Created by agent on 10/19/26.
+//
+
+#pragma once
+
+#include <string>
+#include <openssl/ssl.h>
+
+namespace smooth
+{
+    namespace test
+    {
+        /// A key and a self-signed certificate for a TLS server on loopback, generated when constructed so that
+        /// no key material needs to be kept in the repository. The certificate is issued for the host name
+        /// "localhost" and serves as its own CA certificate on the client side.
+        class SelfSignedCertificate
+        {
+            public:
+                SelfSignedCertificate();
+
+                ~SelfSignedCertificate();
+
+                SelfSignedCertificate(const SelfSignedCertificate&) = delete;
+                SelfSignedCertificate& operator=(const SelfSignedCertificate&) = delete;
+
+                /// Returns a value indicating if the key and certificate could be generated.
+                /// \return true or false
+                bool is_valid() const
+                {
+                    return server_context != nullptr;
+                }
+
+                /// \return The certificate in PEM format, to be added as a trusted CA certificate by clients.
+                const std::string& get_pem() const
+                {
+                    return pem;
+                }
+
+                /// \return A server context using the key and certificate, e.g. for a LoopbackServer.
+                SSL_CTX* get_server_context()
+                {
+                    return server_context;
+                }
+
+            private:
+                EVP_PKEY* key = nullptr;
+                X509* certificate = nullptr;
+                SSL_CTX* server_context = nullptr;
+                std::string pem{};
+        };
+    }
+}
@@ -0,0 +1,348 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that DnsResolver orders and caches addresses, and that Socket connects to them Happy Eyeballs style.
+//
+// Hosts added with fixed addresses must come back with the address families interleaved, the preferred one first.
+// A name looked up via the name server must be answered from the resolver task the first time and directly from
+// the cache the second time. Then an echo server listens on 127.0.0.1, and sockets connect to host names whose
+// first address is ::1 on the same port. Where nothing listens on ::1, the refused attempt must move straight on to
+// 127.0.0.1. Where the attempt to ::1 gets no answer, because a listener there has a full backlog, 127.0.0.1 must
+// be tried in parallel once the attempt delay of 250 ms has passed.
+//
+// Usage: dns_resolver
+// The exit code is non-zero if any case fails.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <smooth/core/Application.h>
+#include <smooth/core/network/DnsResolver.h>
+#include <smooth/core/network/HostName.h>
+#include <smooth/core/network/LengthPrefixedPacket.h>
+#include <smooth/core/network/PacketReceiveBuffer.h>
+#include <smooth/core/network/PacketSendBuffer.h>
+#include <smooth/core/network/Socket.h>
+#include <common/EchoServer.h>
+
+using namespace std::chrono;
+using namespace smooth::core;
+using namespace smooth::core::network;
+
+namespace smooth
+{
+    namespace test
+    {
+        using EchoPacket = LengthPrefixedPacket<LengthPrefix::U16BigEndian, 64>;
+
+        // A connection that remembers when it was established.
+        class Client
+                : public ipc::IEventListener<TransmitBufferEmptyEvent>,
+                  public ipc::IEventListener<DataAvailableEvent<EchoPacket>>,
+                  public ipc::IEventListener<ConnectionStatusEvent>
+        {
+            public:
+                explicit Client(Task& task)
+                        : tx_empty("tx_empty", 5, task, *this),
+                          data_available("data_available", 5, task, *this),
+                          connection_status("connection_status", 5, task, *this)
+                {
+                }
+
+                void start(const std::string& host_name, uint16_t port)
+                {
+                    started = steady_clock::now();
+                    socket = Socket<EchoPacket>::create(tx, rx, tx_empty, data_available, connection_status);
+                    socket->start(std::make_shared<HostName>(host_name, port));
+                }
+
+                bool has_connected() const
+                {
+                    return connected != steady_clock::time_point{};
+                }
+
+                milliseconds get_connect_time() const
+                {
+                    return duration_cast<milliseconds>(connected - started);
+                }
+
+                void event(const TransmitBufferEmptyEvent&) override
+                {
+                }
+
+                void event(const DataAvailableEvent<EchoPacket>&) override
+                {
+                }
+
+                void event(const ConnectionStatusEvent& event) override
+                {
+                    if (event.is_connected() && !has_connected())
+                    {
+                        connected = steady_clock::now();
+                    }
+                }
+
+            private:
+                PacketSendBuffer<EchoPacket, 2> tx{};
+                PacketReceiveBuffer<EchoPacket, 2> rx{};
+                ipc::TaskEventQueue<TransmitBufferEmptyEvent> tx_empty;
+                ipc::TaskEventQueue<DataAvailableEvent<EchoPacket>> data_available;
+                ipc::TaskEventQueue<ConnectionStatusEvent> connection_status;
+                std::shared_ptr<ISocket> socket{};
+                steady_clock::time_point started{};
+                steady_clock::time_point connected{};
+        };
+
+        class DnsResolverTest
+                : public core::POSIXApplication
+        {
+            public:
+                DnsResolverTest()
+                        : POSIXApplication(5, milliseconds(10))
+                {
+                }
+
+                void init() override;
+
+                void tick() override;
+
+            private:
+                enum class Phase
+                {
+                    Lookup,
+                    Refused,
+                    Stalled
+                };
+
+                void check_fixed_hosts();
+                void check_cached_lookup();
+                bool stall_ipv6();
+                void check(const char* desc, bool passed);
+                static std::vector<std::string> to_strings(const AddressList& addresses, uint16_t port);
+                static void finish(int exit_code);
+
+                EchoServer server{};
+                Phase phase = Phase::Lookup;
+                steady_clock::time_point phase_start{};
+                // Set from the resolver task.
+                std::mutex guard{};
+                AddressList looked_up{};
+                std::thread::id lookup_thread{};
+                std::atomic<bool> lookup_done{false};
+                // Kept until the process ends, as their sockets may still refer to them.
+                std::vector<std::unique_ptr<Client>> clients{};
+                std::vector<int> stalled_sockets{};
+                int failed = 0;
+        };
+
+        void DnsResolverTest::init()
+        {
+            POSIXApplication::init();
+
+            if (!server.start())
+            {
+                printf("Could not start the echo server\n");
+                finish(1);
+            }
+
+            check_fixed_hosts();
+
+            // The first lookup of a name goes via the resolver task.
+            auto& resolver = DnsResolver::instance();
+            resolver.clear_cache();
+            resolver.resolve("localhost", 1234, [this](const AddressList& addresses)
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                looked_up = addresses;
+                lookup_thread = std::this_thread::get_id();
+                lookup_done = true;
+            });
+
+            phase_start = steady_clock::now();
+        }
+
+        void DnsResolverTest::check_fixed_hosts()
+        {
+            auto& resolver = DnsResolver::instance();
+            resolver.add_host("ipv4-first.test", {"127.0.0.1", "127.0.0.2", "::1", "not an address"});
+            resolver.add_host("ipv6-first.test", {"::1", "::2", "::3", "127.0.0.1"});
+
+            AddressList ipv4_first;
+            AddressList ipv6_first;
+            resolver.resolve("ipv4-first.test", 80, [&ipv4_first](const AddressList& a)
+            {
+                ipv4_first = a;
+            });
+            resolver.resolve("ipv6-first.test", 443, [&ipv6_first](const AddressList& a)
+            {
+                ipv6_first = a;
+            });
+
+            check("Families are interleaved, IPv4 first",
+                  to_strings(ipv4_first, 80) == std::vector<std::string>{"127.0.0.1", "::1", "127.0.0.2"});
+            check("Families are interleaved, IPv6 first",
+                  to_strings(ipv6_first, 443) == std::vector<std::string>{"::1", "127.0.0.1", "::2", "::3"});
+
+            resolver.clear_cache();
+            AddressList kept;
+            resolver.resolve("ipv4-first.test", 80, [&kept](const AddressList& a)
+            {
+                kept = a;
+            });
+
+            check("Added hosts are kept when the cache is cleared", kept.size() == 3);
+        }
+
+        void DnsResolverTest::check_cached_lookup()
+        {
+            std::vector<std::string> first;
+
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                first = to_strings(looked_up, 1234);
+                check("A name not cached is resolved by the resolver task",
+                      lookup_thread != std::this_thread::get_id());
+            }
+
+            check("localhost resolves to 127.0.0.1",
+                  std::find(first.begin(), first.end(), "127.0.0.1") != first.end());
+
+            bool answered = false;
+            std::vector<std::string> second;
+            DnsResolver::instance().resolve("localhost", 1234, [&answered, &second](const AddressList& a)
+            {
+                answered = true;
+                second = to_strings(a, 1234);
+            });
+
+            check("A cached name is resolved from within the call", answered && second == first);
+        }
+
+        void DnsResolverTest::tick()
+        {
+            auto now = steady_clock::now();
+
+            if (phase == Phase::Lookup && lookup_done)
+            {
+                check_cached_lookup();
+
+                // Nothing listens on ::1, so that attempt is refused at once.
+                DnsResolver::instance().add_host("refused.test", {"::1", "127.0.0.1"});
+                clients.emplace_back(new Client(*this));
+                clients.back()->start("refused.test", server.get_port());
+                phase = Phase::Refused;
+                phase_start = now;
+            }
+            else if (phase == Phase::Refused && clients.back()->has_connected())
+            {
+                auto time = clients.back()->get_connect_time();
+                printf("Connected after %lld ms with ::1 refused\n", static_cast<long long>(time.count()));
+                check("A refused attempt moves straight on to the next address", time < milliseconds(250));
+
+                if (!stall_ipv6())
+                {
+                    printf("Could not listen on ::1\n");
+                    finish(1);
+                }
+
+                DnsResolver::instance().add_host("stalled.test", {"::1", "127.0.0.1"});
+                clients.emplace_back(new Client(*this));
+                clients.back()->start("stalled.test", server.get_port());
+                phase = Phase::Stalled;
+                phase_start = now;
+            }
+            else if (phase == Phase::Stalled && clients.back()->has_connected())
+            {
+                auto time = clients.back()->get_connect_time();
+                printf("Connected after %lld ms with ::1 not answering\n", static_cast<long long>(time.count()));
+                check("The next address is tried once the attempt delay has passed",
+                      time >= milliseconds(250) && time < seconds(2));
+                check("The server accepted both connections", server.get_connection_count() == 2);
+                finish(failed == 0 ? 0 : 1);
+            }
+
+            if (now - phase_start > seconds(8))
+            {
+                printf("Timed out in phase %d\n", static_cast<int>(phase));
+                finish(1);
+            }
+        }
+
+        bool DnsResolverTest::stall_ipv6()
+        {
+            sockaddr_in6 address{};
+            address.sin6_family = AF_INET6;
+            address.sin6_port = htons(server.get_port());
+            address.sin6_addr = in6addr_loopback;
+
+            auto listener = ::socket(AF_INET6, SOCK_STREAM, 0);
+            stalled_sockets.push_back(listener);
+
+            bool res = listener >= 0
+                       && bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+                       && listen(listener, 0) == 0;
+
+            // Connections that are never accepted fill the backlog, after which the listener doesn't answer.
+            for (int i = 0; res && i < 4; ++i)
+            {
+                auto s = ::socket(AF_INET6, SOCK_STREAM, 0);
+                stalled_sockets.push_back(s);
+                res = s >= 0 && fcntl(s, F_SETFL, fcntl(s, F_GETFL) | O_NONBLOCK) == 0;
+                res = res && connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0;
+                usleep(50000);
+            }
+
+            return res;
+        }
+
+        void DnsResolverTest::check(const char* desc, bool passed)
+        {
+            printf("%s: %s\n", passed ? "PASS" : "FAIL", desc);
+
+            if (!passed)
+            {
+                ++failed;
+            }
+        }
+
+        std::vector<std::string> DnsResolverTest::to_strings(const AddressList& addresses, uint16_t port)
+        {
+            std::vector<std::string> res;
+
+            for (auto& address : addresses)
+            {
+                // Marks an address with the wrong port, so that the comparison fails.
+                res.push_back(address->get_port() == port ? address->get_ip_as_string() : "wrong port");
+            }
+
+            return res;
+        }
+
+        void DnsResolverTest::finish(int code)
+        {
+            fflush(stdout);
+            // The dispatcher, the resolver and the server threads run until the process ends.
+            _exit(code);
+        }
+    }
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    smooth::test::DnsResolverTest test;
+    test.start();
+
+    return 0;
+}
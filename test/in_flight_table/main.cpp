@@ -0,0 +1,287 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that InFlightTable finds, removes and orders packets correctly: when probing wraps around the end of the
+// slots, when removal shifts colliding packets back, when the table grows past what was reserved, and for the
+// lowest and highest packet identifiers. A long random sequence of operations is also compared with a std::map and
+// a std::list holding the same packets.
+//
+// Usage: in_flight_table
+// The exit code is non-zero if any case fails.
+
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <vector>
+#include <smooth/application/network/mqtt/InFlightTable.h>
+
+using namespace smooth::application::network::mqtt;
+
+namespace smooth
+{
+    namespace test
+    {
+        class InFlightTableTest
+        {
+            public:
+                int run()
+                {
+                    lowest_and_highest_identifiers();
+                    probe_wraps_around();
+                    removal_shifts_back();
+                    grows_past_reserved();
+                    keeps_order();
+                    matches_model();
+
+                    printf("%d failed\n", failed);
+                    return failed == 0 ? 0 : 1;
+                }
+
+            private:
+                using Table = InFlightTable<int>;
+
+                void check(const char* desc, bool passed)
+                {
+                    printf("%s: %s\n", passed ? "PASS" : "FAIL", desc);
+
+                    if (!passed)
+                    {
+                        ++failed;
+                    }
+                }
+
+                // Identifiers whose home is the last of the eight slots of a table reserved for four packets, found
+                // the way the table hashes them.
+                static std::vector<uint16_t> ids_in_last_slot(size_t count)
+                {
+                    std::vector<uint16_t> res;
+
+                    for (uint32_t id = 1; res.size() < count && id <= 0xFFFF; ++id)
+                    {
+                        if ((id * 2654435769u) >> 29 == 7)
+                        {
+                            res.push_back(static_cast<uint16_t>(id));
+                        }
+                    }
+
+                    return res;
+                }
+
+                static bool holds(Table& table, uint16_t id, int value)
+                {
+                    auto found = table.find(id);
+                    return found != nullptr && *found == value;
+                }
+
+                static std::vector<int32_t> order(Table& table)
+                {
+                    std::vector<int32_t> res;
+
+                    for (auto id = table.first_id(); id >= 0; id = table.next_id(static_cast<uint16_t>(id)))
+                    {
+                        res.push_back(id);
+                    }
+
+                    return res;
+                }
+
+                void lowest_and_highest_identifiers()
+                {
+                    Table table;
+                    table.insert(0, 10);
+                    table.insert(0xFFFF, 20);
+
+                    check("Identifiers 0 and 65535 are found", holds(table, 0, 10) && holds(table, 0xFFFF, 20));
+                    check("Identifiers 0 and 65535 are ordered",
+                          table.first_id() == 0 && table.last_id() == 0xFFFF && table.next_id(0) == 0xFFFF
+                          && table.previous_id(0xFFFF) == 0);
+
+                    table.erase(0);
+                    check("Identifier 0 is removed",
+                          table.find(0) == nullptr && holds(table, 0xFFFF, 20) && table.first_id() == 0xFFFF);
+
+                    table.erase(0xFFFF);
+                    check("Identifier 65535 is removed",
+                          table.empty() && table.find(0xFFFF) == nullptr && table.first_id() == -1);
+                }
+
+                void probe_wraps_around()
+                {
+                    // Placed in the last slot and, wrapping around, the first two.
+                    auto ids = ids_in_last_slot(3);
+                    Table table(4);
+
+                    for (size_t i = 0; i < ids.size(); ++i)
+                    {
+                        table.insert(ids[i], static_cast<int>(i));
+                    }
+
+                    check("Packets past the end of the slots are found",
+                          holds(table, ids[0], 0) && holds(table, ids[1], 1) && holds(table, ids[2], 2));
+
+                    table.erase(ids[0]);
+                    check("Removal shifts packets back across the end of the slots",
+                          table.find(ids[0]) == nullptr && holds(table, ids[1], 1) && holds(table, ids[2], 2));
+
+                    table.insert(ids[0], 3);
+                    check("A packet is added again after the others",
+                          holds(table, ids[0], 3) && order(table) == std::vector<int32_t>{ids[1], ids[2], ids[0]});
+                }
+
+                void removal_shifts_back()
+                {
+                    // Three packets that share a home slot, followed by one at home in the slot after it.
+                    auto ids = ids_in_last_slot(3);
+                    uint16_t other = 0;
+
+                    for (uint32_t id = 1; other == 0 && id <= 0xFFFF; ++id)
+                    {
+                        if ((id * 2654435769u) >> 29 == 0)
+                        {
+                            other = static_cast<uint16_t>(id);
+                        }
+                    }
+
+                    Table table(4);
+                    table.insert(ids[0], 0);
+                    table.insert(ids[1], 1);
+                    table.insert(other, 4);
+                    table.insert(ids[2], 2);
+
+                    table.erase(ids[1]);
+                    check("Packets after a removed one are found",
+                          holds(table, ids[0], 0) && holds(table, ids[2], 2) && holds(table, other, 4));
+
+                    table.erase(ids[0]);
+                    check("Packets are found after removing the first of a run",
+                          holds(table, ids[2], 2) && holds(table, other, 4) && table.size() == 2);
+
+                    table.erase(other);
+                    check("A packet shifted past its home slot is still found", holds(table, ids[2], 2));
+
+                    check("Removing a packet that isn't there does nothing",
+                          !table.erase(ids[0]) && table.size() == 1);
+                }
+
+                void grows_past_reserved()
+                {
+                    Table table(4);
+                    bool found = true;
+                    bool ordered = true;
+
+                    for (uint32_t id = 0; id < 1000; ++id)
+                    {
+                        table.insert(static_cast<uint16_t>(id * 65), static_cast<int>(id));
+                    }
+
+                    auto ids = order(table);
+
+                    for (uint32_t id = 0; id < 1000; ++id)
+                    {
+                        found = found && holds(table, static_cast<uint16_t>(id * 65), static_cast<int>(id));
+                        ordered = ordered && ids.size() == 1000 && ids[id] == static_cast<int32_t>(id * 65);
+                    }
+
+                    check("All packets are found after growing", found && table.size() == 1000);
+                    check("Packets keep their order when growing", ordered);
+                }
+
+                void keeps_order()
+                {
+                    Table table;
+
+                    for (uint16_t id = 1; id <= 5; ++id)
+                    {
+                        table.insert(id, id);
+                    }
+
+                    table.move_to_back(2);
+                    table.move_to_back(5);
+                    table.erase(3);
+                    table.insert(1, 100);
+
+                    std::vector<int32_t> visited;
+                    table.for_each([&visited](uint16_t id, int&)
+                                   {
+                                       visited.push_back(id);
+                                   });
+
+                    check("Packets are kept in the order they were added or moved",
+                          order(table) == std::vector<int32_t>{1, 4, 2, 5} && visited == order(table));
+                    check("Adding an existing packet keeps it", holds(table, 1, 1));
+
+                    std::vector<int32_t> backwards;
+
+                    for (auto id = table.last_id(); id >= 0; id = table.previous_id(static_cast<uint16_t>(id)))
+                    {
+                        backwards.push_back(id);
+                    }
+
+                    check("Packets are walked backwards", backwards == std::vector<int32_t>{5, 2, 4, 1});
+
+                    table.clear();
+                    table.insert(7, 7);
+                    check("A cleared table starts a new order", order(table) == std::vector<int32_t>{7});
+                }
+
+                void matches_model()
+                {
+                    Table table;
+                    std::map<uint16_t, int> values;
+                    std::list<uint16_t> ids;
+                    bool same = true;
+                    srand(1);
+
+                    for (int step = 0; step < 100000 && same; ++step)
+                    {
+                        // Identifiers on both sides of where they wrap around, from 65500 to 35.
+                        auto id = static_cast<uint16_t>(65500 + rand() % 72);
+                        auto op = rand() % 4;
+
+                        if (op < 2)
+                        {
+                            table.insert(id, static_cast<int>(step));
+
+                            if (values.emplace(id, step).second)
+                            {
+                                ids.push_back(id);
+                            }
+                        }
+                        else if (op == 2)
+                        {
+                            same = table.erase(id) == (values.erase(id) == 1);
+                            ids.remove(id);
+                        }
+                        else if (values.count(id) != 0)
+                        {
+                            table.move_to_back(id);
+                            ids.remove(id);
+                            ids.push_back(id);
+                        }
+
+                        auto found = table.find(id);
+                        auto expected = values.find(id);
+                        same = same && table.size() == values.size()
+                               && (expected == values.end() ? found == nullptr
+                                                            : found != nullptr && *found == expected->second)
+                               && order(table) == std::vector<int32_t>(ids.begin(), ids.end());
+                    }
+
+                    check("Random operations match a std::map and a std::list", same);
+                }
+
+                int failed = 0;
+        };
+    }
+}
+
+int main(int, char**)
+{
+    smooth::test::InFlightTableTest test;
+    auto res = test.run();
+    fflush(stdout);
+
+    return res;
+}
@@ -0,0 +1,346 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Publish/subscribe benchmark for MqttClient.
+//
+// Starts an MQTT broker double on loopback and connects two clients to it: one publishes to bench/qos<n>, the other
+// subscribes to bench/# at QoS 2, so that messages are delivered at the QoS they were published with. For each QoS
+// and payload size in turn, the publisher keeps a window of messages outstanding until the given number of them has
+// been received by the subscriber. Each payload starts with the time it was published at, so the subscriber measures
+// the end-to-end latency. It reports messages per second, latency percentiles and heap allocations per message,
+// counted across the process (the broker double doesn't allocate per message, so these are the clients').
+//
+// The clients send what is queued each time their task ticks, every 50 ms, which bounds both the rate and the
+// latency; MqttClientOptions::transmit_buffer_packets and the in-flight window are raised to make room for that.
+// The host build logs MQTT traffic at the verbose level. The log, written to std::cout, is discarded, but building
+// its messages is included in the figures.
+//
+// Usage: mqtt_benchmark [messages per run] [payload size...]
+// Payloads are at least 16 bytes. The exit code is non-zero if a run times out or a received message doesn't match
+// what was published.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <smooth/core/Application.h>
+#include <smooth/core/network/IPv4.h>
+#include <smooth/application/network/mqtt/MqttClient.h>
+#include <common/AllocationCounter.h>
+#include <common/LatencyStatistics.h>
+#include <common/MqttBrokerDouble.h>
+
+using namespace std::chrono;
+using namespace smooth::core;
+using namespace smooth::application::network::mqtt;
+
+namespace smooth
+{
+    namespace test
+    {
+        // The payload starts with the publishing time, the run and the sequence number of the message.
+        static const size_t header_size = 16;
+        // The sequence number of the messages published until the subscriber has received one.
+        static const uint32_t probe = 0xFFFFFFFF;
+        static const size_t window = 32;
+        static const char topic_prefix[] = "bench/qos";
+
+        class MqttBenchmark
+                : public core::POSIXApplication,
+                  public ipc::IEventListener<MQTTData>
+        {
+            public:
+                MqttBenchmark(uint32_t message_count, std::vector<uint32_t> sizes)
+                        : POSIXApplication(5, milliseconds(10)),
+                          message_count(message_count),
+                          sizes(std::move(sizes)),
+                          publisher_queue("publisher_queue", 10, *this, *this),
+                          subscriber_queue("subscriber_queue", 2 * window, *this, *this),
+                          latency(message_count)
+                {
+                }
+
+                void init() override;
+
+                void tick() override;
+
+                void event(const MQTTData& event) override;
+
+            private:
+                enum class Phase
+                {
+                    Probe,
+                    Measure
+                };
+
+                static std::unique_ptr<MqttClient> create_client(const std::string& id,
+                                                                 ipc::TaskEventQueue<MQTTData>& queue);
+                void start_run();
+                void publish_window();
+                bool publish(uint32_t sequence);
+                void report();
+                static void finish(int exit_code);
+
+                uint32_t message_count;
+                std::vector<uint32_t> sizes;
+                MqttBrokerDouble broker{};
+                // Receives nothing, as the publisher doesn't subscribe.
+                ipc::TaskEventQueue<MQTTData> publisher_queue;
+                ipc::TaskEventQueue<MQTTData> subscriber_queue;
+                // Clients are kept until the process ends, as their sockets may still refer to them.
+                std::unique_ptr<MqttClient> publisher{};
+                std::unique_ptr<MqttClient> subscriber{};
+                // One run per QoS and payload size, QoS first.
+                size_t run = 0;
+                std::string topic{};
+                std::vector<uint8_t> payload{};
+                std::vector<bool> received{};
+                uint32_t published = 0;
+                uint32_t received_count = 0;
+                Phase phase = Phase::Probe;
+                steady_clock::time_point run_start{};
+                steady_clock::time_point last_probe{};
+                uint64_t allocations_at_start = 0;
+                LatencyStatistics latency;
+        };
+
+        void MqttBenchmark::init()
+        {
+            POSIXApplication::init();
+
+            // Only the report, written with printf, is of interest.
+            std::cout.setstate(std::ios::badbit);
+
+            if (!broker.start())
+            {
+                printf("Could not start the broker\n");
+                finish(1);
+            }
+
+            publisher = create_client("publisher", publisher_queue);
+            subscriber = create_client("subscriber", subscriber_queue);
+            subscriber->subscribe("bench/#", QoS::EXACTLY_ONCE);
+
+            publisher->connect_to(std::make_shared<network::IPv4>("127.0.0.1", broker.get_port()), true);
+            subscriber->connect_to(std::make_shared<network::IPv4>("127.0.0.1", broker.get_port()), true);
+
+            printf("MqttClient publish/subscribe via a broker double on loopback: %u messages per run, "
+                   "%u outstanding\n", message_count, static_cast<uint32_t>(window));
+            printf("%4s %8s %10s %9s %9s %9s %11s\n", "QoS", "size", "msgs/s", "p50 us", "p99 us", "p999 us",
+                   "allocs/msg");
+
+            start_run();
+        }
+
+        std::unique_ptr<MqttClient> MqttBenchmark::create_client(const std::string& id,
+                                                                 ipc::TaskEventQueue<MQTTData>& queue)
+        {
+            MqttClientOptions options;
+            // Room for the whole window in a single tick of the client.
+            options.max_outgoing_messages = 2 * window;
+            options.transmit_buffer_packets = 2 * window;
+
+            std::unique_ptr<MqttClient> client(new MqttClient(id, seconds(30), 8192, 5, queue, options));
+            client->set_max_in_flight_publishes(window);
+
+            return client;
+        }
+
+        void MqttBenchmark::start_run()
+        {
+            auto qos = run / sizes.size();
+            topic = topic_prefix + std::to_string(qos);
+            payload.assign(sizes[run % sizes.size()], 0);
+
+            for (size_t i = header_size; i < payload.size(); ++i)
+            {
+                payload[i] = static_cast<uint8_t>(i * 31 + 7);
+            }
+
+            received.assign(message_count, false);
+            published = 0;
+            received_count = 0;
+            phase = Phase::Probe;
+            run_start = steady_clock::now();
+            last_probe = steady_clock::time_point{};
+        }
+
+        void MqttBenchmark::tick()
+        {
+            auto now = steady_clock::now();
+
+            if (phase == Phase::Probe && now - last_probe > milliseconds(100))
+            {
+                // Until both clients are connected and subscribed, messages may be lost; probes are sent until one
+                // gets through.
+                last_probe = now;
+                publish(probe);
+            }
+            else if (phase == Phase::Measure)
+            {
+                publish_window();
+            }
+
+            if (now - run_start > seconds(30))
+            {
+                printf("%4u %8u timed out with %u of %u messages received\n",
+                       static_cast<uint32_t>(run / sizes.size()), static_cast<uint32_t>(payload.size()),
+                       received_count, message_count);
+                finish(1);
+            }
+        }
+
+        void MqttBenchmark::event(const MQTTData& event)
+        {
+            auto now = steady_clock::now();
+            auto& data = event.second;
+            int64_t sent_at;
+            uint32_t message_run;
+            uint32_t sequence;
+
+            bool well_formed = data.size() >= header_size;
+
+            if (well_formed)
+            {
+                memcpy(&sent_at, data.data(), sizeof(sent_at));
+                memcpy(&message_run, data.data() + 8, sizeof(message_run));
+                memcpy(&sequence, data.data() + 12, sizeof(sequence));
+            }
+
+            // Probes and messages of earlier runs may still arrive after a run has started.
+            if (well_formed && message_run == run)
+            {
+                well_formed = event.first == topic
+                              && data.size() == payload.size()
+                              && (sequence == probe || sequence < message_count)
+                              && std::equal(data.begin() + header_size, data.end(),
+                                            payload.begin() + header_size);
+
+                if (well_formed && sequence == probe && phase == Phase::Probe)
+                {
+                    phase = Phase::Measure;
+                    latency.clear();
+                    run_start = now;
+                    allocations_at_start = AllocationCounter::get_count();
+                    publish_window();
+                }
+                else if (well_formed && sequence != probe && !received[sequence])
+                {
+                    received[sequence] = true;
+                    ++received_count;
+                    latency.add(now.time_since_epoch() - nanoseconds(sent_at));
+
+                    if (received_count == message_count)
+                    {
+                        report();
+
+                        if (++run < 3 * sizes.size())
+                        {
+                            start_run();
+                        }
+                        else
+                        {
+                            finish(0);
+                        }
+                    }
+                    else
+                    {
+                        publish_window();
+                    }
+                }
+            }
+
+            if (!well_formed)
+            {
+                printf("A received message doesn't match what was published\n");
+                finish(1);
+            }
+        }
+
+        void MqttBenchmark::publish_window()
+        {
+            while (published < message_count && published - received_count < window && publish(published))
+            {
+                ++published;
+            }
+        }
+
+        bool MqttBenchmark::publish(uint32_t sequence)
+        {
+            auto sent_at = static_cast<int64_t>(duration_cast<nanoseconds>(
+                    steady_clock::now().time_since_epoch()).count());
+            auto message_run = static_cast<uint32_t>(run);
+            memcpy(payload.data(), &sent_at, sizeof(sent_at));
+            memcpy(payload.data() + 8, &message_run, sizeof(message_run));
+            memcpy(payload.data() + 12, &sequence, sizeof(sequence));
+
+            // Copied into the packet, so the payload can be reused right away.
+            return publisher->publish(topic, payload.data(), static_cast<int>(payload.size()),
+                                      static_cast<QoS>(run / sizes.size()), false);
+        }
+
+        void MqttBenchmark::report()
+        {
+            auto seconds_run = duration_cast<std::chrono::duration<double>>(steady_clock::now() - run_start).count();
+            auto allocations = AllocationCounter::get_count() - allocations_at_start;
+
+            printf("%4u %8u %10.0f %9lld %9lld %9lld %11.2f\n",
+                   static_cast<uint32_t>(run / sizes.size()),
+                   static_cast<uint32_t>(payload.size()),
+                   static_cast<double>(message_count) / seconds_run,
+                   static_cast<long long>(latency.get_percentile(50).count()),
+                   static_cast<long long>(latency.get_percentile(99).count()),
+                   static_cast<long long>(latency.get_percentile(99.9).count()),
+                   static_cast<double>(allocations) / static_cast<double>(message_count));
+        }
+
+        void MqttBenchmark::finish(int code)
+        {
+            fflush(stdout);
+            // The client tasks, the dispatcher and the broker threads run until the process ends.
+            _exit(code);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // The encoded topic and packet identifier take the rest of the largest message.
+    const uint32_t max_size = CONFIG_SMOOTH_MAX_MQTT_MESSAGE_SIZE - 2 - (sizeof(smooth::test::topic_prefix) - 1) - 1 - 2;
+    auto message_count = static_cast<uint32_t>(argc > 1 ? atoi(argv[1]) : 10000);
+    std::vector<uint32_t> sizes;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        sizes.push_back(static_cast<uint32_t>(atoi(argv[i])));
+    }
+
+    if (sizes.empty())
+    {
+        sizes = {16, 256, 1024, max_size};
+    }
+
+    bool valid = message_count > 0 && std::all_of(sizes.begin(), sizes.end(), [max_size](uint32_t size)
+    {
+        return size >= smooth::test::header_size && size <= max_size;
+    });
+
+    if (!valid)
+    {
+        printf("Usage: mqtt_benchmark [messages per run] [payload size...]\n"
+               "Payload sizes are from %u to %u bytes.\n", static_cast<uint32_t>(smooth::test::header_size), max_size);
+        return 1;
+    }
+
+    smooth::test::MqttBenchmark benchmark(message_count, sizes);
+    benchmark.start();
+
+    return 0;
+}
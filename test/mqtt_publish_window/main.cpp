@@ -0,0 +1,165 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that MqttClient completes QoS 2 publishes when its in-flight window is larger than its transmit buffer.
+//
+// The client publishes to an MQTT broker double on loopback that holds back its PUBREC packets until a whole
+// window of them is due, then sends them together. Not all of the PUBREL replies fit in the transmit buffer at once;
+// those that don't must be sent as the client ticks, rather than being left for the five second reply timeout and
+// the reconnect it forces.
+//
+// Usage: mqtt_publish_window
+// The exit code is non-zero if the messages aren't all acknowledged within a few seconds, or the client reconnected.
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <unistd.h>
+#include <smooth/core/Application.h>
+#include <smooth/core/network/IPv4.h>
+#include <smooth/application/network/mqtt/MqttClient.h>
+#include <common/MqttBrokerDouble.h>
+
+using namespace std::chrono;
+using namespace smooth::core;
+using namespace smooth::application::network::mqtt;
+
+namespace smooth
+{
+    namespace test
+    {
+        static const size_t transmit_buffer_packets = 4;
+        static const size_t window = 4 * transmit_buffer_packets;
+        static const size_t message_count = 8 * window;
+
+        class MqttPublishWindowTest
+                : public core::POSIXApplication,
+                  public ipc::IEventListener<MQTTData>
+        {
+            public:
+                MqttPublishWindowTest()
+                        : POSIXApplication(5, milliseconds(10)),
+                          queue("queue", 10, *this, *this)
+                {
+                }
+
+                void init() override;
+
+                void tick() override;
+
+                void event(const MQTTData&) override
+                {
+                }
+
+            private:
+                void check(const char* desc, bool passed);
+
+                static void finish(int exit_code);
+
+                MqttBrokerDouble broker{};
+                // Receives nothing, as the client doesn't subscribe.
+                ipc::TaskEventQueue<MQTTData> queue;
+                // Kept until the process ends, as its socket may still refer to it.
+                std::unique_ptr<MqttClient> client{};
+                steady_clock::time_point connected_at{};
+                steady_clock::time_point published_at{};
+                int connections = 0;
+                bool published = false;
+                int failed = 0;
+        };
+
+        void MqttPublishWindowTest::init()
+        {
+            POSIXApplication::init();
+
+            // Only the results, written with printf, are of interest.
+            std::cout.setstate(std::ios::badbit);
+
+            broker.set_pub_rec_batch(window);
+
+            if (!broker.start())
+            {
+                printf("Could not start the broker\n");
+                finish(1);
+            }
+
+            MqttClientOptions options;
+            options.max_outgoing_messages = message_count;
+            options.transmit_buffer_packets = transmit_buffer_packets;
+
+            client.reset(new MqttClient("window", seconds(30), 8192, 5, queue, options));
+            client->set_max_in_flight_publishes(window);
+            client->connect_to(std::make_shared<network::IPv4>("127.0.0.1", broker.get_port()), true);
+        }
+
+        void MqttPublishWindowTest::tick()
+        {
+            auto now = steady_clock::now();
+
+            if (!published && client->is_connected())
+            {
+                if (connected_at == steady_clock::time_point{})
+                {
+                    connected_at = now;
+                }
+                else if (now - connected_at > milliseconds(200))
+                {
+                    // Once the connection has settled, any further one is a reconnect.
+                    connections = broker.get_connection_count();
+                    published = true;
+                    published_at = now;
+
+                    for (size_t i = 0; published && i < message_count; ++i)
+                    {
+                        published = client->publish("window/test", "message", QoS::EXACTLY_ONCE, false);
+                    }
+
+                    check("All messages are queued", published);
+                }
+            }
+            else if (published && client->get_outgoing_queue_status().messages == 0)
+            {
+                check("All messages are acknowledged before the reply timeout",
+                      now - published_at < seconds(4));
+                check("The broker received each message once",
+                      broker.get_published_count() == static_cast<int>(message_count));
+                check("The client didn't reconnect", broker.get_connection_count() == connections);
+                finish(failed == 0 ? 0 : 1);
+            }
+
+            if (published && now - published_at > seconds(10))
+            {
+                printf("Timed out with %u messages outstanding\n",
+                       static_cast<uint32_t>(client->get_outgoing_queue_status().messages));
+                finish(1);
+            }
+        }
+
+        void MqttPublishWindowTest::check(const char* desc, bool passed)
+        {
+            printf("%s: %s\n", passed ? "PASS" : "FAIL", desc);
+
+            if (!passed)
+            {
+                ++failed;
+            }
+        }
+
+        void MqttPublishWindowTest::finish(int code)
+        {
+            fflush(stdout);
+            // The client task, the dispatcher and the broker threads run until the process ends.
+            _exit(code);
+        }
+    }
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    smooth::test::MqttPublishWindowTest test;
+    test.start();
+
+    return 0;
+}
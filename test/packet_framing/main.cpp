@@ -0,0 +1,293 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that LengthPrefixedPacket and DelimitedPacket frame their data correctly. Packets created for sending are
+// concatenated into a stream, which is then split into chunks of various sizes and assembled again, both the way a
+// socket with a receive buffer does it, via consume(), and the way one without does it, via get_write_pos() and
+// data_received(). The payloads must come back unchanged. Lengths and packets larger than allowed must be errors,
+// also when sending: a payload whose length the prefix can't hold must not be sent with a truncated length.
+//
+// Usage: packet_framing
+// The exit code is non-zero if any case fails.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <smooth/core/network/DelimitedPacket.h>
+#include <smooth/core/network/LengthPrefixedPacket.h>
+
+using namespace smooth::core::network;
+
+namespace smooth
+{
+    namespace test
+    {
+        class PacketFramingTest
+        {
+            public:
+                int run()
+                {
+                    prefixes_are_encoded();
+                    round_trip<LengthPrefix::U16BigEndian>("U16 prefix");
+                    round_trip<LengthPrefix::U32BigEndian>("U32 prefix");
+                    round_trip<LengthPrefix::VarInt>("Varint prefix");
+                    oversize_lengths_are_rejected();
+                    oversize_sends_are_rejected();
+                    delimited_round_trip();
+                    oversize_delimited_packets_are_rejected();
+
+                    printf("%d failed\n", failed);
+                    return failed == 0 ? 0 : 1;
+                }
+
+            private:
+                using Stream = std::vector<uint8_t>;
+                using Payloads = std::vector<std::string>;
+
+                void check(const std::string& desc, bool passed)
+                {
+                    printf("%s: %s\n", passed ? "PASS" : "FAIL", desc.c_str());
+
+                    if (!passed)
+                    {
+                        ++failed;
+                    }
+                }
+
+                template<typename Packet>
+                static Packet make(const std::string& payload)
+                {
+                    return Packet(reinterpret_cast<const uint8_t*>(payload.data()),
+                                  static_cast<uint32_t>(payload.size()));
+                }
+
+                template<typename Packet>
+                static Stream to_stream(const Payloads& payloads)
+                {
+                    Stream res;
+
+                    for (auto& payload : payloads)
+                    {
+                        auto packet = make<Packet>(payload);
+                        res.insert(res.end(), packet.get_data(), packet.get_data() + packet.get_send_length());
+                    }
+
+                    return res;
+                }
+
+                template<typename Packet>
+                static std::string payload_of(const Packet& packet)
+                {
+                    return std::string(reinterpret_cast<const char*>(packet.get_payload()),
+                                       packet.get_payload_length());
+                }
+
+                // Assembles packets the way a socket with a receive buffer does, handing over chunks of the stream.
+                // Returns false if a packet is in error.
+                template<typename Packet>
+                static bool consume(const Stream& stream, size_t chunk, Payloads& payloads)
+                {
+                    Packet packet;
+                    bool res = true;
+
+                    for (size_t pos = 0; res && pos < stream.size(); pos += chunk)
+                    {
+                        auto length = static_cast<int>(std::min(chunk, stream.size() - pos));
+                        int consumed = 0;
+
+                        while (res && consumed < length)
+                        {
+                            consumed += packet.consume(stream.data() + pos + consumed, length - consumed);
+                            res = !packet.is_error();
+
+                            if (res && packet.is_complete())
+                            {
+                                payloads.push_back(payload_of(packet));
+                                packet.prepare_for_reuse();
+                            }
+                        }
+                    }
+
+                    return res;
+                }
+
+                // Assembles packets the way a socket without a receive buffer does, receiving no more than the
+                // packet asks for. Returns false if a packet is in error.
+                template<typename Packet>
+                static bool receive(const Stream& stream, Payloads& payloads)
+                {
+                    Packet packet;
+                    bool res = true;
+                    size_t pos = 0;
+
+                    while (res && pos < stream.size())
+                    {
+                        auto amount = std::min(static_cast<size_t>(packet.get_wanted_amount()), stream.size() - pos);
+                        memcpy(packet.get_write_pos(), stream.data() + pos, amount);
+                        packet.data_received(static_cast<int>(amount));
+                        pos += amount;
+                        res = !packet.is_error();
+
+                        if (res && packet.is_complete())
+                        {
+                            payloads.push_back(payload_of(packet));
+                            packet.prepare_for_reuse();
+                        }
+                    }
+
+                    return res;
+                }
+
+                void prefixes_are_encoded()
+                {
+                    std::string payload(300, 'x');
+                    auto u16 = make<LengthPrefixedPacket<LengthPrefix::U16BigEndian, 1000>>(payload);
+                    auto u32 = make<LengthPrefixedPacket<LengthPrefix::U32BigEndian, 1000>>(payload);
+                    auto varint = make<LengthPrefixedPacket<LengthPrefix::VarInt, 1000>>(payload);
+
+                    check("A U16 prefix is big endian",
+                          u16.get_send_length() == 302
+                          && Stream(u16.get_data(), u16.get_data() + 2) == Stream{1, 0x2C});
+                    check("A U32 prefix is big endian",
+                          u32.get_send_length() == 304
+                          && Stream(u32.get_data(), u32.get_data() + 4) == Stream{0, 0, 1, 0x2C});
+                    check("A varint prefix has the least significant group first",
+                          varint.get_send_length() == 302
+                          && Stream(varint.get_data(), varint.get_data() + 2) == Stream{0xAC, 0x02});
+                }
+
+                template<LengthPrefix Prefix>
+                void round_trip(const std::string& name)
+                {
+                    using Packet = LengthPrefixedPacket<Prefix, 20000>;
+
+                    // Including the lengths where a varint grows by a byte.
+                    Payloads payloads;
+
+                    for (size_t length : {0, 1, 127, 128, 255, 256, 0, 16383, 16384, 3})
+                    {
+                        std::string payload;
+
+                        for (size_t i = 0; i < length; ++i)
+                        {
+                            payload.push_back(static_cast<char>(i * 7 + payloads.size()));
+                        }
+
+                        payloads.push_back(payload);
+                    }
+
+                    auto stream = to_stream<Packet>(payloads);
+                    bool same = true;
+
+                    for (size_t chunk : {1, 2, 3, 5, 64, 1000, 100000})
+                    {
+                        Payloads assembled;
+                        same = same && consume<Packet>(stream, chunk, assembled) && assembled == payloads;
+                    }
+
+                    check(name + ": packets are assembled from chunks of any size", same);
+
+                    Payloads received;
+                    check(name + ": packets are assembled a receive at a time",
+                          receive<Packet>(stream, received) && received == payloads);
+                }
+
+                void oversize_lengths_are_rejected()
+                {
+                    using U16 = LengthPrefixedPacket<LengthPrefix::U16BigEndian, 100>;
+                    using VarInt = LengthPrefixedPacket<LengthPrefix::VarInt, 100>;
+                    Payloads payloads;
+
+                    Stream largest{0, 100};
+                    largest.resize(102, 'x');
+                    check("A length of MaxPayloadSize is accepted",
+                          consume<U16>(largest, 7, payloads) && payloads.size() == 1 && payloads[0].size() == 100);
+
+                    check("A length above MaxPayloadSize is an error when consumed",
+                          !consume<U16>(Stream{0, 101, 'x'}, 1000, payloads));
+                    check("A length above MaxPayloadSize is an error when received",
+                          !receive<U16>(Stream{0, 101, 'x'}, payloads));
+                    check("A varint length above MaxPayloadSize is an error",
+                          !consume<VarInt>(Stream{0x80, 0x01, 'x'}, 1, payloads));
+                    check("A varint longer than five bytes is an error",
+                          !consume<VarInt>(Stream{0x80, 0x80, 0x80, 0x80, 0x80, 0x00}, 1, payloads)
+                          && !receive<VarInt>(Stream{0x80, 0x80, 0x80, 0x80, 0x80, 0x00}, payloads));
+                }
+
+                void oversize_sends_are_rejected()
+                {
+                    auto largest = make<LengthPrefixedPacket<LengthPrefix::U16BigEndian, 100>>(std::string(100, 'x'));
+                    check("A payload of MaxPayloadSize is sent",
+                          !largest.is_error() && largest.get_send_length() == 102);
+
+                    auto too_large = make<LengthPrefixedPacket<LengthPrefix::VarInt, 100>>(std::string(101, 'x'));
+                    check("A payload above MaxPayloadSize isn't sent",
+                          too_large.is_error() && too_large.get_send_length() == 0);
+
+                    // 70000 would go out as 70000 & 0xFFFF = 4464, followed by all 70000 bytes.
+                    auto truncated = make<LengthPrefixedPacket<LengthPrefix::U16BigEndian, 100000>>(
+                            std::string(70000, 'x'));
+                    check("A payload the U16 prefix can't hold isn't sent",
+                          truncated.is_error() && truncated.get_send_length() == 0);
+
+                    auto u32 = make<LengthPrefixedPacket<LengthPrefix::U32BigEndian, 100000>>(std::string(70000, 'x'));
+                    check("A U32 prefix holds the same payload", !u32.is_error() && u32.get_send_length() == 70004);
+                }
+
+                void delimited_round_trip()
+                {
+                    using Packet = DelimitedPacket<'\n', 100>;
+
+                    auto sent = make<Packet>("abc");
+                    check("The delimiter is added when sending",
+                          Stream(sent.get_data(), sent.get_data() + sent.get_send_length())
+                          == Stream{'a', 'b', 'c', '\n'});
+
+                    Payloads payloads{"first line", "", "x", std::string(99, 'y'), "last"};
+                    auto stream = to_stream<Packet>(payloads);
+                    bool same = true;
+
+                    for (size_t chunk : {1, 2, 3, 11, 1000})
+                    {
+                        Payloads assembled;
+                        same = same && consume<Packet>(stream, chunk, assembled) && assembled == payloads;
+                    }
+
+                    check("Delimited packets are assembled from chunks of any size", same);
+
+                    Payloads received;
+                    check("Delimited packets are assembled a receive at a time",
+                          receive<Packet>(stream, received) && received == payloads);
+                }
+
+                void oversize_delimited_packets_are_rejected()
+                {
+                    using Packet = DelimitedPacket<'\n', 8>;
+                    Payloads payloads;
+
+                    check("A packet of MaxSize, including the delimiter, is accepted",
+                          consume<Packet>(to_stream<Packet>({"1234567"}), 3, payloads)
+                          && payloads == Payloads{"1234567"});
+
+                    auto stream = to_stream<Packet>({"12345678"});
+                    check("A longer packet is an error when consumed", !consume<Packet>(stream, 1000, payloads));
+                    check("A longer packet is an error when consumed in chunks", !consume<Packet>(stream, 3, payloads));
+                    check("A longer packet is an error when received", !receive<Packet>(stream, payloads));
+                }
+
+                int failed = 0;
+        };
+    }
+}
+
+int main(int, char**)
+{
+    smooth::test::PacketFramingTest test;
+    auto res = test.run();
+    fflush(stdout);
+
+    return res;
+}
@@ -0,0 +1,229 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that receiving packets through Socket<Packet> and PacketReceiveBuffer doesn't allocate once warmed up.
+//
+// A server on loopback sends a stream of MQTT PUBLISH packets of varying sizes. The client takes each packet out of
+// the receive buffer into the same target packet, so the packets recycled by the buffer and the target keep the
+// capacity they have grown to. Heap allocations by the whole process, the dispatcher and the event queues included,
+// are counted after a warm-up.
+//
+// Usage: packet_receive_buffer_allocations [packets]
+// The exit code is non-zero if any allocation is made after the warm-up, or a packet is lost or malformed.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <smooth/core/Application.h>
+#include <smooth/core/network/IPv4.h>
+#include <smooth/core/network/PacketReceiveBuffer.h>
+#include <smooth/core/network/PacketSendBuffer.h>
+#include <smooth/core/network/Socket.h>
+#include <smooth/application/network/mqtt/packet/MQTTPacket.h>
+#include <common/AllocationCounter.h>
+#include <common/LoopbackServer.h>
+
+using namespace std::chrono;
+using namespace smooth::core;
+using namespace smooth::core::network;
+using smooth::application::network::mqtt::packet::MQTTPacket;
+
+namespace smooth
+{
+    namespace test
+    {
+        // Sends the same prepared stream of packets on each connection, so that sending doesn't allocate.
+        class PublishSource
+                : public LoopbackServer
+        {
+            public:
+                explicit PublishSource(int packet_count)
+                {
+                    // Packets of the largest size come first, see ReceiveAllocationTest.
+                    for (int i = 0; i < packet_count; ++i)
+                    {
+                        add_publish(static_cast<size_t>(i < 20 ? 999 : i * 37 % 1000));
+                    }
+                }
+
+                ~PublishSource() override
+                {
+                    stop();
+                }
+
+                const std::vector<size_t>& get_lengths() const
+                {
+                    return lengths;
+                }
+
+            protected:
+                void serve(Connection& connection) override
+                {
+                    if (connection.write(stream.data(), static_cast<int>(stream.size())))
+                    {
+                        // Keep the connection open until the client is done.
+                        uint8_t b;
+                        connection.read(&b, 1);
+                    }
+                }
+
+            private:
+                void add_publish(size_t payload_length)
+                {
+                    const char topic[] = "sensors/temperature";
+                    auto topic_length = sizeof(topic) - 1;
+                    auto remaining = 2 + topic_length + payload_length;
+                    auto start = stream.size();
+
+                    // QoS 0, so there is no packet identifier.
+                    stream.push_back(0x30);
+
+                    do
+                    {
+                        auto b = static_cast<uint8_t>(remaining & 0x7F);
+                        remaining >>= 7;
+                        stream.push_back(remaining > 0 ? static_cast<uint8_t>(b | 0x80) : b);
+                    } while (remaining > 0);
+
+                    stream.push_back(static_cast<uint8_t>(topic_length >> 8));
+                    stream.push_back(static_cast<uint8_t>(topic_length));
+                    stream.insert(stream.end(), topic, topic + topic_length);
+
+                    for (size_t i = 0; i < payload_length; ++i)
+                    {
+                        stream.push_back(static_cast<uint8_t>(i));
+                    }
+
+                    lengths.push_back(stream.size() - start);
+                }
+
+                std::vector<uint8_t> stream{};
+                std::vector<size_t> lengths{};
+        };
+
+        class ReceiveAllocationTest
+                : public core::POSIXApplication,
+                  public ipc::IEventListener<TransmitBufferEmptyEvent>,
+                  public ipc::IEventListener<DataAvailableEvent<MQTTPacket>>,
+                  public ipc::IEventListener<ConnectionStatusEvent>
+        {
+            public:
+                explicit ReceiveAllocationTest(int packet_count)
+                        : POSIXApplication(5, milliseconds(10)),
+                          tx_empty("tx_empty", 5, *this, *this),
+                          data_available("data_available", 10, *this, *this),
+                          connection_status("connection_status", 5, *this, *this),
+                          packet_count(packet_count),
+                          warm_up(std::min(100, packet_count / 2)),
+                          source(packet_count)
+                {
+                }
+
+                void init() override
+                {
+                    POSIXApplication::init();
+
+                    if (!source.start())
+                    {
+                        printf("Could not start the server\n");
+                        finish(1);
+                    }
+
+                    socket = Socket<MQTTPacket>::create(tx, rx, tx_empty, data_available, connection_status,
+                                                        milliseconds(1500), 512);
+                    socket->start(std::make_shared<IPv4>("127.0.0.1", source.get_port()));
+                    started = steady_clock::now();
+                }
+
+                void tick() override
+                {
+                    if (steady_clock::now() - started > seconds(10))
+                    {
+                        printf("Timed out after %d of %d packets\n", received, packet_count);
+                        finish(1);
+                    }
+                }
+
+                void event(const TransmitBufferEmptyEvent&) override
+                {
+                }
+
+                void event(const ConnectionStatusEvent& event) override
+                {
+                    // The stream restarts on a reconnect, e.g. when the dispatcher restarts sockets on start-up.
+                    if (event.is_connected())
+                    {
+                        received = 0;
+                    }
+                }
+
+                void event(const DataAvailableEvent<MQTTPacket>& event) override
+                {
+                    if (received == 0)
+                    {
+                        // Let the receive buffer fill up with the largest packets, so that every packet that can be
+                        // in circulation is created, and grows to the largest size, during the warm-up.
+                        std::this_thread::sleep_for(milliseconds(100));
+                    }
+
+                    if (event.get(target))
+                    {
+                        auto expected = source.get_lengths()[static_cast<size_t>(received)];
+
+                        if (!target.validate_packet() || static_cast<size_t>(target.get_send_length()) != expected)
+                        {
+                            printf("Packet %d is malformed\n", received);
+                            finish(1);
+                        }
+
+                        if (++received == warm_up)
+                        {
+                            allocations_at_warm_up = AllocationCounter::get_count();
+                        }
+                        else if (received == packet_count)
+                        {
+                            auto allocations = AllocationCounter::get_count() - allocations_at_warm_up;
+                            printf("%llu allocations while receiving packets %d to %d\n",
+                                   static_cast<unsigned long long>(allocations), warm_up + 1, packet_count);
+                            finish(allocations == 0 ? 0 : 1);
+                        }
+                    }
+                }
+
+            private:
+                static void finish(int code)
+                {
+                    fflush(stdout);
+                    // The dispatcher and server threads run until the process ends.
+                    _exit(code);
+                }
+
+                PacketSendBuffer<MQTTPacket, 2> tx{};
+                PacketReceiveBuffer<MQTTPacket, 4> rx{};
+                ipc::TaskEventQueue<TransmitBufferEmptyEvent> tx_empty;
+                ipc::TaskEventQueue<DataAvailableEvent<MQTTPacket>> data_available;
+                ipc::TaskEventQueue<ConnectionStatusEvent> connection_status;
+                int packet_count;
+                int warm_up;
+                PublishSource source;
+                std::shared_ptr<ISocket> socket{};
+                MQTTPacket target{};
+                int received = 0;
+                uint64_t allocations_at_warm_up = 0;
+                steady_clock::time_point started{};
+        };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    smooth::test::ReceiveAllocationTest test(argc > 1 ? atoi(argv[1]) : 2000);
+    test.start();
+
+    return 0;
+}
@@ -0,0 +1,274 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that PublishLog restores exactly the outstanding messages after a restart, also when segments have been
+// compacted, the last batch was torn by a crash, a write failed and was retried, or a packet identifier was reused.
+//
+// Each case uses a new directory under /tmp and restarts by loading it into a new PublishLog.
+//
+// Usage: publish_log
+// The exit code is non-zero if any case fails.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <smooth/application/network/mqtt/PublishLog.h>
+#include <smooth/application/network/mqtt/packet/PacketIdentifierFactory.h>
+#include <smooth/core/filesystem/File.h>
+
+using namespace smooth::application::network::mqtt;
+using smooth::core::filesystem::File;
+
+namespace smooth
+{
+    namespace test
+    {
+        class PublishLogTest
+        {
+            public:
+                int run()
+                {
+                    check("an acknowledgement in a deleted segment doesn't bring a message back",
+                          acknowledged_message_stays_acknowledged());
+                    check("a torn last batch is ignored", torn_batch_is_ignored());
+                    check("a failed write is retried", failed_write_is_retried());
+                    check("a reused packet identifier doesn't replace an outstanding message",
+                          reused_identifier_keeps_both_messages());
+
+                    for (auto& directory : directories)
+                    {
+                        for (auto& name : get_segments(directory))
+                        {
+                            unlink((directory + "/" + name).c_str());
+                        }
+
+                        rmdir(directory.c_str());
+                    }
+
+                    return exit_code;
+                }
+
+            private:
+                static const size_t segment_size = 100;
+
+                // Segment 0 holds A and B; the acknowledgement of A goes to segment 1 together with C; that of C
+                // to segment 2. Segment 1 then only holds acknowledged messages, but deleting it would restore A.
+                bool acknowledged_message_stays_acknowledged()
+                {
+                    auto directory = create_directory();
+                    std::vector<uint16_t> expected;
+
+                    {
+                        PublishLog log(directory, segment_size);
+                        load(log);
+
+                        auto a = store(log);
+                        expected.push_back(store(log));
+                        log.flush();
+
+                        log.remove(a);
+                        auto c = store(log);
+                        log.flush();
+
+                        log.remove(c);
+                        log.flush();
+                    }
+
+                    return restore(directory) == expected;
+                }
+
+                bool torn_batch_is_ignored()
+                {
+                    auto directory = create_directory();
+                    std::vector<uint16_t> expected;
+
+                    {
+                        PublishLog log(directory, segment_size);
+                        load(log);
+                        expected.push_back(store(log));
+                        log.flush();
+                    }
+
+                    // A crash in the middle of the next batch leaves part of a record behind.
+                    std::vector<uint8_t> partial{1, 0, 7, 0, 0};
+                    File(directory + "/" + get_segments(directory).back()).append(partial.data(), partial.size());
+
+                    bool res = restore(directory) == expected;
+
+                    {
+                        PublishLog log(directory, segment_size);
+                        load(log);
+                        expected.push_back(store(log));
+                        log.flush();
+                    }
+
+                    return res && restore(directory) == expected;
+                }
+
+                bool failed_write_is_retried()
+                {
+                    auto directory = create_directory();
+                    std::vector<uint16_t> expected;
+                    bool res;
+
+                    {
+                        PublishLog log(directory, segment_size);
+                        load(log);
+                        expected.push_back(store(log));
+
+                        // Without the directory, the segment can't be created.
+                        rmdir(directory.c_str());
+                        res = !log.flush();
+                        mkdir(directory.c_str(), 0755);
+
+                        expected.push_back(store(log));
+                        res = res && log.flush();
+                    }
+
+                    return res && restore(directory) == expected;
+                }
+
+                // Once the identifiers wrap around, a new message may get the identifier of one still outstanding
+                // in an older segment. Both are restored; acknowledging the identifier removes the newer one.
+                bool reused_identifier_keeps_both_messages()
+                {
+                    auto directory = create_directory();
+                    std::vector<uint16_t> expected;
+                    uint16_t a;
+                    bool res;
+
+                    {
+                        PublishLog log(directory, segment_size);
+                        load(log);
+
+                        a = store(log);
+                        expected.push_back(a);
+                        expected.push_back(store(log));
+                        log.flush();
+
+                        packet::PacketIdentifierFactory::advance_past(static_cast<uint16_t>(a - 1));
+                        expected.push_back(store(log));
+                        log.flush();
+                        res = expected.back() == a;
+                    }
+
+                    res = res && restore(directory) == expected;
+
+                    {
+                        PublishLog log(directory, segment_size);
+                        load(log);
+                        log.remove(a);
+                        log.flush();
+                    }
+
+                    expected.pop_back();
+
+                    return res && restore(directory) == expected;
+                }
+
+                std::string create_directory()
+                {
+                    char name[] = "/tmp/publish_log_XXXXXX";
+                    auto res = mkdtemp(name);
+
+                    if (res == nullptr)
+                    {
+                        printf("Could not create a directory under /tmp\n");
+                        finish(1);
+                    }
+
+                    directories.emplace_back(res);
+
+                    return res;
+                }
+
+                static void load(PublishLog& log)
+                {
+                    std::vector<PublishLog::Message> messages;
+                    log.load(messages);
+                }
+
+                // Loads the log as after a restart.
+                static std::vector<uint16_t> restore(const std::string& directory)
+                {
+                    PublishLog log(directory, segment_size);
+                    std::vector<PublishLog::Message> messages;
+                    log.load(messages);
+
+                    std::vector<uint16_t> ids;
+
+                    for (auto& message : messages)
+                    {
+                        ids.push_back(message.packet.get_packet_identifier());
+                    }
+
+                    return ids;
+                }
+
+                static uint16_t store(PublishLog& log)
+                {
+                    // Large enough for a segment to hold no more than two messages.
+                    std::vector<uint8_t> payload(80, 0x55);
+                    packet::Publish publish("t/a", payload.data(), static_cast<int>(payload.size()),
+                                            QoS::AT_LEAST_ONCE, false);
+                    log.store(publish);
+
+                    return publish.get_packet_identifier();
+                }
+
+                // The names of the segment files, oldest first.
+                static std::vector<std::string> get_segments(const std::string& directory)
+                {
+                    std::vector<std::string> names;
+                    auto dir = opendir(directory.c_str());
+
+                    for (auto item = dir == nullptr ? nullptr : readdir(dir); item != nullptr; item = readdir(dir))
+                    {
+                        if (item->d_name[0] != '.')
+                        {
+                            names.emplace_back(item->d_name);
+                        }
+                    }
+
+                    if (dir != nullptr)
+                    {
+                        closedir(dir);
+                    }
+
+                    std::sort(names.begin(), names.end());
+
+                    return names;
+                }
+
+                void check(const char* description, bool passed)
+                {
+                    printf("%s %s\n", passed ? "PASS" : "FAIL", description);
+                    exit_code = passed ? exit_code : 1;
+                }
+
+                static void finish(int code)
+                {
+                    fflush(stdout);
+                    _exit(code);
+                }
+
+                std::vector<std::string> directories{};
+                int exit_code = 0;
+        };
+    }
+}
+
+int main(int, char**)
+{
+    smooth::test::PublishLogTest test;
+    auto res = test.run();
+    fflush(stdout);
+
+    return res;
+}
@@ -0,0 +1,243 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that SecureSocket verifies the server certificate, including the name it is issued for, and that it
+// resumes sessions.
+//
+// A TLS echo server on loopback presents a self-signed certificate for "localhost", which the clients trust. Each
+// case connects a new SecureSocket with a different server name: the correct name must connect and echo a packet,
+// the second connection must resume the session of the first, while a wrong name, an IP address the certificate
+// isn't issued for and no name at all must not connect.
+//
+// Usage: secure_socket
+// The exit code is non-zero if any case fails.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <smooth/core/Application.h>
+#include <smooth/core/network/IPv4.h>
+#include <smooth/core/network/LengthPrefixedPacket.h>
+#include <smooth/core/network/PacketReceiveBuffer.h>
+#include <smooth/core/network/PacketSendBuffer.h>
+#include <smooth/core/network/SecureSocket.h>
+#include <common/EchoServer.h>
+#include <common/SelfSignedCertificate.h>
+
+using namespace std::chrono;
+using namespace smooth::core;
+using namespace smooth::core::network;
+
+namespace smooth
+{
+    namespace test
+    {
+        using EchoPacket = LengthPrefixedPacket<LengthPrefix::U16BigEndian, 1024>;
+
+        const char message[] = "Hello over TLS";
+
+        // A connection that sends one packet once connected and remembers whether it was echoed back.
+        class TlsClient
+                : public ipc::IEventListener<TransmitBufferEmptyEvent>,
+                  public ipc::IEventListener<DataAvailableEvent<EchoPacket>>,
+                  public ipc::IEventListener<ConnectionStatusEvent>
+        {
+            public:
+                explicit TlsClient(Task& task)
+                        : tx_empty("tx_empty", 5, task, *this),
+                          data_available("data_available", 5, task, *this),
+                          connection_status("connection_status", 5, task, *this)
+                {
+                }
+
+                void start(std::shared_ptr<TlsContext> tls_context, const std::string& server_name, uint16_t port)
+                {
+                    socket = SecureSocket<EchoPacket>::create(tx, rx, tx_empty, data_available, connection_status,
+                                                              tls_context, server_name);
+                    socket->start(std::make_shared<IPv4>("127.0.0.1", port));
+                }
+
+                void stop()
+                {
+                    socket->stop();
+                }
+
+                bool has_connected() const
+                {
+                    return connected;
+                }
+
+                bool is_echoed() const
+                {
+                    return echoed;
+                }
+
+                void event(const TransmitBufferEmptyEvent&) override
+                {
+                }
+
+                void event(const DataAvailableEvent<EchoPacket>& event) override
+                {
+                    EchoPacket p;
+
+                    if (event.get(p))
+                    {
+                        echoed = p.get_payload_length() == sizeof(message) - 1
+                                 && memcmp(p.get_payload(), message, sizeof(message) - 1) == 0;
+                    }
+                }
+
+                void event(const ConnectionStatusEvent& event) override
+                {
+                    if (event.is_connected())
+                    {
+                        connected = true;
+                        // Sent again after a reconnect, as the packet may have been lost with the connection.
+                        tx.put(EchoPacket(reinterpret_cast<const uint8_t*>(message), sizeof(message) - 1));
+                    }
+                }
+
+            private:
+                PacketSendBuffer<EchoPacket, 2> tx{};
+                PacketReceiveBuffer<EchoPacket, 2> rx{};
+                ipc::TaskEventQueue<TransmitBufferEmptyEvent> tx_empty;
+                ipc::TaskEventQueue<DataAvailableEvent<EchoPacket>> data_available;
+                ipc::TaskEventQueue<ConnectionStatusEvent> connection_status;
+                std::shared_ptr<ISocket> socket{};
+                bool connected = false;
+                bool echoed = false;
+        };
+
+        class SecureSocketTest
+                : public core::POSIXApplication
+        {
+            public:
+                SecureSocketTest()
+                        : POSIXApplication(5, milliseconds(10)),
+                          server(certificate.get_server_context())
+                {
+                }
+
+                void init() override
+                {
+                    POSIXApplication::init();
+
+                    tls_context = std::make_shared<TlsContext>(true);
+
+                    if (!certificate.is_valid()
+                        || !tls_context->add_ca_certificate(certificate.get_pem())
+                        || !server.start())
+                    {
+                        printf("Could not start the TLS server\n");
+                        finish(1);
+                    }
+
+                    start_case();
+                }
+
+                void tick() override
+                {
+                    auto elapsed = steady_clock::now() - case_start;
+                    auto& c = cases[current];
+                    auto& client = *clients.back();
+
+                    if (!client_stopped)
+                    {
+                        bool done = false;
+                        bool passed = false;
+
+                        if (c.expect_connection)
+                        {
+                            done = client.is_echoed() || elapsed > seconds(5);
+                            passed = client.is_echoed()
+                                     && (!c.expect_resumption || server.get_resumed_session_count() > resumed_at_start);
+                        }
+                        else
+                        {
+                            done = client.has_connected() || elapsed > milliseconds(1500);
+                            passed = !client.has_connected();
+                        }
+
+                        if (done)
+                        {
+                            printf("%s %s\n", passed ? "PASS" : "FAIL", c.description);
+                            exit_code = passed ? exit_code : 1;
+                            client.stop();
+                            client_stopped = true;
+                            case_start = steady_clock::now();
+                        }
+                    }
+                    else if (elapsed > milliseconds(100))
+                    {
+                        // The pause lets the dispatcher close the connection, saving its session, before the
+                        // next case connects.
+                        if (++current < cases.size())
+                        {
+                            start_case();
+                        }
+                        else
+                        {
+                            finish(exit_code);
+                        }
+                    }
+                }
+
+            private:
+                struct Case
+                {
+                    const char* description;
+                    const char* server_name;
+                    bool expect_connection;
+                    bool expect_resumption;
+                };
+
+                void start_case()
+                {
+                    clients.emplace_back(new TlsClient(*this));
+                    clients.back()->start(tls_context, cases[current].server_name, server.get_port());
+                    client_stopped = false;
+                    resumed_at_start = server.get_resumed_session_count();
+                    case_start = steady_clock::now();
+                }
+
+                static void finish(int code)
+                {
+                    fflush(stdout);
+                    // The dispatcher and server threads run until the process ends.
+                    _exit(code);
+                }
+
+                const std::vector<Case> cases{
+                        {"certificate issued for the server name", "localhost", true, false},
+                        {"second connection resumes the session", "localhost", true, true},
+                        {"certificate not issued for the server name", "example.com", false, false},
+                        {"certificate not issued for the IP address", "127.0.0.1", false, false},
+                        {"no server name to verify the certificate against", "", false, false}
+                };
+
+                SelfSignedCertificate certificate{};
+                EchoServer server;
+                std::shared_ptr<TlsContext> tls_context{};
+                // Clients are kept until the process ends, as stopped sockets may still refer to their buffers.
+                std::vector<std::unique_ptr<TlsClient>> clients{};
+                size_t current = 0;
+                bool client_stopped = false;
+                int resumed_at_start = 0;
+                steady_clock::time_point case_start{};
+                int exit_code = 0;
+        };
+    }
+}
+
+int main(int, char**)
+{
+    smooth::test::SecureSocketTest test;
+    test.start();
+
+    return 0;
+}
@@ -0,0 +1,386 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Loopback throughput and latency benchmark for Socket<Packet>.
+//
+// Starts the SocketDispatcher, connects a number of Socket<Packet> clients to an echo server on loopback and keeps
+// one message outstanding per client, measuring each round trip. Run for each packet size in turn, it reports
+// messages per second, payload MB/s, round-trip percentiles and process CPU time per message (the echo server
+// runs in the same process and is included).
+//
+// Usage: socket_benchmark [clients] [milliseconds per packet size] [packet size...]
+// The exit code is non-zero if a client fails to connect or an echoed packet doesn't match what was sent.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <vector>
+#include <unistd.h>
+#include <smooth/core/Application.h>
+#include <smooth/core/network/IPv4.h>
+#include <smooth/core/network/LengthPrefixedPacket.h>
+#include <smooth/core/network/PacketReceiveBuffer.h>
+#include <smooth/core/network/PacketSendBuffer.h>
+#include <smooth/core/network/Socket.h>
+#include <common/EchoServer.h>
+#include <common/LatencyStatistics.h>
+
+using namespace std::chrono;
+using namespace smooth::core;
+using namespace smooth::core::network;
+
+namespace smooth
+{
+    namespace test
+    {
+        using EchoPacket = LengthPrefixedPacket<LengthPrefix::U32BigEndian, 1024 * 1024>;
+
+        class SocketBenchmark;
+
+        // A connection to the echo server with one message outstanding at a time.
+        class EchoClient
+                : public ipc::IEventListener<TransmitBufferEmptyEvent>,
+                  public ipc::IEventListener<DataAvailableEvent<EchoPacket>>,
+                  public ipc::IEventListener<ConnectionStatusEvent>
+        {
+            public:
+                EchoClient(Task& task, SocketBenchmark& benchmark, const std::vector<uint8_t>& payload)
+                        : benchmark(benchmark),
+                          payload(payload),
+                          tx_empty("tx_empty", 5, task, *this),
+                          data_available("data_available", 5, task, *this),
+                          connection_status("connection_status", 5, task, *this)
+                {
+                }
+
+                void start(uint16_t port);
+
+                void stop()
+                {
+                    socket->stop();
+                }
+
+                bool is_connected() const
+                {
+                    return connected;
+                }
+
+                bool is_idle() const
+                {
+                    return !outstanding;
+                }
+
+                void send();
+
+                void event(const TransmitBufferEmptyEvent&) override
+                {
+                }
+
+                void event(const DataAvailableEvent<EchoPacket>& event) override;
+
+                void event(const ConnectionStatusEvent& event) override;
+
+            private:
+                SocketBenchmark& benchmark;
+                const std::vector<uint8_t>& payload;
+                PacketSendBuffer<EchoPacket, 2> tx{};
+                PacketReceiveBuffer<EchoPacket, 4> rx{};
+                ipc::TaskEventQueue<TransmitBufferEmptyEvent> tx_empty;
+                ipc::TaskEventQueue<DataAvailableEvent<EchoPacket>> data_available;
+                ipc::TaskEventQueue<ConnectionStatusEvent> connection_status;
+                std::shared_ptr<ISocket> socket{};
+                EchoPacket received{};
+                steady_clock::time_point sent_at{};
+                bool connected = false;
+                bool outstanding = false;
+        };
+
+        class SocketBenchmark
+                : public core::POSIXApplication
+        {
+            public:
+                SocketBenchmark(int client_count, milliseconds duration, std::vector<uint32_t> sizes)
+                        : POSIXApplication(5, milliseconds(10)),
+                          client_count(client_count),
+                          duration(duration),
+                          sizes(std::move(sizes)),
+                          latency(1000000)
+                {
+                }
+
+                void init() override;
+
+                void tick() override;
+
+                bool is_sending() const
+                {
+                    return phase == Phase::WarmUp || phase == Phase::Measure;
+                }
+
+                void completed(nanoseconds round_trip, bool matches);
+
+            private:
+                enum class Phase
+                {
+                    Connect,
+                    WarmUp,
+                    Measure,
+                    Drain
+                };
+
+                void start_size();
+                void report();
+                void finish(int exit_code);
+                static nanoseconds get_cpu_time();
+
+                int client_count;
+                milliseconds duration;
+                std::vector<uint32_t> sizes;
+                size_t current = 0;
+                EchoServer server{};
+                // Clients are kept until the process ends, as stopped sockets may still refer to their buffers.
+                std::vector<std::unique_ptr<EchoClient>> clients{};
+                std::vector<std::unique_ptr<std::vector<uint8_t>>> payloads{};
+                Phase phase = Phase::Connect;
+                steady_clock::time_point phase_start{};
+                nanoseconds cpu_start{};
+                uint64_t messages = 0;
+                bool mismatch = false;
+                int exit_code = 0;
+                LatencyStatistics latency;
+        };
+
+        void EchoClient::start(uint16_t port)
+        {
+            socket = Socket<EchoPacket>::create(tx, rx, tx_empty, data_available, connection_status,
+                                                milliseconds(1500), 16 * 1024);
+            socket->start(std::make_shared<IPv4>("127.0.0.1", port));
+        }
+
+        void EchoClient::send()
+        {
+            sent_at = steady_clock::now();
+            outstanding = true;
+            tx.put(EchoPacket(payload.data(), static_cast<uint32_t>(payload.size())));
+        }
+
+        void EchoClient::event(const DataAvailableEvent<EchoPacket>& event)
+        {
+            if (event.get(received))
+            {
+                auto round_trip = steady_clock::now() - sent_at;
+                outstanding = false;
+
+                bool matches = received.get_payload_length() == payload.size()
+                               && memcmp(received.get_payload(), payload.data(), payload.size()) == 0;
+
+                benchmark.completed(round_trip, matches);
+
+                if (benchmark.is_sending())
+                {
+                    send();
+                }
+            }
+        }
+
+        void EchoClient::event(const ConnectionStatusEvent& event)
+        {
+            connected = event.is_connected();
+            // A message sent before a reconnect is lost with the connection.
+            outstanding = false;
+
+            if (connected && benchmark.is_sending())
+            {
+                send();
+            }
+        }
+
+        void SocketBenchmark::init()
+        {
+            POSIXApplication::init();
+
+            if (!server.start())
+            {
+                printf("Could not start the echo server\n");
+                finish(1);
+            }
+
+            printf("Socket<Packet> loopback echo: %d clients, one message outstanding each, %lld ms per size\n",
+                   client_count, static_cast<long long>(duration.count()));
+            printf("%8s %10s %9s %9s %9s %9s %12s\n", "size", "msgs/s", "MB/s", "p50 us", "p99 us", "p999 us",
+                   "CPU us/msg");
+
+            start_size();
+        }
+
+        void SocketBenchmark::start_size()
+        {
+            payloads.emplace_back(new std::vector<uint8_t>(sizes[current]));
+            auto& payload = *payloads.back();
+
+            for (size_t i = 0; i < payload.size(); ++i)
+            {
+                payload[i] = static_cast<uint8_t>(i * 31 + 7);
+            }
+
+            for (int i = 0; i < client_count; ++i)
+            {
+                clients.emplace_back(new EchoClient(*this, *this, payload));
+                clients.back()->start(server.get_port());
+            }
+
+            phase = Phase::Connect;
+            phase_start = steady_clock::now();
+        }
+
+        void SocketBenchmark::tick()
+        {
+            auto now = steady_clock::now();
+            auto elapsed = now - phase_start;
+            auto first = clients.end() - client_count;
+
+            if (phase == Phase::Connect)
+            {
+                bool all_connected = std::all_of(first, clients.end(), [](const std::unique_ptr<EchoClient>& c)
+                {
+                    return c->is_connected();
+                });
+
+                if (all_connected)
+                {
+                    phase = Phase::WarmUp;
+                    phase_start = now;
+
+                    for (auto c = first; c != clients.end(); ++c)
+                    {
+                        (*c)->send();
+                    }
+                }
+                else if (elapsed > seconds(5))
+                {
+                    printf("%8u clients could not connect\n", sizes[current]);
+                    finish(1);
+                }
+            }
+            else if (phase == Phase::WarmUp && elapsed > milliseconds(200))
+            {
+                phase = Phase::Measure;
+                phase_start = now;
+                messages = 0;
+                latency.clear();
+                cpu_start = get_cpu_time();
+            }
+            else if (phase == Phase::Measure && elapsed >= duration)
+            {
+                report();
+                phase = Phase::Drain;
+                phase_start = now;
+            }
+            else if (phase == Phase::Drain)
+            {
+                bool all_idle = std::all_of(first, clients.end(), [](const std::unique_ptr<EchoClient>& c)
+                {
+                    return c->is_idle();
+                });
+
+                if (all_idle || elapsed > seconds(1))
+                {
+                    for (auto c = first; c != clients.end(); ++c)
+                    {
+                        (*c)->stop();
+                    }
+
+                    if (mismatch)
+                    {
+                        printf("Echoed packets did not match what was sent\n");
+                        exit_code = 1;
+                    }
+
+                    if (++current < sizes.size())
+                    {
+                        start_size();
+                    }
+                    else
+                    {
+                        finish(exit_code);
+                    }
+                }
+            }
+        }
+
+        void SocketBenchmark::completed(nanoseconds round_trip, bool matches)
+        {
+            mismatch = mismatch || !matches;
+
+            if (phase == Phase::Measure)
+            {
+                ++messages;
+                latency.add(round_trip);
+            }
+        }
+
+        void SocketBenchmark::report()
+        {
+            auto seconds_run = duration_cast<std::chrono::duration<double>>(steady_clock::now() - phase_start).count();
+            auto cpu = get_cpu_time() - cpu_start;
+            auto rate = static_cast<double>(messages) / seconds_run;
+            auto size = sizes[current];
+
+            printf("%8u %10.0f %9.2f %9lld %9lld %9lld %12.2f\n",
+                   size,
+                   rate,
+                   rate * size / 1e6,
+                   static_cast<long long>(latency.get_percentile(50).count()),
+                   static_cast<long long>(latency.get_percentile(99).count()),
+                   static_cast<long long>(latency.get_percentile(99.9).count()),
+                   messages > 0 ? static_cast<double>(cpu.count()) / 1000.0 / static_cast<double>(messages) : 0.0);
+
+            if (messages == 0)
+            {
+                printf("%8u no messages were echoed\n", size);
+                exit_code = 1;
+            }
+        }
+
+        void SocketBenchmark::finish(int code)
+        {
+            fflush(stdout);
+            // The dispatcher and server threads run until the process ends.
+            _exit(code);
+        }
+
+        nanoseconds SocketBenchmark::get_cpu_time()
+        {
+            timespec t{};
+            clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+            return seconds(t.tv_sec) + nanoseconds(t.tv_nsec);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int clients = argc > 1 ? atoi(argv[1]) : 4;
+    milliseconds duration(argc > 2 ? atoi(argv[2]) : 2000);
+    std::vector<uint32_t> sizes;
+
+    for (int i = 3; i < argc; ++i)
+    {
+        sizes.push_back(static_cast<uint32_t>(atoi(argv[i])));
+    }
+
+    if (sizes.empty())
+    {
+        sizes = {16, 256, 1024, 8192};
+    }
+
+    smooth::test::SocketBenchmark benchmark(clients, duration, sizes);
+    benchmark.start();
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that SocketOptions::apply() sets the requested options on a socket and reports what the system actually
+// uses, by reading each option back from the socket independently. Options left at their defaults must be left
+// untouched, and options the system refuses must be reported as not in effect.
+//
+// Usage: socket_options
+// The exit code is non-zero if any case fails.
+
+#include <cstdio>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <smooth/core/network/SocketOptions.h>
+
+using smooth::core::network::SocketOptions;
+
+namespace smooth
+{
+    namespace test
+    {
+        class SocketOptionsTest
+        {
+            public:
+                int run()
+                {
+                    defaults_are_left_alone();
+                    options_are_applied();
+                    buffer_sizes_are_read_back();
+                    type_of_service_follows_family();
+                    refused_options_are_not_in_effect();
+                    cork_and_quick_ack();
+
+                    printf("%d failed\n", failed);
+                    return failed == 0 ? 0 : 1;
+                }
+
+            private:
+                void check(const char* desc, bool passed)
+                {
+                    printf("%s: %s\n", passed ? "PASS" : "FAIL", desc);
+
+                    if (!passed)
+                    {
+                        ++failed;
+                    }
+                }
+
+                static int get(int socket_id, int level, int option)
+                {
+                    int value = -1;
+                    socklen_t len = sizeof(value);
+
+                    if (getsockopt(socket_id, level, option, &value, &len) != 0)
+                    {
+                        value = -1;
+                    }
+
+                    return value;
+                }
+
+                void defaults_are_left_alone()
+                {
+                    auto s = socket(AF_INET, SOCK_STREAM, 0);
+                    auto send_buffer = get(s, SOL_SOCKET, SO_SNDBUF);
+                    auto tos = get(s, IPPROTO_IP, IP_TOS);
+
+                    SocketOptions options;
+                    options.no_delay = false;
+                    auto applied = options.apply(s, PF_INET);
+
+                    check("Options left at their defaults are reported as such",
+                          !applied.no_delay && applied.socket_send_buffer == 0 && applied.socket_receive_buffer == 0
+                          && !applied.keep_alive && applied.type_of_service == -1 && applied.busy_poll == 0
+                          && applied.zero_copy_threshold == 0);
+                    check("Options left at their defaults aren't changed",
+                          get(s, IPPROTO_TCP, TCP_NODELAY) == 0 && get(s, SOL_SOCKET, SO_KEEPALIVE) == 0
+                          && get(s, SOL_SOCKET, SO_SNDBUF) == send_buffer && get(s, IPPROTO_IP, IP_TOS) == tos);
+
+                    close(s);
+                }
+
+                void options_are_applied()
+                {
+                    auto s = socket(AF_INET, SOCK_STREAM, 0);
+
+                    SocketOptions options;
+                    options.keep_alive = true;
+                    options.keep_alive_idle = 30;
+                    options.keep_alive_interval = 5;
+                    options.keep_alive_count = 3;
+                    auto applied = options.apply(s, PF_INET);
+
+                    check("TCP_NODELAY is set by default",
+                          applied.no_delay && get(s, IPPROTO_TCP, TCP_NODELAY) != 0);
+                    check("Keep-alive is set", applied.keep_alive && get(s, SOL_SOCKET, SO_KEEPALIVE) != 0);
+#if defined(TCP_KEEPIDLE) && defined(TCP_KEEPINTVL) && defined(TCP_KEEPCNT)
+                    check("Keep-alive timing is set and read back",
+                          applied.keep_alive_idle == 30 && get(s, IPPROTO_TCP, TCP_KEEPIDLE) == 30
+                          && applied.keep_alive_interval == 5 && get(s, IPPROTO_TCP, TCP_KEEPINTVL) == 5
+                          && applied.keep_alive_count == 3 && get(s, IPPROTO_TCP, TCP_KEEPCNT) == 3);
+#endif
+
+                    close(s);
+                }
+
+                void buffer_sizes_are_read_back()
+                {
+                    auto s = socket(AF_INET, SOCK_STREAM, 0);
+
+                    SocketOptions options;
+                    options.socket_send_buffer = 32768;
+                    options.socket_receive_buffer = 65536;
+                    auto applied = options.apply(s, PF_INET);
+
+                    printf("Buffers of %d and %d bytes requested, %d and %d in effect\n",
+                           options.socket_send_buffer, options.socket_receive_buffer,
+                           applied.socket_send_buffer, applied.socket_receive_buffer);
+
+                    // The system may round the sizes, Linux doubles them; what matters is that the report matches.
+                    check("The send buffer size in effect is reported",
+                          applied.socket_send_buffer > 0
+                          && applied.socket_send_buffer == get(s, SOL_SOCKET, SO_SNDBUF));
+                    check("The receive buffer size in effect is reported",
+                          applied.socket_receive_buffer > 0
+                          && applied.socket_receive_buffer == get(s, SOL_SOCKET, SO_RCVBUF));
+
+                    close(s);
+                }
+
+                void type_of_service_follows_family()
+                {
+                    SocketOptions options;
+                    options.type_of_service = 0x20;
+
+                    auto v4 = socket(AF_INET, SOCK_STREAM, 0);
+                    auto applied = options.apply(v4, PF_INET);
+                    check("IP_TOS is set on an IPv4 socket",
+                          applied.type_of_service == 0x20 && get(v4, IPPROTO_IP, IP_TOS) == 0x20);
+                    close(v4);
+
+#ifdef IPV6_TCLASS
+                    auto v6 = socket(AF_INET6, SOCK_STREAM, 0);
+                    applied = options.apply(v6, PF_INET6);
+                    check("IPV6_TCLASS is set on an IPv6 socket",
+                          applied.type_of_service == 0x20 && get(v6, IPPROTO_IPV6, IPV6_TCLASS) == 0x20);
+                    close(v6);
+#endif
+                }
+
+                void refused_options_are_not_in_effect()
+                {
+                    // TCP options don't apply to a UDP socket.
+                    auto s = socket(AF_INET, SOCK_DGRAM, 0);
+
+                    SocketOptions options;
+                    options.keep_alive = true;
+                    options.keep_alive_idle = 30;
+                    auto applied = options.apply(s, PF_INET);
+
+                    check("A refused option is reported as not in effect",
+                          !applied.no_delay && applied.keep_alive_idle == 0);
+                    close(s);
+
+                    applied = options.apply(-1, PF_INET);
+                    check("Nothing is in effect on an invalid socket",
+                          !applied.no_delay && !applied.keep_alive && applied.keep_alive_idle == 0);
+                }
+
+                void cork_and_quick_ack()
+                {
+                    auto s = socket(AF_INET, SOCK_STREAM, 0);
+
+                    SocketOptions options;
+                    options.cork_batches = true;
+                    auto applied = options.apply(s, PF_INET);
+
+#ifdef TCP_CORK
+                    check("Corking is left to the socket", applied.cork_batches && get(s, IPPROTO_TCP, TCP_CORK) == 0);
+
+                    SocketOptions::set_cork(s, true);
+                    auto corked = get(s, IPPROTO_TCP, TCP_CORK) != 0;
+                    SocketOptions::set_cork(s, false);
+                    check("set_cork() corks and uncorks", corked && get(s, IPPROTO_TCP, TCP_CORK) == 0);
+#else
+                    check("Corking isn't reported where it isn't supported", !applied.cork_batches);
+#endif
+
+#ifdef TCP_QUICKACK
+                    SocketOptions::set_quick_ack(s);
+                    check("set_quick_ack() sets TCP_QUICKACK", get(s, IPPROTO_TCP, TCP_QUICKACK) != 0);
+#endif
+
+                    close(s);
+                }
+
+                int failed = 0;
+        };
+    }
+}
+
+int main(int, char**)
+{
+    smooth::test::SocketOptionsTest test;
+    auto res = test.run();
+    fflush(stdout);
+
+    return res;
+}
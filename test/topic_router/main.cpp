@@ -0,0 +1,268 @@
+//
+// Created by agent on 10/19/26.
+//
+
+// Checks that TopicRouter routes topics to the queues of the matching filters: the single-level wildcard (+) matches
+// exactly one level, possibly empty, the multi-level wildcard (#) matches any number of levels including the parent
+// level, wildcards in the first level don't match topics starting with '$', and removed filters no longer match.
+// Random filters and topics are also compared with a matcher that splits both into levels.
+//
+// Usage: topic_router
+// The exit code is non-zero if any case fails.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <smooth/core/Application.h>
+#include <smooth/application/network/mqtt/TopicRouter.h>
+
+using namespace std::chrono;
+using namespace smooth::core;
+using namespace smooth::application::network::mqtt;
+
+namespace smooth
+{
+    namespace test
+    {
+        class TopicRouterTest
+                : public ipc::IEventListener<MQTTData>,
+                  public ipc::IEventListener<MQTTMessage>
+        {
+            public:
+                int run()
+                {
+                    single_level_wildcard();
+                    multi_level_wildcard();
+                    dollar_topics();
+                    queues_are_listed_once();
+                    filters_are_removed();
+                    matches_model();
+
+                    printf("%d failed\n", failed);
+                    return failed == 0 ? 0 : 1;
+                }
+
+                void event(const MQTTData&) override
+                {
+                }
+
+                void event(const MQTTMessage&) override
+                {
+                }
+
+            private:
+                using Destination = TopicRouter::Destination;
+
+                void check(const std::string& desc, bool passed)
+                {
+                    printf("%s: %s\n", passed ? "PASS" : "FAIL", desc.c_str());
+
+                    if (!passed)
+                    {
+                        ++failed;
+                    }
+                }
+
+                static std::vector<Destination> match(const TopicRouter& router, const std::string& topic)
+                {
+                    std::vector<Destination> res;
+                    router.match(topic.data(), topic.size(), res);
+                    return res;
+                }
+
+                bool matches(const std::string& filter, const std::string& topic)
+                {
+                    TopicRouter router;
+                    router.add(filter, Destination(data[0]));
+                    return !match(router, topic).empty();
+                }
+
+                // Checks each topic against the filter, expecting a match for those listed in matching.
+                void check_filter(const std::string& filter, const std::vector<std::string>& matching,
+                                  const std::vector<std::string>& not_matching)
+                {
+                    bool res = true;
+
+                    for (auto& topic : matching)
+                    {
+                        res = res && matches(filter, topic);
+                    }
+
+                    for (auto& topic : not_matching)
+                    {
+                        res = res && !matches(filter, topic);
+                    }
+
+                    check("Filter '" + filter + "'", res);
+                }
+
+                void single_level_wildcard()
+                {
+                    check_filter("a/b", {"a/b"}, {"a", "a/b/c", "a/bc", "A/b", "b", ""});
+                    check_filter("a/+", {"a/b", "a/"}, {"a", "a/b/c", "b/a"});
+                    check_filter("+/b", {"a/b", "/b"}, {"b", "a/c", "a/b/c"});
+                    check_filter("a/+/c", {"a/b/c", "a//c"}, {"a/c", "a/b/d/c"});
+                    check_filter("+", {"a", ""}, {"a/b", "/"});
+                    check_filter("+/+", {"a/b", "/", "a/"}, {"a", "a/b/c"});
+                }
+
+                void multi_level_wildcard()
+                {
+                    check_filter("a/#", {"a", "a/", "a/b", "a/b/c"}, {"ab", "b/a"});
+                    check_filter("#", {"a", "a/b/c", "/", ""}, {});
+                    check_filter("a/+/#", {"a/b", "a/b/c/d"}, {"a", "b/c"});
+                    check_filter("+/#", {"a", "a/b"}, {});
+                }
+
+                void dollar_topics()
+                {
+                    check_filter("#", {}, {"$SYS", "$SYS/broker"});
+                    check_filter("+/broker", {"SYS/broker"}, {"$SYS/broker"});
+                    check_filter("+/#", {}, {"$SYS/broker"});
+                    check_filter("$SYS/#", {"$SYS", "$SYS/broker"}, {"SYS/broker"});
+                    check_filter("$SYS/+", {"$SYS/broker"}, {"$SYS"});
+                    // Only the first level is special.
+                    check_filter("a/+", {"a/$b"}, {});
+                    check_filter("a/#", {"a/$b/c"}, {});
+                }
+
+                void queues_are_listed_once()
+                {
+                    TopicRouter router;
+                    router.add("a/b", Destination(data[0]));
+                    router.add("a/+", Destination(data[0]));
+                    router.add("a/#", Destination(data[0]));
+                    router.add("#", Destination(data[1]));
+                    router.add("a/+", Destination(data[1]));
+                    router.add("a/b", Destination(message));
+                    router.add("a/b", Destination(message));
+
+                    auto found = match(router, "a/b");
+                    auto listed = [&found](const Destination& d)
+                    {
+                        return std::count(found.begin(), found.end(), d);
+                    };
+
+                    check("Each queue is listed once",
+                          found.size() == 3 && listed(Destination(data[0])) == 1 && listed(Destination(data[1])) == 1
+                          && listed(Destination(message)) == 1);
+
+                    found = match(router, "a/c");
+                    check("Only the queues of matching filters are listed", found.size() == 2);
+                }
+
+                void filters_are_removed()
+                {
+                    TopicRouter router;
+                    router.add("a/b", Destination(data[0]));
+                    router.add("a/b", Destination(data[1]));
+                    router.add("a/b/c", Destination(data[2]));
+                    router.add("a/#", Destination(data[2]));
+
+                    router.remove("a/b");
+                    check("A removed filter stops routing to all of its queues",
+                          match(router, "a/b") == std::vector<Destination>{Destination(data[2])});
+                    check("Longer filters are kept", match(router, "a/b/c").size() == 1);
+
+                    router.remove("a/+");
+                    check("Removing a filter that wasn't added does nothing", match(router, "a/x").size() == 1);
+
+                    router.remove("a/#");
+                    check("A removed wildcard filter stops matching",
+                          match(router, "a/x").empty() && match(router, "a/b/c").size() == 1);
+
+                    router.remove("a/b/c");
+                    check("The router is empty once all filters are removed", router.empty());
+                }
+
+                // Splits a topic or filter into its levels; "a//b" has three.
+                static std::vector<std::string> levels(const std::string& s)
+                {
+                    std::vector<std::string> res;
+                    size_t pos = 0;
+
+                    for (auto end = s.find('/'); end != std::string::npos; end = s.find('/', pos))
+                    {
+                        res.push_back(s.substr(pos, end - pos));
+                        pos = end + 1;
+                    }
+
+                    res.push_back(s.substr(pos));
+                    return res;
+                }
+
+                static bool model_matches(const std::string& filter, const std::string& topic)
+                {
+                    auto f = levels(filter);
+                    auto t = levels(topic);
+                    bool res = topic.empty() || topic[0] != '$' || (f[0] != "+" && f[0] != "#");
+                    size_t i = 0;
+
+                    while (res && i < f.size() && f[i] != "#")
+                    {
+                        res = i < t.size() && (f[i] == "+" || f[i] == t[i]);
+                        ++i;
+                    }
+
+                    // "#" matches what's left, including no levels at all.
+                    return res && (i < f.size() || i == t.size());
+                }
+
+                static std::string random_name(bool filter)
+                {
+                    static const char* filter_levels[] = {"a", "b", "", "$a", "+", "#"};
+                    std::string res;
+                    auto count = 1 + rand() % 4;
+
+                    for (int i = 0; i < count; ++i)
+                    {
+                        // Filters may only have '#' last.
+                        auto level = filter_levels[rand() % (filter ? (i == count - 1 ? 6 : 5) : 4)];
+                        res += (i > 0 ? "/" : "") + std::string(level);
+                    }
+
+                    return res;
+                }
+
+                void matches_model()
+                {
+                    srand(1);
+                    bool same = true;
+
+                    for (int i = 0; same && i < 20000; ++i)
+                    {
+                        auto filter = random_name(true);
+                        auto topic = random_name(false);
+                        same = matches(filter, topic) == model_matches(filter, topic);
+
+                        if (!same)
+                        {
+                            printf("'%s' and '%s' differ\n", filter.c_str(), topic.c_str());
+                        }
+                    }
+
+                    check("Random filters and topics match like the model", same);
+                }
+
+                // Never started; only needed to create the queues.
+                core::POSIXApplication app{5, milliseconds(10)};
+                ipc::TaskEventQueue<MQTTData> data[3]{{"data0", 1, app, *this},
+                                                      {"data1", 1, app, *this},
+                                                      {"data2", 1, app, *this}};
+                ipc::TaskEventQueue<MQTTMessage> message{"message", 1, app, *this};
+                int failed = 0;
+        };
+    }
+}
+
+int main(int, char**)
+{
+    smooth::test::TopicRouterTest test;
+    auto res = test.run();
+    fflush(stdout);
+
+    return res;
+}